@@ -0,0 +1,212 @@
+"""Waveform and FFT textures for ISF audio and audioFFT inputs."""
+
+import struct
+from functools import lru_cache
+from pathlib import Path
+from typing import Dict, List, Optional, Sequence, Tuple
+
+import numpy as np
+from PIL import Image
+
+from .specialize import split_isf_source
+
+# Texture widths used when an audio input declares no MAX
+DEFAULT_AUDIO_SAMPLES = 512
+DEFAULT_FFT_BINS = 256
+
+# FFT magnitudes are mapped from [FFT_FLOOR_DB, 0] dBFS to [0, 1]
+FFT_FLOOR_DB = -90.0
+
+# Longer sequences compute textures per frame instead of holding every frame's up front
+AUDIO_PRECOMPUTE_FRAMES = 4096
+
+AUDIO_INPUT_TYPES = ("audio", "audioFFT")
+
+_WAVE_FORMAT_PCM = 1
+_WAVE_FORMAT_IEEE_FLOAT = 3
+_WAVE_FORMAT_EXTENSIBLE = 0xFFFE
+
+
+def _read_wav(path: Path) -> Tuple[np.ndarray, int]:
+    """Parse a RIFF/WAVE file into float32 (frames, channels) samples."""
+    data = path.read_bytes()
+    if len(data) < 12 or data[:4] != b"RIFF" or data[8:12] != b"WAVE":
+        raise ValueError(f"Not a WAV file: {path}")
+
+    fmt = None
+    samples = None
+    offset = 12
+    while offset + 8 <= len(data):
+        chunk_id, chunk_size = struct.unpack_from("<4sI", data, offset)
+        body = data[offset + 8:offset + 8 + chunk_size]
+        if chunk_id == b"fmt ":
+            fmt = struct.unpack_from("<HHIIHH", body)
+            if fmt[0] == _WAVE_FORMAT_EXTENSIBLE and len(body) >= 26:
+                # The real format code is the first field of the sub-format GUID
+                fmt = (struct.unpack_from("<H", body, 24)[0],) + fmt[1:]
+        elif chunk_id == b"data":
+            samples = body
+        offset += 8 + chunk_size + (chunk_size & 1)
+    if fmt is None or samples is None:
+        raise ValueError(f"WAV file has no fmt or data chunk: {path}")
+
+    format_code, channels, rate, _, _, bits = fmt
+    width = bits // 8
+    frame_count = len(samples) // (width * channels)
+    raw = np.frombuffer(samples, dtype=np.uint8, count=frame_count * width * channels)
+    if format_code == _WAVE_FORMAT_IEEE_FLOAT and bits in (32, 64):
+        values = raw.view(np.float32 if bits == 32 else np.float64).astype(np.float32)
+    elif format_code == _WAVE_FORMAT_PCM and bits == 8:
+        values = (raw.astype(np.float32) - 128.0) / 128.0
+    elif format_code == _WAVE_FORMAT_PCM and bits in (16, 32):
+        values = raw.view(f"<i{width}").astype(np.float32) / float(2 ** (bits - 1))
+    elif format_code == _WAVE_FORMAT_PCM and bits == 24:
+        # Sign-extend 3-byte samples through the top bytes of an int32
+        padded = np.zeros((raw.size // 3, 4), dtype=np.uint8)
+        padded[:, 1:] = raw.reshape(-1, 3)
+        values = padded.view("<i4").ravel().astype(np.float32) / float(2 ** 31)
+    else:
+        raise ValueError(f"Unsupported WAV encoding (format {format_code}, {bits} bit): {path}")
+    return values.reshape(-1, channels), rate
+
+
+@lru_cache(maxsize=4)
+def _decode_cached(path: str, mtime_ns: int, size: int) -> Tuple[np.ndarray, int]:
+    samples, rate = _read_wav(Path(path))
+    samples.flags.writeable = False
+    return samples, rate
+
+
+def load_wav(path: Path) -> Tuple[np.ndarray, int]:
+    """
+    Decode a WAV file, once per file version.
+
+    Args:
+        path: WAV file (PCM 8/16/24/32-bit or IEEE float)
+
+    Returns:
+        (samples, sample_rate) with read-only float32 samples of shape
+        (frames, channels) in [-1, 1]
+    """
+    path = Path(path).expanduser().resolve()
+    stat = path.stat()
+    return _decode_cached(str(path), stat.st_mtime_ns, stat.st_size)
+
+
+def audio_inputs(shader_content: str) -> List[Tuple[str, str, int]]:
+    """
+    List the audio inputs a shader declares.
+
+    Returns:
+        (name, type, width) triples; width is the input's MAX (samples for
+        audio, bins for audioFFT) or the default
+    """
+    metadata, _, _ = split_isf_source(shader_content)
+    if metadata is None:
+        return []
+    specs = []
+    for definition in metadata.get("INPUTS", []):
+        input_type = definition.get("TYPE")
+        if input_type not in AUDIO_INPUT_TYPES or not definition.get("NAME"):
+            continue
+        default = DEFAULT_AUDIO_SAMPLES if input_type == "audio" else DEFAULT_FFT_BINS
+        try:
+            size = int(definition.get("MAX") or default)
+        except (TypeError, ValueError):
+            size = default
+        specs.append((definition["NAME"], input_type, max(size, 1)))
+    return specs
+
+
+def _windows(samples: np.ndarray, rate: int, times: np.ndarray, size: int) -> np.ndarray:
+    """Gather the `size` samples ending at each time as (frames, size, channels), zero-padded."""
+    ends = np.round(times * rate).astype(np.int64)
+    index = ends[:, None] - size + np.arange(size)[None, :]
+    valid = (index >= 0) & (index < len(samples))
+    windows = samples[np.clip(index, 0, max(len(samples) - 1, 0))] if len(samples) else \
+        np.zeros(index.shape + (samples.shape[1],), dtype=np.float32)
+    windows[~valid] = 0.0
+    return windows
+
+
+def waveform_textures(samples: np.ndarray, rate: int, times: Sequence[float], size: int) -> np.ndarray:
+    """
+    Waveform rows for many time codes in one pass.
+
+    Returns:
+        float32 array (frames, channels, size) in [0, 1], 0.5 being silence
+    """
+    windows = _windows(samples, rate, np.asarray(times, dtype=np.float64), size)
+    return np.clip(windows.transpose(0, 2, 1) * 0.5 + 0.5, 0.0, 1.0)
+
+
+def fft_textures(samples: np.ndarray, rate: int, times: Sequence[float], bins: int) -> np.ndarray:
+    """
+    Magnitude spectra for many time codes in one batched FFT.
+
+    Each frame uses a Hann-windowed block of 2 * bins samples ending at its
+    time; magnitudes are normalized to dBFS and mapped to [0, 1].
+
+    Returns:
+        float32 array (frames, channels, bins) in [0, 1]
+    """
+    size = 2 * bins
+    window = np.hanning(size).astype(np.float32)
+    windows = _windows(samples, rate, np.asarray(times, dtype=np.float64), size) * window[None, :, None]
+    magnitude = np.abs(np.fft.rfft(windows, axis=1))[:, :bins] * (2.0 / window.sum())
+    decibels = 20.0 * np.log10(np.maximum(magnitude, 1e-12))
+    scaled = (decibels - FFT_FLOOR_DB) / -FFT_FLOOR_DB
+    return np.clip(scaled, 0.0, 1.0).astype(np.float32).transpose(0, 2, 1)
+
+
+def texture_image(rows: np.ndarray) -> Image.Image:
+    """Turn a (channels, width) array in [0, 1] into a grey RGBA texture, one row per channel."""
+    grey = np.round(rows * 255.0).astype(np.uint8)
+    rgba = np.empty(grey.shape + (4,), dtype=np.uint8)
+    rgba[..., :3] = grey[..., None]
+    rgba[..., 3] = 255
+    return Image.fromarray(rgba, "RGBA")
+
+
+class AudioTrack:
+    """
+    Audio textures of one WAV file for a shader's audio inputs.
+
+    The file is decoded once and the textures of every requested time code
+    are computed up front in a single vectorized pass per input, so a
+    sequence render only looks frames up. Time codes outside the
+    precomputed set, and every frame of sequences longer than
+    AUDIO_PRECOMPUTE_FRAMES, are computed on demand.
+    """
+
+    def __init__(self, path: Path, specs: Sequence[Tuple[str, str, int]], times: Sequence[float]):
+        self.path = Path(path)
+        self.specs = list(specs)
+        self.samples, self.rate = load_wav(self.path)
+        if len(times) > AUDIO_PRECOMPUTE_FRAMES:
+            times = []
+        self.times = sorted({round(float(t), 9) for t in times})
+        self._index = {t: i for i, t in enumerate(self.times)}
+        self._textures = {name: self._compute(kind, size, self.times) for name, kind, size in self.specs}
+
+    def _compute(self, kind: str, size: int, times: Sequence[float]) -> np.ndarray:
+        if kind == "audio":
+            return waveform_textures(self.samples, self.rate, times, size)
+        return fft_textures(self.samples, self.rate, times, size)
+
+    @property
+    def duration(self) -> float:
+        """Length of the audio in seconds."""
+        return len(self.samples) / float(self.rate)
+
+    def inputs_at(self, time_code: float) -> Dict[str, Image.Image]:
+        """Return the texture of every audio input at a time code."""
+        position: Optional[int] = self._index.get(round(float(time_code), 9))
+        inputs = {}
+        for name, kind, size in self.specs:
+            if position is not None:
+                rows = self._textures[name][position]
+            else:
+                rows = self._compute(kind, size, [time_code])[0]
+            inputs[name] = texture_image(rows)
+        return inputs
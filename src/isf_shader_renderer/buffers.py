@@ -0,0 +1,160 @@
+"""Pooled frame buffers, so long renders reuse pixel memory instead of allocating per frame."""
+
+import threading
+from collections import OrderedDict
+from contextlib import contextmanager
+from io import BytesIO
+from typing import Any, Dict, Iterator, List, Tuple
+
+import numpy as np
+from PIL import Image
+
+# Frame buffers start on a cache-line (and SIMD register) boundary
+FRAME_ALIGNMENT = 64
+
+# Idle buffers kept per frame shape
+POOL_BUFFERS_PER_SHAPE = 4
+
+# Frame shapes kept pooled, evicted least recently used first
+POOL_SHAPES = 8
+
+Shape = Tuple[int, int, int]
+
+
+def aligned_empty(shape: Shape, alignment: int = FRAME_ALIGNMENT) -> np.ndarray:
+    """Allocate an uninitialized uint8 array whose data starts on an alignment boundary."""
+    size = int(np.prod(shape))
+    raw = np.empty(size + alignment, dtype=np.uint8)
+    offset = -raw.ctypes.data % alignment
+    return raw[offset:offset + size].reshape(shape)
+
+
+def image_into(image: Image.Image, out: np.ndarray) -> np.ndarray:
+    """
+    Copy a PIL image into a (height, width, 4) uint8 buffer.
+
+    The buffer is wrapped as a PIL image sharing its memory and the frame is
+    pasted into it, so no intermediate bytes object is built (np.asarray on
+    an image copies the pixels through tobytes()).
+
+    Returns:
+        The filled buffer
+    """
+    height, width = out.shape[:2]
+    if image.size != (width, height):
+        raise ValueError(f"Image is {image.size[0]}x{image.size[1]}, buffer is {width}x{height}")
+    if out.dtype != np.uint8 or out.ndim != 3 or out.shape[2] != 4 or not out.flags.c_contiguous:
+        raise ValueError("Buffer must be a C-contiguous (height, width, 4) uint8 array")
+    target = Image.frombuffer("RGBA", (width, height), out, "raw", "RGBA", 0, 1)
+    # frombuffer maps the array; clearing readonly makes paste write through instead of copying
+    target.readonly = 0
+    target.paste(image if image.mode == "RGBA" else image.convert("RGBA"), (0, 0))
+    return out
+
+
+class FramePool:
+    """
+    Free lists of preallocated RGBA frame buffers, one per frame shape.
+
+    A renderer acquires a buffer, fills it (readback, conversion, statistics,
+    encoding) and releases it; the next frame of the same size gets the same
+    memory back. Both the buffers per shape and the number of shapes are
+    bounded, so memory stays flat however many frames are rendered and a
+    client cycling through resolutions cannot grow the pool without limit.
+    """
+
+    def __init__(self, buffers_per_shape: int = POOL_BUFFERS_PER_SHAPE, max_shapes: int = POOL_SHAPES):
+        self.buffers_per_shape = buffers_per_shape
+        self.max_shapes = max_shapes
+        self._free: "OrderedDict[Shape, List[np.ndarray]]" = OrderedDict()
+        self._lock = threading.Lock()
+        self.allocations = 0
+        self.reuses = 0
+
+    def acquire(self, width: int, height: int, channels: int = 4) -> np.ndarray:
+        """
+        Take a (height, width, channels) uint8 buffer from the pool.
+
+        The contents are undefined; release the buffer when done with it.
+        """
+        shape = (height, width, channels)
+        with self._lock:
+            free = self._free.get(shape)
+            if free:
+                self._free.move_to_end(shape)
+                self.reuses += 1
+                return free.pop()
+            self.allocations += 1
+        return aligned_empty(shape)
+
+    def release(self, buffer: np.ndarray) -> None:
+        """Return a buffer to the pool (dropped if its shape's free list is full)."""
+        shape = tuple(buffer.shape)
+        with self._lock:
+            free = self._free.setdefault(shape, [])
+            self._free.move_to_end(shape)
+            if len(free) < self.buffers_per_shape:
+                free.append(buffer)
+            while len(self._free) > self.max_shapes:
+                self._free.popitem(last=False)
+
+    @contextmanager
+    def lease(self, width: int, height: int, channels: int = 4) -> Iterator[np.ndarray]:
+        """Context manager that acquires a buffer and releases it on exit."""
+        buffer = self.acquire(width, height, channels)
+        try:
+            yield buffer
+        finally:
+            self.release(buffer)
+
+    def stats(self) -> Dict[str, Any]:
+        """Return pool counters."""
+        with self._lock:
+            idle = sum(len(free) for free in self._free.values())
+            idle_bytes = sum(buffer.nbytes for free in self._free.values() for buffer in free)
+            return {
+                "shapes": len(self._free),
+                "idle": idle,
+                "idle_bytes": idle_bytes,
+                "allocations": self.allocations,
+                "reuses": self.reuses,
+            }
+
+    def clear(self) -> None:
+        """Drop every idle buffer."""
+        with self._lock:
+            self._free.clear()
+
+
+_shared_pool = None
+_pool_lock = threading.Lock()
+
+
+def frame_pool() -> FramePool:
+    """Return the process-wide frame pool shared by every renderer."""
+    global _shared_pool
+    with _pool_lock:
+        if _shared_pool is None:
+            _shared_pool = FramePool()
+        return _shared_pool
+
+
+_encode_buffers = threading.local()
+
+
+def encode_image(image: Image.Image, format: str, **params: Any) -> bytes:
+    """
+    Encode an image with a per-thread output buffer that is reused across calls.
+
+    The BytesIO keeps its grown capacity between frames, so encoding a
+    stream of same-sized frames does not repeatedly reallocate while the
+    encoder writes; only the returned bytes are new.
+    """
+    buffer = getattr(_encode_buffers, "buffer", None)
+    if buffer is None:
+        buffer = _encode_buffers.buffer = BytesIO()
+    buffer.seek(0)
+    image.save(buffer, format=format, **params)
+    size = buffer.tell()
+    buffer.seek(0)
+    return buffer.read(size)
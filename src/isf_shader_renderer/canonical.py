@@ -0,0 +1,210 @@
+"""Canonical form of ISF shader sources, used to key the shader caches."""
+
+import hashlib
+import json
+import re
+from dataclasses import dataclass
+from functools import lru_cache
+from typing import Any, List, Tuple
+
+from .specialize import split_isf_source
+
+# Canonical forms kept in memory; sources are re-canonicalized for every cache lookup
+CANONICAL_CACHE_SIZE = 64
+
+_COMMENT = re.compile(r"//[^\n]*|/\*.*?\*/", re.DOTALL)
+
+# GLSL operators, longest first so tokens are matched greedily
+_OPERATORS = (
+    "<<=", ">>=", "++", "--", "<<", ">>", "<=", ">=", "==", "!=", "&&", "||", "^^",
+    "+=", "-=", "*=", "/=", "%=", "&=", "|=", "^=",
+)
+_TOKEN = re.compile(
+    r"(?P<space>\s+)"
+    r"|(?P<float>(?:\d+\.\d*|\.\d+)(?:[eE][+-]?\d+)?[fF]?|\d+[eE][+-]?\d+[fF]?)"
+    r"|(?P<int>0[xX][0-9a-fA-F]+[uU]?|\d+[uU]?)"
+    r"|(?P<word>[A-Za-z_]\w*)"
+    r"|(?P<op>" + "|".join(re.escape(op) for op in _OPERATORS) + r"|.)"
+)
+
+# Code lines are re-broken after these tokens so brace style does not matter
+_LINE_ENDS = (";", "{", "}")
+
+
+@dataclass(frozen=True)
+class CanonicalSource:
+    """
+    Canonical text of a shader with its hash and a map back to the source.
+
+    line_map[i] is the 1-based source line on which canonical line i + 1
+    starts, so diagnostics against the canonical text can be reported at
+    the line the client actually wrote.
+    """
+
+    text: str
+    digest: str
+    line_map: Tuple[int, ...]
+
+    def original_line(self, line: int) -> int:
+        """Return the source line of a 1-based canonical line number."""
+        if not self.line_map:
+            return line
+        return self.line_map[min(max(line, 1), len(self.line_map)) - 1]
+
+
+def _float_literal(text: str) -> str:
+    """Normalize a float literal: 1., 1.0f and 1.000 all become 1.0."""
+    value = repr(float(text.rstrip("fF")))
+    return value if ("." in value or "e" in value or "n" in value) else value + ".0"
+
+
+def _canonical_number(value: Any) -> Any:
+    """Normalize JSON numbers so 1 and 1.0 compare equal (bools are left alone)."""
+    if isinstance(value, bool):
+        return value
+    if isinstance(value, (int, float)):
+        return float(value)
+    if isinstance(value, list):
+        return [_canonical_number(item) for item in value]
+    if isinstance(value, dict):
+        return {key: _canonical_number(item) for key, item in value.items()}
+    return value
+
+
+def canonical_json(value: Any) -> str:
+    """Serialize JSON with sorted keys, no whitespace and normalized numbers."""
+    return json.dumps(_canonical_number(value), sort_keys=True, separators=(",", ":"))
+
+
+def _tokens(line: str) -> List[Tuple[str, str, bool]]:
+    """Split a line into (kind, text, preceded_by_space) tokens."""
+    tokens = []
+    spaced = False
+    for match in _TOKEN.finditer(line):
+        kind = match.lastgroup
+        if kind == "space":
+            spaced = True
+            continue
+        text = match.group()
+        if kind == "float":
+            text = _float_literal(text)
+        elif kind == "int" and text[:2] in ("0x", "0X"):
+            text = text.lower()
+        tokens.append((kind, text, spaced))
+        spaced = False
+    return tokens
+
+
+def _needs_space(previous: Tuple[str, str, bool], current: Tuple[str, str, bool]) -> bool:
+    """Whether two tokens would lex differently if written without a space."""
+    if previous[0] != "op" and current[0] != "op":
+        return True
+    if previous[0] == "op" and current[0] == "op":
+        joined = previous[1] + current[1]
+        return joined.startswith(("//", "/*")) or _TOKEN.match(joined).group() != previous[1]
+    return False
+
+
+def _join(tokens: List[Tuple[str, str, bool]], keep_spacing: bool = False) -> str:
+    """Join tokens with the minimal spacing (or the original spacing, collapsed)."""
+    parts = []
+    for i, token in enumerate(tokens):
+        if i and (_needs_space(tokens[i - 1], token) or (keep_spacing and token[2])):
+            parts.append(" ")
+        parts.append(token[1])
+    return "".join(parts)
+
+
+def canonical_glsl(body: str, first_line: int = 1) -> Tuple[List[str], List[int]]:
+    """
+    Canonicalize a GLSL body.
+
+    Comments are removed, whitespace is reduced to what the lexer needs,
+    float literals are normalized and code is re-broken into one statement
+    or brace per line. Preprocessor directives stay on their own lines and
+    keep (collapsed) spacing, since "#define F (x)" and "#define F(x)" differ.
+
+    Args:
+        body: GLSL source
+        first_line: Source line number of the body's first line
+
+    Returns:
+        (lines, line_map) with the source line of every canonical line
+    """
+    # Comments become blank space, keeping their newlines so line numbers hold
+    body = _COMMENT.sub(lambda m: " " + "\n" * m.group().count("\n"), body)
+    lines: List[str] = []
+    line_map: List[int] = []
+    pending: List[Tuple[str, str, bool]] = []
+    pending_line = first_line
+
+    def flush():
+        if pending:
+            lines.append(_join(pending))
+            line_map.append(pending_line)
+            pending.clear()
+
+    source_lines = body.split("\n")
+    i = 0
+    while i < len(source_lines):
+        line_number = first_line + i
+        line = source_lines[i]
+        # Backslash continuations belong to the line they continue
+        while line.endswith("\\") and i + 1 < len(source_lines):
+            i += 1
+            line = line[:-1] + " " + source_lines[i]
+        i += 1
+
+        if line.lstrip().startswith("#"):
+            flush()
+            directive = line.strip()
+            tokens = _tokens(directive[1:])
+            lines.append("#" + _join(tokens, keep_spacing=True))
+            line_map.append(line_number)
+            continue
+
+        for token in _tokens(line):
+            if not pending:
+                pending_line = line_number
+            pending.append(token)
+            if token[1] in _LINE_ENDS:
+                flush()
+    flush()
+    return lines, line_map
+
+
+@lru_cache(maxsize=CANONICAL_CACHE_SIZE)
+def canonicalize(shader_content: str) -> CanonicalSource:
+    """
+    Build the canonical form of an ISF shader.
+
+    Sources that differ only in comments, whitespace, float spelling or the
+    order of JSON header keys share a canonical text and digest.
+
+    Args:
+        shader_content: The ISF shader source code
+
+    Returns:
+        CanonicalSource with the text, its SHA-256 and the line map
+    """
+    metadata, header_text, body = split_isf_source(shader_content)
+    lines: List[str] = []
+    line_map: List[int] = []
+    if metadata is not None:
+        lines.append("/*" + canonical_json(metadata) + "*/")
+        line_map.append(shader_content[:shader_content.index("/*")].count("\n") + 1)
+    body_lines, body_map = canonical_glsl(body, header_text.count("\n") + 1)
+    lines.extend(body_lines)
+    line_map.extend(body_map)
+
+    text = "\n".join(lines)
+    return CanonicalSource(
+        text=text,
+        digest=hashlib.sha256(text.encode("utf-8")).hexdigest(),
+        line_map=tuple(line_map),
+    )
+
+
+def canonical_hash(shader_content: str) -> str:
+    """Return the SHA-256 of a shader's canonical form."""
+    return canonicalize(shader_content).digest
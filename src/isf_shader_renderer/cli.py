@@ -1,17 +1,29 @@
 """Command-line interface for ISF Shader Renderer."""
 
+import hashlib
+import signal
 import sys
+import threading
+from dataclasses import replace
+from fractions import Fraction
 from pathlib import Path
-from typing import List, Optional
+from typing import Iterator, List, Optional, Sequence, Tuple
 
 import typer
 from rich.console import Console
 from rich.progress import Progress, SpinnerColumn, TextColumn
 from rich.table import Table
 
-from .config import ShaderRendererConfig, load_config
+from .config import Defaults, ShaderConfig, ShaderRendererConfig, load_config
+from .planner import ProfileCache, RenderPlan, plan_render
+from .realtime import DEFAULT_RING_NAME, DEFAULT_RING_SLOTS, FrameRing, RealtimeStats, run_realtime
+from .render_graph import RenderGraph, shader_footprint
 from .renderer import ShaderRenderer
+from .scheduler import WorkerLayout, calibrate, configure_process
+from .sharding import iter_sharded, render_sharded
+from .timebase import TimeRange, frame_number, parse_rate
 from .utils import format_error_for_ai, format_success_for_ai
+from .writer import FrameWriter, ProgressJournal, frame_key, frame_output, job_key
 
 app = typer.Typer(
     name="isf-shader-render",
@@ -20,12 +32,16 @@ app = typer.Typer(
 )
 console = Console()
 
+# Frame rates used when --fps is not given
+DEFAULT_SEQUENCE_FPS = 30
+DEFAULT_REALTIME_FPS = 60.0
+
 
 # Only register the main function as the Typer command/callback
 @app.command('isf-render')
 def isf_render(
     config_file: Optional[Path] = typer.Option(
-        None, "--config", "-c", help="Path to YAML configuration file"
+        None, "--config", "-c", help="Path to YAML configuration file or NDJSON job manifest"
     ),
     shader: Path = typer.Argument(
         ..., help="Path to ISF shader file (use '-' for stdin)"
@@ -37,7 +53,7 @@ def isf_render(
         help="Time code for rendering (can be specified multiple times)",
     ),
     output: Optional[Path] = typer.Option(
-        None, "--output", "-o", help="Output file path"
+        None, "--output", "-o", help="Output file path ('-' streams raw RGBA frames to stdout)"
     ),
     width: int = typer.Option(1920, "--width", "-w", help="Output width"),
     height: int = typer.Option(1080, "--height", "-h", help="Output height"),
@@ -58,14 +74,90 @@ def isf_render(
         "--inputs",
         help="Shader input values as comma-separated key=value pairs (e.g. foo=1,bar=2.0,baz=hello)",
     ),
+    specialize: bool = typer.Option(
+        False,
+        "--specialize",
+        help="Bake --inputs values into the shader as constants (compiled once, faster on CPU rasterizers)",
+    ),
+    audio: Optional[Path] = typer.Option(
+        None,
+        "--audio",
+        help="WAV file driving the shader's audio/audioFFT inputs at each time code",
+    ),
+    video: Optional[Path] = typer.Option(
+        None,
+        "--video",
+        help="Y4M video whose frame at each time code feeds the shader's inputImage",
+    ),
+    realtime: bool = typer.Option(
+        False,
+        "--realtime",
+        help="Render continuously on the wall clock into a shared-memory frame ring",
+    ),
+    fps: Optional[str] = typer.Option(
+        None,
+        "--fps",
+        help="Frame rate of a --start/--end/--frames sequence (default: 30) or of --realtime (default: 60), e.g. 30000/1001",
+    ),
+    start: Optional[str] = typer.Option(
+        None, "--start", help="Time of frame 0 of a frame sequence in seconds (default: 0)"
+    ),
+    end: Optional[str] = typer.Option(
+        None, "--end", help="End of a frame sequence in seconds (exclusive)"
+    ),
+    frames: Optional[int] = typer.Option(
+        None, "--frames", min=0, help="Number of frames of a frame sequence (instead of --end)"
+    ),
+    first_frame: int = typer.Option(
+        0, "--first-frame", min=0, help="Frame number of a frame sequence to start rendering at"
+    ),
+    duration: Optional[float] = typer.Option(
+        None, "--duration", help="Seconds to run --realtime mode (default: until interrupted)"
+    ),
+    ring_name: str = typer.Option(
+        DEFAULT_RING_NAME, "--ring-name", help="Shared-memory segment name of the --realtime frame ring"
+    ),
+    ring_slots: int = typer.Option(
+        DEFAULT_RING_SLOTS, "--ring-slots", min=2, help="Frames held by the --realtime ring"
+    ),
+    jobs: int = typer.Option(
+        1, "--jobs", "-j", min=1, help="Worker processes, each rendering contiguous shards of the frames"
+    ),
+    resume: bool = typer.Option(
+        False, "--resume", help="Skip frames an earlier run of the same render completed (see its progress journal)"
+    ),
+    threads: Optional[int] = typer.Option(
+        None, "--threads", min=1, help="llvmpipe rasterizer threads per worker (default: balanced against --jobs and the frame size)"
+    ),
+    calibrate_layout: bool = typer.Option(
+        False, "--calibrate", help="Time a short render of each workers x threads layout first and use the fastest (--jobs above 1 caps the workers)"
+    ),
+    plan: bool = typer.Option(
+        False, "--plan", help="Predict wall time, peak memory, output size and the best --jobs from probe renders, without rendering"
+    ),
 ) -> None:
     """Render ISF shaders to PNG images."""
+    streaming = output is not None and str(output) == "-"
+    if streaming:
+        # stdout carries the frames
+        console.stderr = True
 
     # Validate that --info and --ai-info are not used together
     if info and ai_info:
         console.print("[red]Error: --info and --ai-info flags cannot be used together[/red]")
         raise typer.Exit(1)
 
+    # Frame sequences and the realtime clock share --fps, parsed exactly
+    try:
+        rate = parse_rate(fps) if fps is not None else None
+        sequence = frame_sequence(time, rate, start, end, frames, first_frame)
+    except ValueError as e:
+        if ai_info:
+            print(f"Error: {e}")
+        else:
+            console.print(f"[red]Error: {e}[/red]")
+        raise typer.Exit(1)
+
     if verbose and not ai_info:
         console.print("[bold blue]ISF Shader Renderer[/bold blue]")
         console.print(f"Version: {__import__('isf_shader_renderer').__version__}")
@@ -130,6 +222,10 @@ def isf_render(
         if verbose and not ai_info:
             console.print(f"Loaded shader from: {shader}")
 
+    if jobs == 1 and threads is not None and not calibrate_layout:
+        # One process renders; without --threads llvmpipe keeps its default of one thread per CPU
+        configure_process(threads)
+
     # Create renderer (will crash if VVISF is not available)
     try:
         renderer = ShaderRenderer(cfg)
@@ -160,6 +256,15 @@ def isf_render(
                 shader_table.add_row("inputs", str([i["name"] for i in v]))
             else:
                 shader_table.add_row(str(k), str(v))
+        graph = RenderGraph.from_shader(shader_content)
+        if graph.targets:
+            footprint = shader_footprint(shader_content, cfg.defaults.width, cfg.defaults.height)
+            shader_table.add_row("pass graph", "\n".join(graph.describe()))
+            shader_table.add_row(
+                "pass memory",
+                f"{format_bytes(footprint.target_bytes)} in {len(footprint.textures)} textures "
+                f"({format_bytes(footprint.unaliased_bytes)} unaliased) at {cfg.defaults.width}x{cfg.defaults.height}",
+            )
         console.print(shader_table)
 
     # Parse inputs string into a dictionary
@@ -179,10 +284,57 @@ def isf_render(
             key, value = pair.split("=", 1)
             input_dict[key.strip()] = value.strip()
 
+    if plan:
+        if realtime:
+            if ai_info:
+                print("Error: --plan cannot be combined with --realtime")
+            else:
+                console.print("[red]Error: --plan cannot be combined with --realtime[/red]")
+            raise typer.Exit(1)
+        if config_file and cfg.shaders:
+            # Profiles are kept beside the config and reused until the shader or its inputs change
+            cache = ProfileCache(config_file.with_name(config_file.name + ".profile"))
+            planned = plan_render(renderer, config_jobs(cfg, ai_info), cfg.defaults, cache)
+        else:
+            shader_config = ShaderConfig(
+                input=str(shader) if str(shader) != "-" else "<stdin>",
+                output=str(output) if output else "frame.png",
+                times=sequence,
+                width=width,
+                height=height,
+                quality=quality,
+                inputs=input_dict or None,
+                specialize=specialize,
+                audio=str(audio) if audio else None,
+                video=str(video) if video else None,
+            )
+            planned = plan_render(renderer, [(shader_content, shader_config)], cfg.defaults)
+        print_plan(planned, jobs, ai_info)
+        if planned.failed:
+            raise typer.Exit(1)
+        return
+
+    if realtime:
+        shader_config = ShaderConfig(
+            input=str(shader) if str(shader) != "-" else "<stdin>",
+            output="",
+            times=[0.0],
+            width=width,
+            height=height,
+            inputs=input_dict or None,
+            specialize=specialize,
+        )
+        realtime_fps = float(rate) if rate is not None else DEFAULT_REALTIME_FPS
+        render_realtime(renderer, shader_content, shader_config, realtime_fps, duration, ring_name, ring_slots, ai_info)
+        return
+
     # Render shaders
     if config_file and cfg.shaders:
         # Use configuration file shaders
-        render_from_config(renderer, cfg, verbose, ai_info)
+        with frame_output(config_file.with_name(config_file.name + ".progress"), resume) as (writer, journal):
+            render_from_config(
+                renderer, cfg, verbose, ai_info, jobs, writer, journal, resume, threads, calibrate_layout
+            )
     else:
         # Use command-line arguments
         if not output:
@@ -195,30 +347,45 @@ def isf_render(
             raise typer.Exit(1)
         # If inputs are provided, create a ShaderConfig and pass to renderer
         shader_config = None
-        if input_dict:
-            from .config import ShaderConfig
-
+        if input_dict or audio or video or streaming or jobs > 1 or calibrate_layout:
             shader_config = ShaderConfig(
                 input=str(shader) if str(shader) != "-" else "<stdin>",
                 output=str(output),
-                times=time or [0.0],
+                times=sequence,
                 width=width,
                 height=height,
                 quality=quality,
-                inputs=input_dict,
+                inputs=input_dict or None,
+                specialize=specialize,
+                audio=str(audio) if audio else None,
+                video=str(video) if video else None,
             )
-        # Default to time 0.0 if no time codes are specified
-        time_codes = time if time else [0.0]
         try:
-            render_single_shader(
-                renderer,
-                shader_content,
-                time_codes,
-                output,
-                verbose,
-                shader_config,
-                ai_info,
-            )
+            if streaming:
+                if calibrate_layout:
+                    layout = calibrated_layout(shader_content, shader_config, cfg.defaults, jobs, ai_info)
+                    jobs, threads = layout.workers, layout.threads
+                stream_frames(shader_content, shader_config, jobs, cfg.defaults, threads)
+            elif jobs > 1 or calibrate_layout:
+                render_shards(
+                    shader_content, shader_config, jobs, cfg.defaults, ai_info,
+                    resume=resume, threads=threads, calibrate_layout=calibrate_layout,
+                )
+            else:
+                # Sequences keep a journal next to their frames so --resume can pick them up
+                journal_path = progress_journal_path(output) if len(sequence) > 1 else None
+                with frame_output(journal_path, resume) as (writer, journal):
+                    render_single_shader(
+                        renderer,
+                        shader_content,
+                        sequence,
+                        output,
+                        verbose,
+                        shader_config,
+                        ai_info,
+                        writer,
+                        journal,
+                    )
         except Exception as e:
             if ai_info:
                 print(format_error_for_ai(e, "shader rendering"))
@@ -227,28 +394,320 @@ def isf_render(
             raise typer.Exit(1)
 
 
+def frame_sequence(
+    time: List[float],
+    fps: Optional[Fraction],
+    start: Optional[str],
+    end: Optional[str],
+    frames: Optional[int],
+    first_frame: int,
+) -> Sequence[float]:
+    """
+    Time codes to render from the command line.
+
+    --start/--end/--frames/--first-frame describe frames of the timebase
+    TIME = start + frame / fps, generated lazily; otherwise the --time
+    values are used, or 0.0 if there are none.
+
+    Raises:
+        ValueError: If the options conflict or a sequence has no end
+    """
+    if start is None and end is None and frames is None and not first_frame:
+        return list(time) or [0.0]
+    if time:
+        raise ValueError("--time cannot be combined with --start/--end/--frames")
+    if (end is None) == (frames is None):
+        raise ValueError("A frame sequence needs exactly one of --end and --frames")
+    return TimeRange(
+        start if start is not None else 0,
+        end=end,
+        fps=fps if fps is not None else DEFAULT_SEQUENCE_FPS,
+        count=frames,
+        first=first_frame,
+    )
+
+
+def stream_frames(
+    shader_content: str,
+    shader_config: ShaderConfig,
+    jobs: int,
+    defaults: Defaults,
+    threads: Optional[int] = None,
+) -> None:
+    """Write raw RGBA frames to stdout in frame order (e.g. for ffmpeg -f rawvideo)."""
+    stdout = sys.stdout.buffer
+    for _, _, pixels in iter_sharded(shader_content, shader_config, jobs, defaults, threads=threads):
+        stdout.write(pixels.data)
+    stdout.flush()
+
+
+def render_shards(
+    shader_content: str,
+    shader_config: ShaderConfig,
+    jobs: int,
+    defaults: Defaults,
+    ai_info: bool = False,
+    progress=None,
+    resume: bool = False,
+    threads: Optional[int] = None,
+    calibrate_layout: bool = False,
+) -> int:
+    """
+    Render one shader's frames in shards across worker processes.
+
+    Prints failed frames and returns the number rendered. Without a
+    progress callback, a progress bar is shown (unless ai_info is set).
+    With calibrate_layout, the workers and threads are first chosen by a
+    calibration run (jobs above 1 caps the workers).
+    """
+    if calibrate_layout:
+        layout = calibrated_layout(shader_content, shader_config, defaults, jobs, ai_info, status=progress is None)
+        jobs, threads = layout.workers, layout.threads
+        if jobs == 1:
+            # The single worker is this process; threads apply to contexts it has not created yet
+            configure_process(threads)
+
+    def run(advance):
+        return render_sharded(
+            shader_content, shader_config, jobs, defaults, resume=resume, progress=advance, threads=threads
+        )
+
+    if progress is not None or ai_info:
+        result = run(progress)
+    else:
+        with Progress(
+            SpinnerColumn(),
+            TextColumn("[progress.description]{task.description}"),
+            console=console,
+        ) as bar:
+            task = bar.add_task(
+                f"Rendering {len(shader_config.times)} frames with {jobs} workers...",
+                total=len(shader_config.times),
+            )
+            result = run(lambda count: bar.update(task, advance=count))
+
+    notes = []
+    if result.layout is not None:
+        notes.append(f"Rendered {shader_config.input} with {result.layout.describe()}")
+    if result.serialized:
+        notes.append(f"Rendered {shader_config.input} as a single shard because {result.serialized}")
+    if result.resumed_shards:
+        notes.append(f"Skipped {result.resumed_shards} of {result.shards} shards finished by an earlier run")
+    for note in notes:
+        if ai_info:
+            print(note)
+        else:
+            console.print(f"[yellow]{note}[/yellow]")
+    for number, time_code, error in result.failed:
+        if ai_info:
+            print(f"Error rendering frame {number} at time {time_code}s: {error}")
+        else:
+            console.print(f"[red]Error rendering frame {number} at time {time_code}s: {error}[/red]")
+    rendered = result.frames - len(result.failed)
+    if progress is None:
+        if ai_info and not result.failed:
+            print(format_success_for_ai(rendered))
+        elif not ai_info:
+            console.print(f"\n[green]Successfully rendered {rendered} frames[/green]")
+    return rendered
+
+
+def calibrated_layout(
+    shader_content: str,
+    shader_config: ShaderConfig,
+    defaults: Defaults,
+    jobs: int,
+    ai_info: bool = False,
+    status: bool = True,
+) -> WorkerLayout:
+    """
+    Calibrate the workers x threads layout for a shader and print the frame rates measured.
+
+    A spinner is shown while calibrating unless ai_info is set or status is
+    off (inside another live display).
+    """
+    config = replace(
+        shader_config,
+        width=shader_config.get_width(defaults),
+        height=shader_config.get_height(defaults),
+        quality=shader_config.get_quality(defaults),
+    )
+    if ai_info or not status:
+        best, rates = calibrate(shader_content, config, max_workers=jobs if jobs > 1 else None)
+    else:
+        with console.status(f"Calibrating workers and threads for {shader_config.input}..."):
+            best, rates = calibrate(shader_content, config, max_workers=jobs if jobs > 1 else None)
+    for layout, rate in rates.items():
+        line = f"{layout.describe()}: {rate:.1f} frames/s"
+        if ai_info:
+            print(line + (" (chosen)" if layout == best else ""))
+        else:
+            console.print(f"[bold]{line} (chosen)[/bold]" if layout == best else line)
+    return best
+
+
+def report_write_failures(writer: Optional[FrameWriter], since: int, ai_info: bool = False) -> int:
+    """Wait for queued frames, print those that failed to write after `since`, and count them."""
+    if writer is None:
+        return 0
+    writer.flush()
+    failures = writer.failed[since:]
+    for path, error in failures:
+        if ai_info:
+            print(f"Error writing frame {path}: {error}")
+        else:
+            console.print(f"[red]Error writing frame {path}: {error}[/red]")
+    return len(failures)
+
+
+def progress_journal_path(output: Path) -> Path:
+    """Journal of a single-shader render, next to its frames and named after the output template."""
+    digest = hashlib.blake2b(str(output).encode("utf-8"), digest_size=6).hexdigest()
+    return Path(output).parent / f".isf-progress-{digest}.ndjson"
+
+
+def config_jobs(cfg: ShaderRendererConfig, ai_info: bool = False) -> Iterator[Tuple[str, ShaderConfig]]:
+    """(shader source, configuration) of each configured shader whose file exists."""
+    for shader_config in cfg.shaders:
+        shader_path = Path(shader_config.input)
+        if not shader_path.exists():
+            if ai_info:
+                print(f"Warning: Shader file '{shader_path}' not found, skipping")
+            else:
+                console.print(f"[red]Warning: Shader file '{shader_path}' not found, skipping[/red]")
+            continue
+        yield shader_path.read_text(), shader_config
+
+
+def format_duration(seconds: float) -> str:
+    """Seconds as e.g. '14h 02m', '3m 20s' or '4.2s'."""
+    if seconds < 60:
+        return f"{seconds:.1f}s"
+    minutes, secs = divmod(int(round(seconds)), 60)
+    if minutes < 60:
+        return f"{minutes}m {secs:02d}s"
+    hours, minutes = divmod(minutes, 60)
+    return f"{hours}h {minutes:02d}m"
+
+
+def format_bytes(size: float) -> str:
+    """Bytes in binary units, e.g. '1.5 GiB'."""
+    for unit in ("B", "KiB", "MiB", "GiB"):
+        if size < 1024:
+            return f"{size:.0f} {unit}" if unit == "B" else f"{size:.1f} {unit}"
+        size /= 1024
+    return f"{size:.1f} TiB"
+
+
+def print_plan(plan: RenderPlan, jobs: int = 1, ai_info: bool = False) -> None:
+    """Print a render plan: per-shader estimates, totals and the recommended --jobs."""
+    best = plan.best_jobs() if plan.jobs else 1
+    for job in plan.jobs:
+        if job.profile.stateful and max(best, jobs) > 1:
+            note = f"{job.input} renders as a single shard because {job.profile.stateful}"
+            if ai_info:
+                print(note)
+            else:
+                console.print(f"[yellow]{note}[/yellow]")
+    for name, error in plan.failed:
+        if ai_info:
+            print(f"Error probing {name}: {error}")
+        else:
+            console.print(f"[red]Error probing {name}: {error}[/red]")
+
+    totals = [
+        ("Frames", str(plan.frames)),
+        ("Output size", format_bytes(plan.output_bytes)),
+        (f"Wall time with --jobs {jobs}", format_duration(plan.wall_seconds(jobs))),
+        (f"Peak memory with --jobs {jobs}", format_bytes(plan.peak_bytes(jobs))),
+    ]
+    if best != jobs:
+        totals += [
+            (f"Wall time with --jobs {best}", format_duration(plan.wall_seconds(best))),
+            (f"Peak memory with --jobs {best}", format_bytes(plan.peak_bytes(best))),
+        ]
+    totals.append(("Recommended --jobs", f"{best} of {plan.cores} cores"))
+    if plan.peak_bytes(jobs, aliased=True) < plan.peak_bytes(jobs):
+        # pyvvisf allocates every pass target, so this is not used to choose --jobs
+        totals.append((
+            f"Peak memory with --jobs {jobs} if pass textures were aliased",
+            format_bytes(plan.peak_bytes(jobs, aliased=True)),
+        ))
+
+    if ai_info:
+        for job in plan.jobs:
+            source = "cached profile" if job.cached else "probe"
+            print(
+                f"{job.input}: {job.frames} frames at {job.width}x{job.height}, "
+                f"{job.profile.render_seconds(job.pixels) * 1000:.1f} ms per frame ({source}), "
+                f"about {format_duration(job.wall_seconds(jobs, plan.cores))} and {format_bytes(job.output_bytes)}"
+            )
+        for label, value in totals:
+            print(f"{label}: {value}")
+        return
+
+    table = Table(title="Render Plan")
+    table.add_column("Shader", style="cyan")
+    table.add_column("Frames", justify="right")
+    table.add_column("Size")
+    table.add_column("ms/frame", justify="right")
+    table.add_column(f"Time (-j {jobs})", justify="right")
+    table.add_column("Output", justify="right")
+    for job in plan.jobs:
+        table.add_row(
+            job.input + (" (cached)" if job.cached else ""),
+            str(job.frames),
+            f"{job.width}x{job.height}",
+            f"{job.profile.render_seconds(job.pixels) * 1000:.1f}",
+            format_duration(job.wall_seconds(jobs, plan.cores)),
+            format_bytes(job.output_bytes),
+        )
+    console.print(table)
+    for label, value in totals:
+        console.print(f"{label}: [magenta]{value}[/magenta]")
+
+
 def render_from_config(
     renderer: ShaderRenderer,
     cfg: ShaderRendererConfig,
     verbose: bool,
     ai_info: bool = False,
+    jobs: int = 1,
+    writer: Optional[FrameWriter] = None,
+    journal: Optional[ProgressJournal] = None,
+    resume: bool = False,
+    threads: Optional[int] = None,
+    calibrate_layout: bool = False,
 ) -> None:
-    """Render shaders from configuration file."""
-    total_shaders = len(cfg.shaders)
-    total_frames = sum(len(shader.times) for shader in cfg.shaders)
+    """
+    Render shaders from configuration file.
+
+    Frames go through the write-behind writer when one is given; frames the
+    journal already records as completed and intact are skipped.
+    """
+    failed_writes = len(writer.failed) if writer is not None else 0
+    skipped_frames = 0
+    if isinstance(cfg.shaders, list):
+        total_shaders = len(cfg.shaders)
+        total_frames = sum(len(shader.times) for shader in cfg.shaders)
+        description = f"Rendering {total_shaders} shaders ({total_frames} frames total)..."
+    else:
+        # A streamed manifest is not read ahead just to count it
+        total_shaders = total_frames = None
+        description = "Rendering shaders from manifest..."
 
     if not ai_info:
+        rendered_shaders = 0
+        rendered_frames = 0
         with Progress(
             SpinnerColumn(),
             TextColumn("[progress.description]{task.description}"),
             console=console,
         ) as progress:
-            task = progress.add_task(
-                f"Rendering {total_shaders} shaders ({total_frames} frames total)...",
-                total=total_frames,
-            )
+            task = progress.add_task(description, total=total_frames)
 
             for shader_config in cfg.shaders:
+                rendered_shaders += 1
                 if verbose:
                     console.print(f"\nProcessing shader: {shader_config.input}")
 
@@ -262,9 +721,23 @@ def render_from_config(
 
                 shader_content = shader_path.read_text()
 
+                if jobs > 1 or calibrate_layout:
+                    rendered_frames += render_shards(
+                        shader_content, shader_config, jobs, cfg.defaults, resume=resume,
+                        progress=lambda count: progress.update(task, advance=count),
+                        threads=threads, calibrate_layout=calibrate_layout,
+                    )
+                    continue
+
+                job = job_key(shader_content, shader_config, cfg.defaults)
                 # Render frames
                 for i, time_code in enumerate(shader_config.times):
-                    output_path = Path(shader_config.output % i)
+                    output_path = Path(shader_config.output % frame_number(shader_config.times, i))
+                    key = frame_key(job, time_code)
+                    if journal is not None and journal.is_done(output_path, key):
+                        skipped_frames += 1
+                        progress.update(task, advance=1)
+                        continue
                     output_path.parent.mkdir(parents=True, exist_ok=True)
 
                     try:
@@ -273,8 +746,11 @@ def render_from_config(
                             time_code,
                             output_path,
                             shader_config,
+                            writer=writer,
+                            journal_key=key,
                         )
                         progress.update(task, advance=1)
+                        rendered_frames += 1
 
                         if verbose:
                             console.print(
@@ -286,15 +762,20 @@ def render_from_config(
                             f"[red]Error rendering frame {i+1} at time {time_code}s: {e}[/red]"
                         )
 
+        rendered_frames -= report_write_failures(writer, failed_writes, ai_info)
+        if skipped_frames:
+            console.print(f"Skipped {skipped_frames} frames completed by an earlier run")
         console.print(
-            f"\n[green]Successfully rendered {total_frames} frames from {total_shaders} shaders[/green]"
+            f"\n[green]Successfully rendered {rendered_frames} frames from {rendered_shaders} shaders[/green]"
         )
     else:
         # AI-friendly output mode
         successful_frames = 0
         failed_frames = 0
+        shader_count = 0
 
         for shader_config in cfg.shaders:
+            shader_count += 1
             # Load shader content
             shader_path = Path(shader_config.input)
             if not shader_path.exists():
@@ -303,9 +784,23 @@ def render_from_config(
 
             shader_content = shader_path.read_text()
 
+            if jobs > 1 or calibrate_layout:
+                rendered = render_shards(
+                    shader_content, shader_config, jobs, cfg.defaults, ai_info=True, resume=resume,
+                    progress=lambda count: None, threads=threads, calibrate_layout=calibrate_layout,
+                )
+                successful_frames += rendered
+                failed_frames += len(shader_config.times) - rendered
+                continue
+
+            job = job_key(shader_content, shader_config, cfg.defaults)
             # Render frames
             for i, time_code in enumerate(shader_config.times):
-                output_path = Path(shader_config.output % i)
+                output_path = Path(shader_config.output % frame_number(shader_config.times, i))
+                key = frame_key(job, time_code)
+                if journal is not None and journal.is_done(output_path, key):
+                    skipped_frames += 1
+                    continue
                 output_path.parent.mkdir(parents=True, exist_ok=True)
 
                 try:
@@ -314,6 +809,8 @@ def render_from_config(
                         time_code,
                         output_path,
                         shader_config,
+                        writer=writer,
+                        journal_key=key,
                     )
                     successful_frames += 1
 
@@ -321,24 +818,39 @@ def render_from_config(
                     failed_frames += 1
                     print(format_error_for_ai(e, f"rendering frame {i+1} at time {time_code}s"))
 
+        write_failures = report_write_failures(writer, failed_writes, ai_info)
+        successful_frames -= write_failures
+        failed_frames += write_failures
+        if skipped_frames:
+            print(f"Skipped {skipped_frames} frames completed by an earlier run")
         if failed_frames == 0:
             print(format_success_for_ai(successful_frames))
         else:
-            print(f"Completed rendering with {successful_frames} successful frames and {failed_frames} failed frames from {total_shaders} shaders")
+            print(f"Completed rendering with {successful_frames} successful frames and {failed_frames} failed frames from {shader_count} shaders")
 
 
 def render_single_shader(
     renderer: ShaderRenderer,
     shader_content: str,
-    time_codes: List[float],
+    time_codes: Sequence[float],
     output_path: Path,
     verbose: bool,
     shader_config=None,
     ai_info: bool = False,
+    writer: Optional[FrameWriter] = None,
+    journal: Optional[ProgressJournal] = None,
 ) -> None:
-    """Render a single shader with multiple time codes."""
+    """
+    Render a single shader with multiple time codes.
+
+    Frames go through the write-behind writer when one is given; frames the
+    journal already records as completed and intact are skipped.
+    """
     output_path = Path(output_path)
     output_path.parent.mkdir(parents=True, exist_ok=True)
+    failed_writes = len(writer.failed) if writer is not None else 0
+    skipped_frames = 0
+    job = job_key(shader_content, shader_config, renderer.config.defaults)
 
     if not ai_info:
         successful_frames = 0
@@ -356,9 +868,14 @@ def render_single_shader(
             for i, time_code in enumerate(time_codes):
                 # Handle output path formatting
                 if "%" in str(output_path):
-                    frame_path = Path(str(output_path) % i)
+                    frame_path = Path(str(output_path) % frame_number(time_codes, i))
                 else:
                     frame_path = output_path
+                key = frame_key(job, time_code)
+                if journal is not None and journal.is_done(frame_path, key):
+                    skipped_frames += 1
+                    progress.update(task, advance=1)
+                    continue
 
                 try:
                     renderer.render_frame(
@@ -366,6 +883,8 @@ def render_single_shader(
                         time_code,
                         frame_path,
                         shader_config,
+                        writer=writer,
+                        journal_key=key,
                     )
                     progress.update(task, advance=1)
                     successful_frames += 1
@@ -381,6 +900,11 @@ def render_single_shader(
                         f"[red]Error rendering frame {i+1} at time {time_code}s: {e}[/red]"
                     )
 
+        write_failures = report_write_failures(writer, failed_writes, ai_info)
+        successful_frames -= write_failures
+        failed_frames += write_failures
+        if skipped_frames:
+            console.print(f"Skipped {skipped_frames} frames completed by an earlier run")
         if failed_frames == 0:
             console.print(f"\n[green]Successfully rendered {successful_frames} frames[/green]")
         else:
@@ -393,9 +917,13 @@ def render_single_shader(
         for i, time_code in enumerate(time_codes):
             # Handle output path formatting
             if "%" in str(output_path):
-                frame_path = Path(str(output_path) % i)
+                frame_path = Path(str(output_path) % frame_number(time_codes, i))
             else:
                 frame_path = output_path
+            key = frame_key(job, time_code)
+            if journal is not None and journal.is_done(frame_path, key):
+                skipped_frames += 1
+                continue
 
             try:
                 renderer.render_frame(
@@ -403,6 +931,8 @@ def render_single_shader(
                     time_code,
                     frame_path,
                     shader_config,
+                    writer=writer,
+                    journal_key=key,
                 )
                 successful_frames += 1
 
@@ -410,12 +940,77 @@ def render_single_shader(
                 failed_frames += 1
                 print(format_error_for_ai(e, f"rendering frame {i+1} at time {time_code}s"))
 
+        write_failures = report_write_failures(writer, failed_writes, ai_info)
+        successful_frames -= write_failures
+        failed_frames += write_failures
+        if skipped_frames:
+            print(f"Skipped {skipped_frames} frames completed by an earlier run")
         if failed_frames == 0:
             console.print(f"\n[green]Successfully rendered {successful_frames} frames[/green]")
         else:
             console.print(f"\n[yellow]Completed rendering with {successful_frames} successful frame(s) and {failed_frames} failed frame(s)[/yellow]")
 
 
+def render_realtime(
+    renderer: ShaderRenderer,
+    shader_content: str,
+    shader_config: ShaderConfig,
+    fps: float,
+    duration: Optional[float],
+    ring_name: str,
+    ring_slots: int,
+    ai_info: bool = False,
+) -> None:
+    """Render on the wall clock into a shared-memory ring until interrupted or duration ends."""
+    width = shader_config.get_width(renderer.config.defaults)
+    height = shader_config.get_height(renderer.config.defaults)
+    try:
+        session = renderer.session(shader_content, shader_config)
+    except Exception as e:
+        if ai_info:
+            print(format_error_for_ai(e, "shader compilation"))
+        else:
+            console.print(f"[red]Error: {e}[/red]")
+        raise typer.Exit(1)
+
+    # Ctrl-C ends the run between frames so the final statistics are still reported
+    stop = threading.Event()
+    previous_handler = signal.signal(signal.SIGINT, lambda *_: stop.set())
+
+    def report(stats: RealtimeStats) -> None:
+        if ai_info:
+            print(f"Realtime: {stats.describe()}")
+        else:
+            console.print(f"[cyan]{stats.describe()}[/cyan]")
+
+    ring = FrameRing.create(width, height, slots=ring_slots, name=ring_name, fps=fps)
+    try:
+        message = (
+            f"Rendering {width}x{height} at {fps:g} fps into shared memory '{ring.name}' "
+            f"({ring.slots} slots of {ring.frame_bytes} bytes)"
+        )
+        if ai_info:
+            print(message)
+        else:
+            console.print(f"[green]{message}[/green] - press Ctrl-C to stop")
+        with session:
+            stats = run_realtime(session.render_into, ring, fps, duration=duration, stop=stop, report=report)
+    except Exception as e:
+        if ai_info:
+            print(format_error_for_ai(e, "realtime rendering"))
+        else:
+            console.print(f"[red]Error: {e}[/red]")
+        raise typer.Exit(1)
+    finally:
+        ring.close()
+        signal.signal(signal.SIGINT, previous_handler)
+
+    if ai_info:
+        print(f"Realtime run finished: {stats.describe()}")
+    else:
+        console.print(f"\n[green]Realtime run finished:[/green] {stats.describe()}")
+
+
 # Move info and mcp_server to standalone functions (not Typer commands)
 # def info_command(): # Removed info command
 #     """Show information about the ISF Shader Renderer."""
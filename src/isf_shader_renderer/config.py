@@ -1,11 +1,19 @@
 """Configuration management for ISF Shader Renderer (ShaderRendererConfig)."""
 
+import json
 from dataclasses import dataclass, field
+from functools import lru_cache
 from pathlib import Path
-from typing import List, Optional, Dict, Any
+from typing import Iterable, Iterator, List, Optional, Dict, Any, Sequence
 
 import yaml
-from jsonschema import validate
+from jsonschema import Draft7Validator
+
+from .timebase import TimeRange, parse_times
+from .utils import parse_time_range
+
+# Manifest files read line by line instead of loaded whole
+STREAMING_SUFFIXES = (".ndjson", ".jsonl")
 
 @dataclass
 class Defaults:
@@ -20,11 +28,15 @@ class ShaderConfig:
     """Configuration for a single shader."""
     input: str
     output: str
-    times: List[float]
+    # A list, or a lazy TimeRange for long sequences
+    times: Sequence[float]
     width: Optional[int] = None
     height: Optional[int] = None
     quality: Optional[int] = None
     inputs: Optional[Dict[str, Any]] = None
+    specialize: bool = False
+    audio: Optional[str] = None
+    video: Optional[str] = None
 
     def get_width(self, defaults: Defaults) -> int:
         return self.width if self.width is not None else defaults.width
@@ -39,7 +51,51 @@ class ShaderConfig:
 class ShaderRendererConfig:
     """Main configuration class for the ISF Shader Renderer."""
     defaults: Defaults = field(default_factory=Defaults)
-    shaders: List[ShaderConfig] = field(default_factory=list)
+    # A list, or a Manifest streaming jobs from an NDJSON file
+    shaders: Iterable[ShaderConfig] = field(default_factory=list)
+    # Whether image inputs may name files on this machine; off when inputs come from MCP/HTTP clients
+    allow_image_paths: bool = True
+
+# A time as a number or an exact "num/den" string
+RATIONAL_SCHEMA = {
+    "oneOf": [
+        {"type": "number"},
+        {"type": "string", "pattern": r"^\s*-?[0-9]+(\.[0-9]+)?(\s*/\s*[1-9][0-9]*)?\s*$"},
+    ],
+}
+
+TIMES_SCHEMA = {
+    "oneOf": [
+        {
+            "type": "array",
+            "items": {"type": "number"},
+            "minItems": 1,
+        },
+        # "start:end:step" as accepted by parse_time_range, end exclusive
+        {
+            "type": "string",
+            "pattern": r"^\s*[0-9]+(\.[0-9]+)?\s*[-:]\s*[0-9]+(\.[0-9]+)?\s*:\s*[0-9]+(\.[0-9]+)?(\s*/\s*[0-9]+(\.[0-9]+)?)?\s*$",
+        },
+        {
+            "type": "object",
+            "required": ["fps"],
+            "properties": {
+                "start": RATIONAL_SCHEMA,
+                "end": RATIONAL_SCHEMA,
+                "count": {"type": "integer", "minimum": 1},
+                "first": {"type": "integer", "minimum": 0},
+                "fps": {
+                    "oneOf": [
+                        {"type": "number", "exclusiveMinimum": 0},
+                        {"type": "string", "pattern": r"^\s*[0-9]+(\.[0-9]+)?(\s*/\s*[1-9][0-9]*)?\s*$"},
+                    ],
+                },
+            },
+            "oneOf": [{"required": ["end"]}, {"required": ["count"]}],
+            "additionalProperties": False,
+        },
+    ],
+}
 
 CONFIG_SCHEMA = {
     "type": "object",
@@ -62,15 +118,14 @@ CONFIG_SCHEMA = {
                 "properties": {
                     "input": {"type": "string"},
                     "output": {"type": "string"},
-                    "times": {
-                        "type": "array",
-                        "items": {"type": "number"},
-                        "minItems": 1,
-                    },
+                    "times": TIMES_SCHEMA,
                     "width": {"type": "integer", "minimum": 1},
                     "height": {"type": "integer", "minimum": 1},
                     "quality": {"type": "integer", "minimum": 1, "maximum": 100},
                     "inputs": {"type": "object"},
+                    "specialize": {"type": "boolean"},
+                    "audio": {"type": "string"},
+                    "video": {"type": "string"},
                 },
                 "additionalProperties": False,
             },
@@ -79,36 +134,130 @@ CONFIG_SCHEMA = {
     "additionalProperties": False,
 }
 
+SHADER_SCHEMA = CONFIG_SCHEMA["properties"]["shaders"]["items"]
+DEFAULTS_SCHEMA = CONFIG_SCHEMA["properties"]["defaults"]
+
+
+@lru_cache(maxsize=None)
+def _validator(name: str) -> Draft7Validator:
+    """Compile a schema once per process instead of on every validation."""
+    schema = {"config": CONFIG_SCHEMA, "shader": SHADER_SCHEMA, "defaults": DEFAULTS_SCHEMA}[name]
+    Draft7Validator.check_schema(schema)
+    return Draft7Validator(schema)
+
+
+def _check(name: str, data: Any, where: str = "") -> None:
+    error = next(_validator(name).iter_errors(data), None)
+    if error is not None:
+        location = "/".join(str(part) for part in error.absolute_path)
+        raise ValueError(f"Invalid configuration format{where}: {error.message}" + (f" (at {location})" if location else ""))
+
+
+def _defaults(data: Dict[str, Any]) -> Defaults:
+    return Defaults(
+        width=data.get("width", 1920),
+        height=data.get("height", 1080),
+        quality=data.get("quality", 95),
+        output_format=data.get("output_format", "png"),
+    )
+
+
+def _times(value: Any) -> Sequence[float]:
+    """A times entry as a sequence; range strings and {start, end, fps} both exclude end."""
+    if isinstance(value, str):
+        return parse_time_range(value)
+    return parse_times(value)
+
+
+def _shader_config(shader_data: Dict[str, Any]) -> ShaderConfig:
+    return ShaderConfig(
+        input=shader_data["input"],
+        output=shader_data["output"],
+        times=_times(shader_data["times"]),
+        width=shader_data.get("width"),
+        height=shader_data.get("height"),
+        quality=shader_data.get("quality"),
+        inputs=shader_data.get("inputs"),
+        specialize=shader_data.get("specialize", False),
+        audio=shader_data.get("audio"),
+        video=shader_data.get("video"),
+    )
+
+
+class Manifest:
+    """
+    Shader jobs streamed from an NDJSON file, one JSON object per line.
+
+    An optional first line {"defaults": {...}} sets the defaults; every
+    other line is a shader job with the fields of a config file entry
+    (times may be a range {start, fps, first, end | count} or "start:end:step").
+    Lines are parsed and validated only as iteration reaches them, with a
+    validator compiled once, so a job of any length starts rendering
+    immediately and memory stays flat. Iterating again re-reads the file.
+    """
+
+    def __init__(self, path: Path):
+        self.path = Path(path)
+
+    def __iter__(self) -> Iterator[ShaderConfig]:
+        with open(self.path, "r", encoding="utf-8") as f:
+            for number, line in enumerate(f, start=1):
+                line = line.strip()
+                if not line or line.startswith("#"):
+                    continue
+                where = f" in {self.path.name} line {number}"
+                try:
+                    data = json.loads(line)
+                except json.JSONDecodeError as e:
+                    raise ValueError(f"Invalid JSON{where}: {e}")
+                if isinstance(data, dict) and "defaults" in data and len(data) == 1:
+                    if number != 1:
+                        raise ValueError(f"Defaults must be on the first line{where}")
+                    continue
+                _check("shader", data, where)
+                yield _shader_config(data)
+
+    def __bool__(self) -> bool:
+        return any(True for _ in self)
+
+    def read_defaults(self) -> Defaults:
+        """Defaults from the first line (built-in defaults if it holds a job)."""
+        with open(self.path, "r", encoding="utf-8") as f:
+            first = f.readline().strip()
+        if first:
+            try:
+                data = json.loads(first)
+            except json.JSONDecodeError as e:
+                raise ValueError(f"Invalid JSON in {self.path.name} line 1: {e}")
+            if isinstance(data, dict) and "defaults" in data and len(data) == 1:
+                _check("defaults", data["defaults"], f" in {self.path.name} line 1")
+                return _defaults(data["defaults"])
+        return Defaults()
+
+
 def load_config(config_path: Path) -> ShaderRendererConfig:
+    """
+    Load a YAML configuration file or an NDJSON job manifest.
+
+    YAML files are validated whole; manifests (.ndjson/.jsonl) are returned
+    with shaders as a Manifest that parses jobs as they are consumed. In
+    both, times may be a list, a range {start, fps, first, end | count} or a
+    range string "start:end:step"; ranges exclude their end and are expanded
+    lazily.
+    """
     if not config_path.exists():
         raise FileNotFoundError(f"Configuration file not found: {config_path}")
+    if config_path.suffix.lower() in STREAMING_SUFFIXES:
+        manifest = Manifest(config_path)
+        return ShaderRendererConfig(defaults=manifest.read_defaults(), shaders=manifest)
     with open(config_path, 'r', encoding='utf-8') as f:
         data = yaml.safe_load(f)
-    try:
-        validate(instance=data, schema=CONFIG_SCHEMA)
-    except Exception as e:
-        raise ValueError(f"Invalid configuration format: {e}")
+    _check("config", data)
     config = ShaderRendererConfig()
     if "defaults" in data:
-        defaults_data = data["defaults"]
-        config.defaults = Defaults(
-            width=defaults_data.get("width", 1920),
-            height=defaults_data.get("height", 1080),
-            quality=defaults_data.get("quality", 95),
-            output_format=defaults_data.get("output_format", "png"),
-        )
+        config.defaults = _defaults(data["defaults"])
     if "shaders" in data:
-        for shader_data in data["shaders"]:
-            shader_config = ShaderConfig(
-                input=shader_data["input"],
-                output=shader_data["output"],
-                times=shader_data["times"],
-                width=shader_data.get("width"),
-                height=shader_data.get("height"),
-                quality=shader_data.get("quality"),
-                inputs=shader_data.get("inputs"),
-            )
-            config.shaders.append(shader_config)
+        config.shaders = [_shader_config(shader_data) for shader_data in data["shaders"]]
     return config
 
 def save_config(config: ShaderRendererConfig, config_path: Path) -> None:
@@ -123,11 +272,14 @@ def save_config(config: ShaderRendererConfig, config_path: Path) -> None:
             {
                 "input": shader.input,
                 "output": shader.output,
-                "times": shader.times,
+                "times": shader.times.to_dict() if isinstance(shader.times, TimeRange) else list(shader.times),
                 **({"width": shader.width} if shader.width is not None else {}),
                 **({"height": shader.height} if shader.height is not None else {}),
                 **({"quality": shader.quality} if shader.quality is not None else {}),
                 **({"inputs": shader.inputs} if shader.inputs is not None else {}),
+                **({"specialize": True} if shader.specialize else {}),
+                **({"audio": shader.audio} if shader.audio is not None else {}),
+                **({"video": shader.video} if shader.video is not None else {}),
             }
             for shader in config.shaders
         ],
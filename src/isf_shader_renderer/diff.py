@@ -0,0 +1,225 @@
+"""Vectorized image comparison for rendered frames."""
+
+import math
+from typing import Any, Dict, List
+
+import numpy as np
+
+from .fingerprint import to_luminance
+
+# Per-pixel difference (max over RGB, 8-bit levels) above which a pixel counts as changed
+DIFF_THRESHOLD = 8
+
+# Changed pixels are grouped on a grid of square tiles before finding regions
+REGION_TILE = 16
+MAX_REGIONS = 16
+
+# SSIM is evaluated on non-overlapping square windows of luminance
+SSIM_WINDOW = 8
+SSIM_C1 = 0.01 ** 2
+SSIM_C2 = 0.03 ** 2
+
+
+def _as_rgb8(pixels: np.ndarray) -> np.ndarray:
+    """Return the RGB channels of a frame as uint8."""
+    if pixels.ndim == 2:
+        pixels = np.repeat(pixels[:, :, None], 3, axis=2)
+    rgb = pixels[:, :, :3]
+    if rgb.dtype == np.uint8:
+        return rgb
+    if np.issubdtype(rgb.dtype, np.integer):
+        return (rgb >> (8 * (rgb.dtype.itemsize - 1))).astype(np.uint8)
+    return (np.clip(np.nan_to_num(rgb), 0.0, 1.0) * 255.0 + 0.5).astype(np.uint8)
+
+
+def difference_magnitude(a: np.ndarray, b: np.ndarray) -> np.ndarray:
+    """
+    Compute the per-pixel difference between two frames.
+
+    Args:
+        a: First frame (height, width[, channels])
+        b: Second frame with the same height and width
+
+    Returns:
+        (height, width) uint8 array holding the largest RGB channel difference
+    """
+    if a.shape[:2] != b.shape[:2]:
+        raise ValueError(f"Frame sizes differ: {a.shape[1]}x{a.shape[0]} vs {b.shape[1]}x{b.shape[0]}")
+    rgb_a = _as_rgb8(a)
+    rgb_b = _as_rgb8(b)
+    # max(a, b) - min(a, b) stays in uint8 and avoids widening to int16
+    delta = np.maximum(rgb_a, rgb_b)
+    delta -= np.minimum(rgb_a, rgb_b)
+    return delta.max(axis=2)
+
+
+def psnr(a: np.ndarray, b: np.ndarray) -> float:
+    """
+    Peak signal-to-noise ratio over RGB in dB (infinity for identical frames).
+
+    Args:
+        a: First frame
+        b: Second frame
+
+    Returns:
+        PSNR in dB
+    """
+    rgb_a = _as_rgb8(a).astype(np.int16)
+    rgb_b = _as_rgb8(b).astype(np.int16)
+    rgb_a -= rgb_b
+    mse = float(np.square(rgb_a, dtype=np.int32).mean())
+    if mse == 0.0:
+        return math.inf
+    return 10.0 * math.log10(255.0 ** 2 / mse)
+
+
+def ssim(a: np.ndarray, b: np.ndarray, window: int = SSIM_WINDOW) -> float:
+    """
+    Mean structural similarity of the luminance of two frames.
+
+    Statistics are computed on non-overlapping window x window blocks, which
+    keeps the whole computation a handful of array reductions.
+
+    Args:
+        a: First frame
+        b: Second frame
+        window: Block size in pixels
+
+    Returns:
+        SSIM in the range -1..1 (1.0 for identical frames)
+    """
+    luma_a = to_luminance(a)
+    luma_b = to_luminance(b)
+    height, width = luma_a.shape
+    window = max(1, min(window, height, width))
+    rows, cols = height // window, width // window
+    shape = (rows, window, cols, window)
+    block_a = luma_a[: rows * window, : cols * window].reshape(shape)
+    block_b = luma_b[: rows * window, : cols * window].reshape(shape)
+
+    mean_a = block_a.mean(axis=(1, 3))
+    mean_b = block_b.mean(axis=(1, 3))
+    var_a = np.square(block_a).mean(axis=(1, 3)) - np.square(mean_a)
+    var_b = np.square(block_b).mean(axis=(1, 3)) - np.square(mean_b)
+    covariance = (block_a * block_b).mean(axis=(1, 3)) - mean_a * mean_b
+
+    numerator = (2.0 * mean_a * mean_b + SSIM_C1) * (2.0 * covariance + SSIM_C2)
+    denominator = (np.square(mean_a) + np.square(mean_b) + SSIM_C1) * (var_a + var_b + SSIM_C2)
+    return float((numerator / denominator).mean())
+
+
+def changed_regions(
+    mask: np.ndarray,
+    tile: int = REGION_TILE,
+    max_regions: int = MAX_REGIONS,
+) -> List[Dict[str, Any]]:
+    """
+    Find bounding boxes of changed areas.
+
+    The mask is reduced to a grid of tiles first, and 8-connected groups of
+    changed tiles become regions, so the labelling loop runs over a few
+    thousand tiles instead of millions of pixels.
+
+    Args:
+        mask: (height, width) boolean array of changed pixels
+        tile: Tile size in pixels
+        max_regions: Maximum number of regions returned (largest first)
+
+    Returns:
+        List of {x, y, width, height, changed_fraction} dictionaries
+    """
+    height, width = mask.shape
+    row_starts = np.arange(0, height, tile)
+    col_starts = np.arange(0, width, tile)
+    counts = np.add.reduceat(np.add.reduceat(mask.astype(np.uint32), row_starts, axis=0), col_starts, axis=1)
+    occupied = counts > 0
+    labels = np.zeros(occupied.shape, dtype=np.int32)
+    tile_rows, tile_cols = occupied.shape
+
+    regions = []
+    for start in zip(*np.nonzero(occupied)):
+        if labels[start]:
+            continue
+        label = len(regions) + 1
+        labels[start] = label
+        stack = [start]
+        top, left = start
+        bottom, right = start
+        changed = 0
+        while stack:
+            row, col = stack.pop()
+            changed += int(counts[row, col])
+            top, bottom = min(top, row), max(bottom, row)
+            left, right = min(left, col), max(right, col)
+            for next_row in range(max(row - 1, 0), min(row + 2, tile_rows)):
+                for next_col in range(max(col - 1, 0), min(col + 2, tile_cols)):
+                    if occupied[next_row, next_col] and not labels[next_row, next_col]:
+                        labels[next_row, next_col] = label
+                        stack.append((next_row, next_col))
+        x = int(left * tile)
+        y = int(top * tile)
+        box_width = int(min((right + 1) * tile, width) - x)
+        box_height = int(min((bottom + 1) * tile, height) - y)
+        regions.append({
+            "x": x,
+            "y": y,
+            "width": box_width,
+            "height": box_height,
+            "changed_fraction": round(changed / float(box_width * box_height), 4),
+        })
+
+    regions.sort(key=lambda region: region["width"] * region["height"], reverse=True)
+    return regions[:max_regions]
+
+
+def diff_heatmap(magnitude: np.ndarray) -> np.ndarray:
+    """
+    Colorize a difference magnitude image (black, red, yellow, white).
+
+    Args:
+        magnitude: (height, width) uint8 array from difference_magnitude
+
+    Returns:
+        (height, width, 3) uint8 RGB heatmap
+    """
+    # Stretch small differences so they remain visible
+    scaled = np.minimum(magnitude.astype(np.uint16) * 3, 765)
+    heat = np.empty(magnitude.shape + (3,), dtype=np.uint8)
+    heat[:, :, 0] = np.minimum(scaled, 255)
+    heat[:, :, 1] = np.clip(scaled.astype(np.int16) - 255, 0, 255)
+    heat[:, :, 2] = np.clip(scaled.astype(np.int16) - 510, 0, 255)
+    return heat
+
+
+def compare_frames(
+    a: np.ndarray,
+    b: np.ndarray,
+    threshold: int = DIFF_THRESHOLD,
+    max_regions: int = MAX_REGIONS,
+) -> Dict[str, Any]:
+    """
+    Compare two frames.
+
+    Args:
+        a: First frame
+        b: Second frame with the same size
+        threshold: Per-pixel difference (8-bit levels) counted as a change
+        max_regions: Maximum number of changed regions reported
+
+    Returns:
+        Dictionary with psnr (None when identical), ssim, mean/max absolute
+        difference (0..1), changed pixel fraction, changed regions and an
+        identical flag
+    """
+    magnitude = difference_magnitude(a, b)
+    mask = magnitude > threshold
+    peak_signal = psnr(a, b)
+    return {
+        "psnr": None if math.isinf(peak_signal) else round(peak_signal, 3),
+        "ssim": round(ssim(a, b), 5),
+        "mean_abs_diff": round(float(magnitude.mean()) / 255.0, 5),
+        "max_abs_diff": round(int(magnitude.max()) / 255.0, 5),
+        "changed_fraction": round(float(mask.mean()), 5),
+        "regions": changed_regions(mask, max_regions=max_regions),
+        "identical": bool(magnitude.max() == 0),
+    }
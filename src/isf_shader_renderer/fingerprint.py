@@ -0,0 +1,152 @@
+"""Perceptual fingerprints for rendered frames."""
+
+from functools import lru_cache
+from typing import Tuple
+
+import numpy as np
+
+from .stats import LUMA_WEIGHTS
+
+# Number of set bits in every byte value
+_POPCOUNT = np.array([bin(i).count("1") for i in range(256)], dtype=np.uint8)
+
+
+def to_luminance(pixels: np.ndarray) -> np.ndarray:
+    """
+    Convert a frame to float32 luminance in the 0..1 range.
+
+    Args:
+        pixels: Frame as an (height, width[, channels]) array, integer or float
+
+    Returns:
+        (height, width) float32 luminance array
+    """
+    if np.issubdtype(pixels.dtype, np.integer):
+        scale = np.float32(1.0 / float(np.iinfo(pixels.dtype).max))
+    else:
+        scale = np.float32(1.0)
+    if pixels.ndim == 2:
+        return pixels.astype(np.float32) * scale
+    if pixels.shape[2] >= 3:
+        return (pixels[:, :, :3].astype(np.float32) @ LUMA_WEIGHTS) * scale
+    return pixels[:, :, 0].astype(np.float32) * scale
+
+
+def downsample(luma: np.ndarray, size: Tuple[int, int]) -> np.ndarray:
+    """
+    Area-average a luminance image down to a fixed size.
+
+    Args:
+        luma: (height, width) luminance array
+        size: Target (width, height); must not exceed the source size
+
+    Returns:
+        (size[1], size[0]) float32 array
+    """
+    out_width, out_height = size
+    height, width = luma.shape
+    if out_width > width or out_height > height:
+        raise ValueError(f"Cannot downsample {width}x{height} to {out_width}x{out_height}")
+    rows = np.linspace(0, height, out_height + 1).astype(np.intp)
+    cols = np.linspace(0, width, out_width + 1).astype(np.intp)
+    summed = np.add.reduceat(np.add.reduceat(luma, rows[:-1], axis=0), cols[:-1], axis=1)
+    area = np.outer(np.diff(rows), np.diff(cols)).astype(np.float32)
+    return (summed / area).astype(np.float32)
+
+
+def difference_hash(pixels: np.ndarray, hash_size: int = 8) -> int:
+    """
+    Compute a difference hash (dHash) of a frame.
+
+    Each bit records whether a cell is brighter than its right-hand neighbour
+    on a (hash_size + 1) x hash_size grid of the downsampled luminance.
+
+    Args:
+        pixels: Frame array (see to_luminance) or a luminance image
+        hash_size: Grid size; the hash has hash_size**2 bits
+
+    Returns:
+        Hash as a Python integer
+    """
+    small = downsample(to_luminance(pixels), (hash_size + 1, hash_size))
+    bits = small[:, 1:] > small[:, :-1]
+    return bits_to_int(bits)
+
+
+@lru_cache(maxsize=8)
+def _dct_matrix(size: int) -> np.ndarray:
+    """Orthonormal DCT-II basis as a (size, size) matrix."""
+    n = np.arange(size)
+    basis = np.cos(np.pi * (2 * n[None, :] + 1) * n[:, None] / (2 * size))
+    basis *= np.sqrt(2.0 / size)
+    basis[0] /= np.sqrt(2.0)
+    return basis.astype(np.float32)
+
+
+def perceptual_hash(pixels: np.ndarray, hash_size: int = 8, highfreq_factor: int = 4) -> int:
+    """
+    Compute a DCT-based perceptual hash (pHash) of a frame.
+
+    The luminance is reduced to a (hash_size * highfreq_factor) square, its 2D
+    DCT is taken as two matrix products, and each bit of the hash records
+    whether a low-frequency coefficient is above their median.
+
+    Args:
+        pixels: Frame array (see to_luminance) or a luminance image
+        hash_size: Low-frequency block size; the hash has hash_size**2 bits
+        highfreq_factor: Oversampling of the reduced image before the DCT
+
+    Returns:
+        Hash as a Python integer
+    """
+    size = hash_size * highfreq_factor
+    luma = to_luminance(pixels)
+    height, width = luma.shape
+    if height < size or width < size:
+        # Tiny frames are upsampled by repetition so the DCT size stays fixed
+        luma = np.repeat(np.repeat(luma, -(-size // height), axis=0), -(-size // width), axis=1)
+    small = downsample(luma, (size, size))
+    basis = _dct_matrix(size)
+    coefficients = (basis @ small @ basis.T)[:hash_size, :hash_size]
+    median = np.median(coefficients.ravel()[1:])
+    return bits_to_int(coefficients > median)
+
+
+def bits_to_int(bits: np.ndarray) -> int:
+    """Pack a boolean array (row-major, most significant bit first) into an int."""
+    packed = np.packbits(bits.ravel())
+    value = int.from_bytes(packed.tobytes(), "big")
+    return value >> (packed.size * 8 - bits.size)
+
+
+def hamming_distance(a: int, b: int) -> int:
+    """Return the number of differing bits between two hashes."""
+    return bin(a ^ b).count("1")
+
+
+def hamming_distances(hashes: np.ndarray, value: int) -> np.ndarray:
+    """
+    Hamming distance from one 64-bit hash to an array of hashes.
+
+    Args:
+        hashes: uint64 array of hashes
+        value: Hash to compare against
+
+    Returns:
+        uint8 array of bit distances
+    """
+    xor = np.bitwise_xor(hashes.astype(np.uint64, copy=False), np.uint64(value))
+    if hasattr(np, "bitwise_count"):
+        return np.bitwise_count(xor)
+    # Per-byte popcount table lookup, summed over the 8 bytes of each hash
+    return _POPCOUNT[xor.view(np.uint8)].reshape(-1, 8).sum(axis=1, dtype=np.uint8)
+
+
+def format_hash(value: int, bits: int = 64) -> str:
+    """Format a hash as fixed-width hexadecimal."""
+    return f"{value:0{bits // 4}x}"
+
+
+def parse_hash(text: str) -> int:
+    """Parse a hash formatted by format_hash."""
+    return int(text, 16)
@@ -0,0 +1,131 @@
+"""Frame iterators over a compiled render session, for sync and async consumers."""
+
+import asyncio
+import hashlib
+import time
+from typing import Any, AsyncIterator, Iterator, Optional, Sequence
+
+import numpy as np
+from PIL import Image
+
+from .buffers import frame_pool, image_into
+from .timebase import TimeRange, frame_number
+
+# Frames rendered ahead of the async consumer
+ASYNC_LOOKAHEAD = 1
+
+
+class Frame:
+    """
+    One rendered frame.
+
+    index is the frame number: the position in a list of time codes, or
+    the frame number on the timebase of a TimeRange.
+
+    pixels is a read-only (height, width, 4) uint8 view of a pooled buffer
+    that is reused once the iterator is asked for the next frame; call
+    copy() to keep a frame beyond that.
+    """
+
+    __slots__ = ("index", "time", "pixels", "render_ms", "convert_ms", "_hash")
+
+    def __init__(self, index: int, time: float, pixels: np.ndarray, render_ms: float, convert_ms: float):
+        self.index = index
+        self.time = time
+        self.pixels = pixels
+        self.render_ms = render_ms
+        self.convert_ms = convert_ms
+        self._hash: Optional[str] = None
+
+    @property
+    def width(self) -> int:
+        """Frame width in pixels."""
+        return self.pixels.shape[1]
+
+    @property
+    def height(self) -> int:
+        """Frame height in pixels."""
+        return self.pixels.shape[0]
+
+    @property
+    def hash(self) -> str:
+        """BLAKE2b-128 of the pixels (hex), computed on first use."""
+        if self._hash is None:
+            self._hash = hashlib.blake2b(self.pixels.data, digest_size=16).hexdigest()
+        return self._hash
+
+    def copy(self) -> "Frame":
+        """A frame that owns its pixels."""
+        frame = Frame(self.index, self.time, self.pixels.copy(), self.render_ms, self.convert_ms)
+        frame._hash = self._hash
+        return frame
+
+    def to_image(self) -> Image.Image:
+        """The frame as a PIL image (a copy)."""
+        return Image.fromarray(self.pixels.copy(), "RGBA")
+
+    def __repr__(self) -> str:
+        return f"Frame(index={self.index}, time={self.time:g}, size={self.width}x{self.height}, render_ms={self.render_ms:.2f})"
+
+
+class FrameStream:
+    """
+    Frames of a session at a sequence of time codes, rendered as they are consumed.
+
+    Iterate with `for` to render on the calling thread, or with `async for`
+    to render on the session's render thread one frame ahead of the
+    consumer, so the event loop is never blocked by GL work. Either way only
+    the frames in flight are held in memory.
+    """
+
+    def __init__(self, session: Any, time_codes: Sequence[float], width: int, height: int):
+        self.session = session
+        # A TimeRange stays lazy; frame numbers then come from its timebase
+        self.time_codes: Sequence[float] = time_codes if isinstance(time_codes, TimeRange) else [float(t) for t in time_codes]
+        self.width = width
+        self.height = height
+
+    def __len__(self) -> int:
+        return len(self.time_codes)
+
+    def _render(self, index: int, buffer: np.ndarray) -> Frame:
+        time_code = self.time_codes[index]
+        started = time.perf_counter()
+        image = self.session.render_image(time_code, self.width, self.height)
+        rendered = time.perf_counter()
+        image_into(image, buffer)
+        converted = time.perf_counter()
+        pixels = buffer.view()
+        pixels.flags.writeable = False
+        return Frame(frame_number(self.time_codes, index), time_code, pixels, (rendered - started) * 1000, (converted - rendered) * 1000)
+
+    def __iter__(self) -> Iterator[Frame]:
+        with frame_pool().lease(self.width, self.height) as buffer:
+            for index in range(len(self.time_codes)):
+                yield self._render(index, buffer)
+
+    def __aiter__(self) -> AsyncIterator[Frame]:
+        return self._render_ahead()
+
+    async def _render_ahead(self) -> AsyncIterator[Frame]:
+        loop = asyncio.get_running_loop()
+        executor = self.session.executor
+        pool = frame_pool()
+        # One buffer per frame in flight plus the one the consumer holds
+        buffers = [pool.acquire(self.width, self.height) for _ in range(ASYNC_LOOKAHEAD + 1)]
+        pending = {}
+        try:
+            for index in range(len(self.time_codes)):
+                # Keep ASYNC_LOOKAHEAD renders queued behind the frame being awaited
+                for ahead in range(index, min(index + ASYNC_LOOKAHEAD + 1, len(self.time_codes))):
+                    if ahead not in pending:
+                        buffer = buffers[ahead % len(buffers)]
+                        pending[ahead] = loop.run_in_executor(executor, self._render, ahead, buffer)
+                frame = await pending.pop(index)
+                yield frame
+        finally:
+            # A buffer must not return to the pool while the render thread still writes it
+            if pending:
+                await asyncio.gather(*pending.values(), return_exceptions=True)
+            for buffer in buffers:
+                pool.release(buffer)
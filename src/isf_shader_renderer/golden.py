@@ -0,0 +1,420 @@
+"""Golden-image regression store indexed by perceptual hashes."""
+
+import hashlib
+import json
+import os
+import tempfile
+from concurrent.futures import as_completed
+from dataclasses import asdict, dataclass, field
+from pathlib import Path
+from typing import Any, Callable, Dict, List, Optional, Tuple
+
+import numpy as np
+from PIL import Image
+
+from .buffers import frame_pool
+from .config import ShaderConfig, ShaderRendererConfig
+from .fingerprint import (
+    difference_hash,
+    format_hash,
+    hamming_distance,
+    hamming_distances,
+    parse_hash,
+    perceptual_hash,
+)
+from .renderer import ShaderRenderer, _error_message
+from .scheduler import CpuTopology, plan_layout, worker_pool
+
+INDEX_FILENAME = "index.json"
+IMAGE_DIRNAME = "images"
+INDEX_VERSION = 1
+
+# Reference renders are small: perceptual hashes only look at coarse structure
+DEFAULT_SIZE = (256, 144)
+DEFAULT_TIMES = (0.0, 1.0)
+
+# Maximum pHash/dHash Hamming distance (out of 64 bits) still treated as a match
+DEFAULT_THRESHOLD = 6
+
+
+def source_hash(shader_content: str) -> str:
+    """Return the SHA-256 of a shader source."""
+    return hashlib.sha256(shader_content.encode("utf-8")).hexdigest()
+
+
+def reference_key(
+    shader: str,
+    time_code: float,
+    width: int,
+    height: int,
+    inputs: Optional[Dict[str, Any]] = None,
+) -> str:
+    """
+    Build the store key for one reference frame.
+
+    Args:
+        shader: Shader identifier (path relative to the corpus root)
+        time_code: Render time in seconds
+        width: Render width
+        height: Render height
+        inputs: Shader input values, if any
+
+    Returns:
+        Hex key that is stable across runs and platforms
+    """
+    payload = json.dumps(
+        {
+            "shader": shader,
+            "time": round(float(time_code), 6),
+            "size": [width, height],
+            "inputs": inputs or {},
+        },
+        sort_keys=True,
+        separators=(",", ":"),
+    )
+    return hashlib.sha256(payload.encode("utf-8")).hexdigest()[:32]
+
+
+@dataclass
+class GoldenEntry:
+    """One reference render in the store."""
+
+    key: str
+    shader: str
+    time_code: float
+    width: int
+    height: int
+    source_sha256: str
+    phash: str
+    dhash: str
+    image: str
+    inputs: Dict[str, Any] = field(default_factory=dict)
+
+
+class GoldenStore:
+    """
+    Directory of reference renders plus a JSON index.
+
+    Layout::
+
+        <root>/index.json          key -> GoldenEntry
+        <root>/images/<key>.png    reference frames
+
+    Entries are looked up by key; perceptual hashes are additionally kept in
+    uint64 arrays so near-duplicate searches are a single vectorized pass.
+    """
+
+    def __init__(self, root: Path):
+        self.root = Path(root)
+        self.image_dir = self.root / IMAGE_DIRNAME
+        self._entries: Dict[str, GoldenEntry] = {}
+        self._hash_keys: Optional[List[str]] = None
+        self._phashes: Optional[np.ndarray] = None
+        index_path = self.root / INDEX_FILENAME
+        if index_path.exists():
+            data = json.loads(index_path.read_text())
+            for item in data.get("entries", []):
+                entry = GoldenEntry(**item)
+                self._entries[entry.key] = entry
+
+    def __len__(self) -> int:
+        return len(self._entries)
+
+    def __contains__(self, key: str) -> bool:
+        return key in self._entries
+
+    def get(self, key: str) -> Optional[GoldenEntry]:
+        """Return the entry for a key, if present."""
+        return self._entries.get(key)
+
+    def entries(self) -> List[GoldenEntry]:
+        """Return all entries ordered by shader and time."""
+        return sorted(self._entries.values(), key=lambda e: (e.shader, e.time_code, e.key))
+
+    def put(self, entry: GoldenEntry, pixels: Optional[np.ndarray] = None) -> None:
+        """
+        Add or replace an entry, optionally writing its reference image.
+
+        Args:
+            entry: Entry to store
+            pixels: Frame to save as the reference PNG (skipped if the image was
+                already written, e.g. by a worker process)
+        """
+        if pixels is not None:
+            self.image_dir.mkdir(parents=True, exist_ok=True)
+            Image.fromarray(pixels).save(self.root / entry.image)
+        self._entries[entry.key] = entry
+        self._hash_keys = None
+        self._phashes = None
+
+    def save(self) -> None:
+        """Write the index atomically."""
+        self.root.mkdir(parents=True, exist_ok=True)
+        data = {
+            "version": INDEX_VERSION,
+            "entries": [asdict(entry) for entry in self.entries()],
+        }
+        fd, tmp_path = tempfile.mkstemp(dir=self.root, prefix=".index-", suffix=".json")
+        try:
+            with os.fdopen(fd, "w") as f:
+                json.dump(data, f, indent=1)
+            os.replace(tmp_path, self.root / INDEX_FILENAME)
+        except Exception:
+            os.unlink(tmp_path)
+            raise
+
+    def find_similar(self, phash: int, max_distance: int = DEFAULT_THRESHOLD) -> List[Tuple[GoldenEntry, int]]:
+        """
+        Find reference frames whose pHash is within max_distance bits.
+
+        Args:
+            phash: Perceptual hash to look up
+            max_distance: Maximum Hamming distance
+
+        Returns:
+            (entry, distance) pairs, closest first
+        """
+        if self._phashes is None:
+            self._hash_keys = list(self._entries)
+            self._phashes = np.array(
+                [parse_hash(self._entries[key].phash) for key in self._hash_keys], dtype=np.uint64
+            )
+        if not self._hash_keys:
+            return []
+        distances = hamming_distances(self._phashes, phash)
+        matches = np.flatnonzero(distances <= max_distance)
+        ordered = matches[np.argsort(distances[matches], kind="stable")]
+        return [(self._entries[self._hash_keys[i]], int(distances[i])) for i in ordered]
+
+
+@dataclass
+class RegressionJob:
+    """All frames of one shader, rendered by a single worker."""
+
+    shader: str
+    path: str
+    times: List[float]
+    width: int
+    height: int
+    expected: Dict[str, Tuple[str, str]] = field(default_factory=dict)
+    threshold: int = DEFAULT_THRESHOLD
+    save_dir: Optional[str] = None
+    save_all: bool = False
+    # Shader input values, part of every reference key
+    inputs: Dict[str, Any] = field(default_factory=dict)
+
+
+@dataclass
+class RegressionResult:
+    """Outcome for one reference frame."""
+
+    key: str
+    shader: str
+    time_code: float
+    status: str  # "ok", "deviation", "missing", "error" or "updated"
+    phash: Optional[str] = None
+    dhash: Optional[str] = None
+    source_sha256: Optional[str] = None
+    phash_distance: Optional[int] = None
+    dhash_distance: Optional[int] = None
+    message: str = ""
+    image: Optional[str] = None
+
+
+def run_job(job: RegressionJob) -> List[RegressionResult]:
+    """
+    Render and fingerprint every frame of one shader.
+
+    Runs in a worker process: the shader is compiled once, frames are
+    compared against the expected hashes here, and only the frames that
+    need saving are encoded to PNG.
+
+    Args:
+        job: Frames to render and their expected hashes
+
+    Returns:
+        One RegressionResult per time code
+    """
+    keys = [reference_key(job.shader, t, job.width, job.height, job.inputs) for t in job.times]
+    try:
+        shader_content = Path(job.path).read_text()
+    except OSError as e:
+        return [
+            RegressionResult(key, job.shader, t, "error", message=f"Cannot read shader: {e}")
+            for key, t in zip(keys, job.times)
+        ]
+
+    digest = source_hash(shader_content)
+    renderer = ShaderRenderer(ShaderRendererConfig())
+    try:
+        config = ShaderConfig(
+            input=job.path,
+            output="",
+            times=job.times,
+            width=job.width,
+            height=job.height,
+            inputs=dict(job.inputs) or None,
+        )
+        session = renderer.session(shader_content, config)
+    except RuntimeError as e:
+        return [
+            RegressionResult(key, job.shader, t, "error", source_sha256=digest, message=_error_message(e))
+            for key, t in zip(keys, job.times)
+        ]
+
+    results = []
+    with session, frame_pool().lease(job.width, job.height) as pixels:
+        for key, time_code in zip(keys, job.times):
+            try:
+                session.render_array(time_code, out=pixels)
+            except RuntimeError as e:
+                results.append(RegressionResult(
+                    key, job.shader, time_code, "error", source_sha256=digest, message=_error_message(e)
+                ))
+                continue
+
+            phash = perceptual_hash(pixels)
+            dhash = difference_hash(pixels)
+            result = RegressionResult(
+                key,
+                job.shader,
+                time_code,
+                "updated" if job.save_all else "ok",
+                phash=format_hash(phash),
+                dhash=format_hash(dhash),
+                source_sha256=digest,
+            )
+            expected = job.expected.get(key)
+            if not job.save_all:
+                if expected is None:
+                    result.status = "missing"
+                    result.message = "No reference render"
+                else:
+                    result.phash_distance = hamming_distance(phash, parse_hash(expected[0]))
+                    result.dhash_distance = hamming_distance(dhash, parse_hash(expected[1]))
+                    if max(result.phash_distance, result.dhash_distance) > job.threshold:
+                        result.status = "deviation"
+            if job.save_dir and (job.save_all or result.status != "ok"):
+                image_path = Path(job.save_dir) / f"{key}.png"
+                image_path.parent.mkdir(parents=True, exist_ok=True)
+                Image.fromarray(pixels).save(image_path)
+                result.image = str(image_path)
+            results.append(result)
+    return results
+
+
+def run_regression(
+    store: GoldenStore,
+    shaders: List[Tuple[str, Path]],
+    times: List[float],
+    size: Tuple[int, int] = DEFAULT_SIZE,
+    threshold: int = DEFAULT_THRESHOLD,
+    jobs: int = 1,
+    update: bool = False,
+    failure_dir: Optional[Path] = None,
+    progress: Optional[Callable[[int], None]] = None,
+    inputs: Optional[Dict[str, Any]] = None,
+) -> List[RegressionResult]:
+    """
+    Re-render a corpus and compare it with (or record it into) the store.
+
+    Shaders are distributed across worker processes; each worker keeps its
+    own renderer so GPU contexts are never shared.
+
+    Args:
+        store: Golden store to check against or update
+        shaders: (identifier, path) pairs
+        times: Time codes rendered for every shader
+        size: Render (width, height)
+        threshold: Maximum pHash/dHash distance treated as a match
+        jobs: Number of worker processes (1 renders in this process)
+        update: Record renders as the new references instead of checking
+        failure_dir: Where to save renders of deviating frames in check mode
+        progress: Called with the number of frames finished after each shader
+        inputs: Shader input values for every render; references recorded
+            with other inputs are kept apart
+
+    Returns:
+        Results ordered by shader and time
+    """
+    width, height = size
+    inputs = dict(inputs or {})
+    regression_jobs = []
+    for name, path in shaders:
+        expected = {}
+        for t in times:
+            key = reference_key(name, t, width, height, inputs)
+            entry = store.get(key)
+            if entry is not None:
+                expected[key] = (entry.phash, entry.dhash)
+        save_dir = store.image_dir if update else failure_dir
+        regression_jobs.append(RegressionJob(
+            shader=name,
+            path=str(path),
+            times=list(times),
+            width=width,
+            height=height,
+            expected=expected,
+            threshold=threshold,
+            save_dir=str(save_dir) if save_dir else None,
+            save_all=update,
+            inputs=inputs,
+        ))
+
+    results: List[RegressionResult] = []
+    if jobs <= 1:
+        for job in regression_jobs:
+            results.extend(run_job(job))
+            if progress:
+                progress(len(job.times))
+    else:
+        # One rasterizer thread per worker for small references, rather than a thread per CPU in each
+        layout = plan_layout(CpuTopology.detect(), width, height, jobs=jobs)
+        with worker_pool(layout) as executor:
+            futures = {executor.submit(run_job, job): job for job in regression_jobs}
+            for future in as_completed(futures):
+                results.extend(future.result())
+                if progress:
+                    progress(len(futures[future].times))
+
+    results.sort(key=lambda r: (r.shader, r.time_code))
+    for result in results:
+        entry = store.get(result.key)
+        if result.status == "deviation" and entry is not None and result.source_sha256 != entry.source_sha256:
+            result.message = "Shader source changed since the reference was recorded"
+    if update:
+        for result in results:
+            if result.status != "updated":
+                continue
+            store.put(GoldenEntry(
+                key=result.key,
+                shader=result.shader,
+                time_code=result.time_code,
+                width=width,
+                height=height,
+                source_sha256=result.source_sha256 or "",
+                phash=result.phash or "",
+                dhash=result.dhash or "",
+                image=f"{IMAGE_DIRNAME}/{result.key}.png",
+                inputs=inputs,
+            ))
+        store.save()
+    return results
+
+
+def find_shaders(corpus: Path, pattern: str = "*.fs") -> List[Tuple[str, Path]]:
+    """
+    List the shaders of a corpus with their store identifiers.
+
+    Args:
+        corpus: A shader file or a directory searched recursively
+        pattern: Filename pattern for shaders
+
+    Returns:
+        (identifier, path) pairs sorted by identifier; identifiers are POSIX
+        paths relative to the corpus directory
+    """
+    corpus = Path(corpus)
+    if corpus.is_file():
+        return [(corpus.name, corpus)]
+    return sorted((path.relative_to(corpus).as_posix(), path) for path in corpus.rglob(pattern))
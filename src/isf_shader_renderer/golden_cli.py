@@ -0,0 +1,203 @@
+"""Command-line interface for the golden-image regression store."""
+
+import os
+from pathlib import Path
+from typing import Dict, List, Optional
+
+import typer
+from rich.console import Console
+from rich.progress import BarColumn, Progress, SpinnerColumn, TextColumn
+from rich.table import Table
+
+from .golden import (
+    DEFAULT_SIZE,
+    DEFAULT_THRESHOLD,
+    DEFAULT_TIMES,
+    GoldenStore,
+    RegressionResult,
+    find_shaders,
+    run_regression,
+)
+
+app = typer.Typer(
+    name="isf-golden",
+    help="Record and check golden reference renders of a shader corpus",
+    add_completion=False,
+)
+console = Console()
+
+
+def _parse_inputs(inputs: Optional[str], ai_info: bool) -> Dict[str, str]:
+    """Parse comma-separated key=value pairs, as the render CLI's --inputs."""
+    values = {}
+    for pair in (inputs or "").split(","):
+        if not pair.strip():
+            continue
+        if "=" not in pair:
+            message = f"Invalid input format: {pair} (expected key=value)"
+            if ai_info:
+                print(message)
+            else:
+                console.print(f"[red]{message}[/red]")
+            raise typer.Exit(1)
+        key, value = pair.split("=", 1)
+        values[key.strip()] = value.strip()
+    return values
+
+
+def _run(
+    corpus: Path,
+    store_dir: Path,
+    times: List[float],
+    width: int,
+    height: int,
+    threshold: int,
+    jobs: int,
+    update: bool,
+    failure_dir: Optional[Path],
+    ai_info: bool,
+    inputs: Optional[Dict[str, str]] = None,
+) -> List[RegressionResult]:
+    """Render the corpus with a progress bar and return the results."""
+    shaders = find_shaders(corpus)
+    if not shaders:
+        message = f"Error: No shaders found in '{corpus}'"
+        if ai_info:
+            print(message)
+        else:
+            console.print(f"[red]{message}[/red]")
+        raise typer.Exit(1)
+
+    store = GoldenStore(store_dir)
+    times = times or list(DEFAULT_TIMES)
+    total = len(shaders) * len(times)
+    kwargs = dict(
+        times=times,
+        size=(width, height),
+        threshold=threshold,
+        jobs=jobs,
+        update=update,
+        failure_dir=failure_dir,
+        inputs=inputs,
+    )
+    if ai_info:
+        return run_regression(store, shaders, **kwargs)
+
+    with Progress(
+        SpinnerColumn(),
+        TextColumn("[progress.description]{task.description}"),
+        BarColumn(),
+        TextColumn("{task.completed}/{task.total}"),
+        console=console,
+    ) as progress:
+        task = progress.add_task(
+            f"Rendering {len(shaders)} shaders ({total} frames) with {jobs} worker(s)...",
+            total=total,
+        )
+        return run_regression(
+            store, shaders, progress=lambda count: progress.update(task, advance=count), **kwargs
+        )
+
+
+@app.command("update")
+def update(
+    corpus: Path = typer.Argument(..., help="Shader file or directory of .fs shaders"),
+    store_dir: Path = typer.Option(..., "--store", "-s", help="Golden store directory"),
+    time: List[float] = typer.Option([], "--time", "-t", help="Time code (can be specified multiple times)"),
+    width: int = typer.Option(DEFAULT_SIZE[0], "--width", "-w", help="Reference render width"),
+    height: int = typer.Option(DEFAULT_SIZE[1], "--height", "-h", help="Reference render height"),
+    jobs: int = typer.Option(os.cpu_count() or 1, "--jobs", "-j", help="Number of worker processes"),
+    inputs: Optional[str] = typer.Option(
+        None, "--inputs", help="Shader input values as key=value pairs, recorded as separate references"
+    ),
+    ai_info: bool = typer.Option(False, "--ai-info", help="Format output for AI processing"),
+) -> None:
+    """Render the corpus and record the frames as the new references."""
+    input_dict = _parse_inputs(inputs, ai_info)
+    results = _run(corpus, store_dir, time, width, height, DEFAULT_THRESHOLD, jobs, True, None, ai_info, input_dict)
+    errors = [r for r in results if r.status == "error"]
+    recorded = len(results) - len(errors)
+    for result in errors:
+        line = f"{result.shader} t={result.time_code:g}: {result.message}"
+        if ai_info:
+            print(f"Error: {line}")
+        else:
+            console.print(f"[red]Error:[/red] {line}")
+    summary = f"Recorded {recorded} reference frame(s) in {store_dir}"
+    if errors:
+        summary += f"; {len(errors)} frame(s) failed to render"
+    if ai_info:
+        print(summary)
+    else:
+        console.print(f"[green]{summary}[/green]")
+    if errors:
+        raise typer.Exit(1)
+
+
+@app.command("check")
+def check(
+    corpus: Path = typer.Argument(..., help="Shader file or directory of .fs shaders"),
+    store_dir: Path = typer.Option(..., "--store", "-s", help="Golden store directory"),
+    time: List[float] = typer.Option([], "--time", "-t", help="Time code (can be specified multiple times)"),
+    width: int = typer.Option(DEFAULT_SIZE[0], "--width", "-w", help="Render width (must match the references)"),
+    height: int = typer.Option(DEFAULT_SIZE[1], "--height", "-h", help="Render height (must match the references)"),
+    threshold: int = typer.Option(
+        DEFAULT_THRESHOLD, "--threshold", help="Maximum pHash/dHash distance in bits (0-64) treated as a match"
+    ),
+    jobs: int = typer.Option(os.cpu_count() or 1, "--jobs", "-j", help="Number of worker processes"),
+    failure_dir: Optional[Path] = typer.Option(
+        None, "--failures", help="Directory for renders of frames that deviate"
+    ),
+    inputs: Optional[str] = typer.Option(
+        None, "--inputs", help="Shader input values as key=value pairs (must match the references)"
+    ),
+    ai_info: bool = typer.Option(False, "--ai-info", help="Format output for AI processing"),
+) -> None:
+    """Re-render the corpus and report only frames that deviate from their references."""
+    input_dict = _parse_inputs(inputs, ai_info)
+    results = _run(corpus, store_dir, time, width, height, threshold, jobs, False, failure_dir, ai_info, input_dict)
+    problems = [r for r in results if r.status != "ok"]
+
+    if ai_info:
+        for result in problems:
+            line = f"{result.status.upper()}: {result.shader} at t={result.time_code:g}s"
+            if result.phash_distance is not None:
+                line += f" (pHash distance {result.phash_distance}, dHash distance {result.dhash_distance})"
+            if result.message:
+                line += f" - {result.message}"
+            print(line)
+    elif problems:
+        table = Table(title="Perceptual deviations")
+        table.add_column("Status", style="red")
+        table.add_column("Shader", style="cyan")
+        table.add_column("Time", justify="right")
+        table.add_column("pHash", justify="right")
+        table.add_column("dHash", justify="right")
+        table.add_column("Details")
+        for result in problems:
+            table.add_row(
+                result.status,
+                result.shader,
+                f"{result.time_code:g}",
+                "" if result.phash_distance is None else str(result.phash_distance),
+                "" if result.dhash_distance is None else str(result.dhash_distance),
+                result.message or (result.image or ""),
+            )
+        console.print(table)
+
+    summary = f"Checked {len(results)} frame(s): {len(results) - len(problems)} match, {len(problems)} problem(s)"
+    if ai_info:
+        print(summary)
+    else:
+        console.print(f"[{'red' if problems else 'green'}]{summary}[/]")
+    if problems:
+        raise typer.Exit(1)
+
+
+def cli():
+    """Entry point for the golden store CLI."""
+    app()
+
+
+if __name__ == "__main__":
+    cli()
@@ -1,26 +1,53 @@
 """MCP handlers for ISF shader operations."""
 
 import base64
+import os
 import sys
+import time
 import tempfile
-import traceback
 from io import StringIO
 from pathlib import Path
 from typing import Dict, Any, List, Optional
 
-from .models import RenderRequest, RenderResponse, ValidateRequest, ValidateResponse, GetShaderInfoRequest, GetShaderInfoResponse, Resource
-from ..renderer import ShaderRenderer
-from ..config import ShaderRendererConfig
-from .utils import encode_image_to_base64
+from .models import RenderRequest, RenderResponse, ValidateRequest, ValidateResponse, GetShaderInfoRequest, GetShaderInfoResponse, AnalyzeSequenceRequest, AnalyzeSequenceResponse, DiffShadersRequest, DiffShadersResponse, FindSimilarShadersRequest, FindSimilarShadersResponse, Resource
+from ..renderer import ShaderRenderer, _build_error_info, _error_message
+from ..config import ShaderConfig, ShaderRendererConfig
+from ..diff import compare_frames, diff_heatmap, difference_magnitude
+from ..similarity import ShaderLibraryIndex, fingerprint_base64_image, fingerprint_shader
+from ..stats import compute_frame_stats, describe_frame_stats
+from ..temporal import DEFAULT_PROBE_SIZE, analyze_sequence, select_keyframes
+from .streaming import Base64File
+from .utils import encode_array_to_base64_png, encode_image_to_base64
+
+# Resolution of the probe frame rendered for validate_shader statistics
+STATS_PROBE_SIZE = (160, 90)
+
+# Environment variable naming the default shader library index for find_similar_shaders
+SHADER_LIBRARY_ENV = "ISF_SHADER_LIBRARY"
+
+# Environment variable listing (os.pathsep-separated) directories under which clients
+# may name other libraries; without it only the default library is searched
+SHADER_LIBRARY_ROOTS_ENV = "ISF_SHADER_LIBRARY_ROOTS"
 
 
 class ISFShaderHandlers:
     """Handlers for MCP requests."""
     
-    def __init__(self):
-        """Initialize handlers with default configuration."""
-        self.config = ShaderRendererConfig()
+    def __init__(self, lazy_frames: bool = False):
+        """
+        Initialize handlers with default configuration.
+
+        Args:
+            lazy_frames: Return rendered frames as Base64File references that
+                streaming transports encode while writing the response,
+                instead of base64 strings
+        """
+        self.lazy_frames = lazy_frames
+        # Client-supplied image inputs must carry their data, not name files on this machine
+        self.config = ShaderRendererConfig(allow_image_paths=False)
         self.renderer = ShaderRenderer(self.config)
+        # Loaded library indexes keyed by path, reloaded when index.json changes
+        self._library_indexes: Dict[str, Any] = {}
     
     async def call_tool(self, name: str, arguments: Dict[str, Any]) -> Dict[str, Any]:
         """Handle tool calls."""
@@ -30,6 +57,12 @@ class ISFShaderHandlers:
             return await self._validate_shader(arguments)
         elif name == "get_shader_info":
             return await self._get_shader_info(arguments)
+        elif name == "analyze_sequence":
+            return await self._analyze_sequence(arguments)
+        elif name == "diff_shaders":
+            return await self._diff_shaders(arguments)
+        elif name == "find_similar_shaders":
+            return await self._find_similar_shaders(arguments)
         else:
             raise ValueError(f"Unknown tool: {name}")
     
@@ -69,22 +102,10 @@ class ISFShaderHandlers:
                         elif "details" in error_info:
                             detailed_message = str(error_info["details"])
                     else:
-                        error_info = {
-                            "type": type(e).__name__,
-                            "message": str(e),
-                            "error_code": None,
-                            "details": None,
-                            "traceback": traceback.format_exc()
-                        }
+                        error_info = _build_error_info(e)
                         detailed_message = str(e)
                 except Exception as e:
-                    error_info = {
-                        "type": type(e).__name__,
-                        "message": str(e),
-                        "error_code": None,
-                        "details": None,
-                        "traceback": traceback.format_exc()
-                    }
+                    error_info = _build_error_info(e)
                     detailed_message = str(e)
                 
                 # Create AI-friendly error message
@@ -113,33 +134,76 @@ class ISFShaderHandlers:
             output_dir = Path(f"/tmp/isf_renderer/{session_id}")
             output_dir.mkdir(parents=True, exist_ok=True)
             
+            # Keyframe mode: probe at low resolution and keep the most distinct times
+            time_codes = request.time_codes
+            keyframe_selection = None
+            if request.keyframes is not None:
+                time_codes = select_keyframes(
+                    self.renderer,
+                    request.shader_content,
+                    request.keyframes,
+                    start_time=request.start_time,
+                    end_time=request.end_time,
+                    samples=request.probe_samples,
+                    shader_config=ShaderConfig(input="<mcp>", output="", times=[0.0], inputs=request.inputs),
+                )
+                keyframe_selection = {
+                    "requested": request.keyframes,
+                    "selected": len(time_codes),
+                    "time_range": [request.start_time, request.end_time],
+                    "probe_samples": request.probe_samples,
+                    "probe_size": f"{DEFAULT_PROBE_SIZE[0]}x{DEFAULT_PROBE_SIZE[1]}",
+                }
+            
+            shader_config = ShaderConfig(
+                input="<mcp>",
+                output=str(output_dir),
+                times=time_codes,
+                width=request.width,
+                height=request.height,
+                quality=request.quality,
+                inputs=request.inputs,
+            )
+            
             # Render frames
             content = []
             rendered_files = []
             rendered_frames = []
+            frame_warnings = []
             
-            for i, time_code in enumerate(request.time_codes):
+            for i, time_code in enumerate(time_codes):
                 # Create output file path (use PNG)
                 filename = f"frame_{i:03d}_t{time_code:.2f}.png"
                 output_path = output_dir / filename
                 
                 # Render frame
-                self.renderer.render_frame(
+                stats = self.renderer.render_frame(
                     request.shader_content,
                     time_code,
-                    output_path
+                    output_path,
+                    shader_config,
+                    compute_stats=request.include_stats,
                 )
                 
                 # Check file size
                 file_size = output_path.stat().st_size
-                rendered_files.append({
+                file_info = {
                     "path": str(output_path),
                     "filename": filename,
                     "size": file_size,
                     "time_code": time_code
-                })
-                # Add to rendered_frames as base64
-                rendered_frames.append(encode_image_to_base64(output_path))
+                }
+                if stats is not None:
+                    file_info["stats"] = stats
+                    frame_warnings.extend(
+                        f"Frame {i} (t={time_code:.2f}s): {warning}"
+                        for warning in describe_frame_stats(stats)
+                    )
+                rendered_files.append(file_info)
+                # Add to rendered_frames as base64 (encoded while the response is written, if lazy)
+                rendered_frames.append(
+                    Base64File(output_path) if self.lazy_frames else encode_image_to_base64(output_path)
+                )
                 # Add to content as file reference
                 content.append({
                     "type": "text",
@@ -158,33 +222,35 @@ class ISFShaderHandlers:
             # Extract shader info
             shader_info = self.renderer.get_shader_info(request.shader_content)
             
+            metadata = {
+                "time_codes": time_codes,
+                "dimensions": f"{request.width}x{request.height}",
+                "quality": request.quality,
+                "frame_count": len(rendered_files),
+                "output_directory": str(output_dir),
+                "rendered_files": rendered_files
+            }
+            if keyframe_selection is not None:
+                metadata["keyframe_selection"] = keyframe_selection
+            message = f"Successfully rendered {len(rendered_files)} frames to {output_dir}"
+            if keyframe_selection is not None and len(time_codes) < request.keyframes:
+                message += f" (only {len(time_codes)} visually distinct frame(s) found for {request.keyframes} keyframes)"
+            if frame_warnings:
+                metadata["frame_warnings"] = frame_warnings
+                message += f" ({len(frame_warnings)} frame warning(s): {frame_warnings[0]})"
+            
             # Return file-based response
             return {
                 "success": True,
-                "message": f"Successfully rendered {len(rendered_files)} frames to {output_dir}",
+                "message": message,
                 "rendered_frames": rendered_frames,
-                "metadata": {
-                    "time_codes": request.time_codes,
-                    "dimensions": f"{request.width}x{request.height}",
-                    "quality": request.quality,
-                    "frame_count": len(rendered_files),
-                    "output_directory": str(output_dir),
-                    "rendered_files": rendered_files
-                },
+                "metadata": metadata,
                 "logs": logs,
                 "shader_info": shader_info
             }
             
         except Exception as e:
-            error_info = {
-                "type": type(e).__name__,
-                "message": str(e),
-            }
-            if hasattr(e, 'error_code'):
-                error_info["error_code"] = getattr(e, 'error_code')
-            if hasattr(e, 'details'):
-                error_info["details"] = getattr(e, 'details')
-            error_info["traceback"] = traceback.format_exc()
+            error_info = _build_error_info(e)
             
             # Create AI-friendly error message
             ai_message = self._format_error_message_for_ai(str(e), error_info)
@@ -236,21 +302,9 @@ class ISFShaderHandlers:
                     if isinstance(e.args[0], dict):
                         error_info = e.args[0]
                     else:
-                        error_info = {
-                            "type": type(e).__name__,
-                            "message": str(e),
-                            "error_code": None,
-                            "details": None,
-                            "traceback": traceback.format_exc()
-                        }
+                        error_info = _build_error_info(e)
                 except Exception as e:
-                    error_info = {
-                        "type": type(e).__name__,
-                        "message": str(e),
-                        "error_code": None,
-                        "details": None,
-                        "traceback": traceback.format_exc()
-                    }
+                    error_info = _build_error_info(e)
                 else:
                     error_info = None
             else:
@@ -264,12 +318,34 @@ class ISFShaderHandlers:
             if "RENDERSIZE" not in content_upper:
                 warnings.append("No RENDERSIZE uniform found - shader may not be responsive")
             
+            # Render a small probe frame so blank output is caught without shipping pixels
+            stats = None
+            if request.include_stats and is_valid:
+                probe_width, probe_height = STATS_PROBE_SIZE
+                try:
+                    pixels = self.renderer.render_array(
+                        request.shader_content,
+                        0.0,
+                        ShaderConfig(
+                            input="<mcp>",
+                            output="",
+                            times=[0.0],
+                            width=probe_width,
+                            height=probe_height,
+                        ),
+                    )
+                    stats = compute_frame_stats(pixels)
+                    warnings.extend(describe_frame_stats(stats))
+                except Exception as e:
+                    warnings.append(f"Could not render probe frame for statistics: {e}")
+            
             response = ValidateResponse(
                 success=is_valid and not errors,
                 message="Shader validation completed",
                 shader_info=shader_info,
                 errors=errors,
-                warnings=warnings
+                warnings=warnings,
+                stats=stats
             ).model_dump()
             
             if error_info:
@@ -278,15 +354,7 @@ class ISFShaderHandlers:
             return response
             
         except Exception as e:
-            error_info = {
-                "type": type(e).__name__,
-                "message": str(e),
-            }
-            if hasattr(e, 'error_code'):
-                error_info["error_code"] = getattr(e, 'error_code')
-            if hasattr(e, 'details'):
-                error_info["details"] = getattr(e, 'details')
-            error_info["traceback"] = traceback.format_exc()
+            error_info = _build_error_info(e)
             # Create AI-friendly error message
             ai_message = self._format_error_message_for_ai(str(e), error_info)
             
@@ -315,15 +383,7 @@ class ISFShaderHandlers:
             ).model_dump()
             
         except Exception as e:
-            error_info = {
-                "type": type(e).__name__,
-                "message": str(e),
-            }
-            if hasattr(e, 'error_code'):
-                error_info["error_code"] = getattr(e, 'error_code')
-            if hasattr(e, 'details'):
-                error_info["details"] = getattr(e, 'details')
-            error_info["traceback"] = traceback.format_exc()
+            error_info = _build_error_info(e)
             # Create AI-friendly error message
             ai_message = self._format_error_message_for_ai(str(e), error_info)
             
@@ -334,6 +394,200 @@ class ISFShaderHandlers:
                 errors=[str(e)]
             ).model_dump() | {"error_details": error_info}
     
+    async def _analyze_sequence(self, arguments: Dict[str, Any]) -> Dict[str, Any]:
+        """Handle temporal analysis requests (loop period, motion, static segments)."""
+        try:
+            # Parse request
+            request = AnalyzeSequenceRequest(**arguments)
+            
+            # Render a low-resolution probe sequence and analyze it
+            analysis = analyze_sequence(
+                self.renderer,
+                request.shader_content,
+                start_time=request.start_time,
+                end_time=request.end_time,
+                samples=request.samples,
+                probe_size=(request.probe_width, request.probe_height),
+                suggestions=request.suggestions,
+            )
+            
+            return AnalyzeSequenceResponse(
+                success=True,
+                message=analysis.summary(),
+                analysis=analysis.to_dict(),
+                errors=[]
+            ).model_dump()
+            
+        except Exception as e:
+            error_info = _build_error_info(e)
+            # Create AI-friendly error message
+            ai_message = self._format_error_message_for_ai(str(e), error_info)
+            
+            return AnalyzeSequenceResponse(
+                success=False,
+                message=ai_message,
+                analysis=None,
+                errors=[str(e)]
+            ).model_dump() | {"error_details": error_info}
+    
+    async def _diff_shaders(self, arguments: Dict[str, Any]) -> Dict[str, Any]:
+        """Handle comparison of two shader versions (or two input sets) in one call."""
+        try:
+            # Parse request
+            request = DiffShadersRequest(**arguments)
+            
+            shader_b = request.shader_content_b if request.shader_content_b is not None else request.shader_content
+            inputs_b = request.inputs_b if request.inputs_b is not None else request.inputs_a
+            configs = [
+                ShaderConfig(
+                    input=f"<mcp:{label}>",
+                    output="",
+                    times=request.time_codes,
+                    width=request.width,
+                    height=request.height,
+                    inputs=inputs,
+                )
+                for label, inputs in (("a", request.inputs_a), ("b", inputs_b))
+            ]
+            
+            # Compile both versions once and keep them alive for every time code
+            sessions = []
+            try:
+                for label, content, shader_config in zip("AB", (request.shader_content, shader_b), configs):
+                    try:
+                        sessions.append(self.renderer.session(content, shader_config))
+                    except RuntimeError as e:
+                        raise RuntimeError(f"Version {label} failed to compile: {_error_message(e)}") from e
+                
+                comparisons = []
+                heatmaps = []
+                for time_code in request.time_codes:
+                    frame_a = sessions[0].render_array(time_code)
+                    frame_b = sessions[1].render_array(time_code)
+                    comparison = compare_frames(frame_a, frame_b, threshold=request.threshold)
+                    comparison["time_code"] = time_code
+                    comparisons.append(comparison)
+                    if request.include_heatmap:
+                        heatmap = diff_heatmap(difference_magnitude(frame_a, frame_b))
+                        heatmaps.append(encode_array_to_base64_png(heatmap))
+            finally:
+                for session in sessions:
+                    session.close()
+            
+            changed = [c for c in comparisons if not c["identical"]]
+            if not changed:
+                message = f"Versions render identically at all {len(comparisons)} time code(s)"
+            else:
+                worst = min(changed, key=lambda c: c["ssim"])
+                message = (
+                    f"Versions differ at {len(changed)} of {len(comparisons)} time code(s); "
+                    f"largest change at t={worst['time_code']:.2f}s "
+                    f"(SSIM {worst['ssim']:.3f}, {worst['changed_fraction']:.1%} of pixels, "
+                    f"{len(worst['regions'])} region(s))"
+                )
+            
+            return DiffShadersResponse(
+                success=True,
+                message=message,
+                comparisons=comparisons,
+                heatmaps=heatmaps,
+                errors=[]
+            ).model_dump()
+            
+        except Exception as e:
+            error_info = _build_error_info(e)
+            # Create AI-friendly error message
+            ai_message = self._format_error_message_for_ai(str(e), error_info)
+            
+            return DiffShadersResponse(
+                success=False,
+                message=ai_message,
+                errors=[str(e)]
+            ).model_dump() | {"error_details": error_info}
+    
+    def _resolve_library(self, library_path: Optional[str]) -> str:
+        """
+        The library a request may search: the default one, or one under an allowed root.
+
+        library_path comes from the client, so it is only honoured when it
+        is the default library or lies under a directory the operator
+        listed in ISF_SHADER_LIBRARY_ROOTS.
+
+        Raises:
+            ValueError: If no library is configured or the path is not allowed
+        """
+        default = os.environ.get(SHADER_LIBRARY_ENV)
+        if not library_path:
+            if not default:
+                raise ValueError(
+                    f"No shader library configured: set {SHADER_LIBRARY_ENV} "
+                    "to a store created with 'isf-golden update'"
+                )
+            return default
+        requested = Path(library_path).resolve()
+        allowed = [Path(default).resolve()] if default else []
+        roots = [Path(root).resolve() for root in os.environ.get(SHADER_LIBRARY_ROOTS_ENV, "").split(os.pathsep) if root]
+        if requested in allowed or any(requested == root or root in requested.parents for root in roots):
+            return str(requested)
+        raise ValueError(
+            f"Shader library {library_path} is not allowed: use the default library ({SHADER_LIBRARY_ENV}) "
+            f"or a directory under {SHADER_LIBRARY_ROOTS_ENV}"
+        )
+    
+    def _get_library_index(self, library_path: str) -> ShaderLibraryIndex:
+        """Return the cached index for a library, reloading it if the store changed."""
+        index_file = Path(library_path) / "index.json"
+        if not index_file.exists():
+            raise FileNotFoundError(f"No shader library index found at {library_path}")
+        mtime = index_file.stat().st_mtime_ns
+        cached = self._library_indexes.get(library_path)
+        if cached is None or cached[0] != mtime:
+            cached = (mtime, ShaderLibraryIndex.load(Path(library_path)))
+            self._library_indexes[library_path] = cached
+        return cached[1]
+    
+    async def _find_similar_shaders(self, arguments: Dict[str, Any]) -> Dict[str, Any]:
+        """Handle visual similarity search over the shader library."""
+        try:
+            # Parse request
+            request = FindSimilarShadersRequest(**arguments)
+            
+            index = self._get_library_index(self._resolve_library(request.library_path))
+            
+            # Fingerprint the query at the library's canonical times and size
+            if request.shader_content is not None:
+                hashes = fingerprint_shader(
+                    self.renderer,
+                    request.shader_content,
+                    index.time_codes or [0.0],
+                    index.frame_size,
+                )
+            else:
+                hashes = [fingerprint_base64_image(request.image)]
+            
+            started = time.perf_counter()
+            matches = index.search(hashes, limit=request.limit, max_distance=request.max_distance)
+            elapsed_ms = (time.perf_counter() - started) * 1000.0
+            
+            message = f"Found {len(matches)} similar shader(s) among {len(index)} in {elapsed_ms:.1f} ms"
+            return FindSimilarShadersResponse(
+                success=True,
+                message=message,
+                matches=matches,
+                errors=[]
+            ).model_dump()
+            
+        except Exception as e:
+            error_info = _build_error_info(e)
+            # Create AI-friendly error message
+            ai_message = self._format_error_message_for_ai(str(e), error_info)
+            
+            return FindSimilarShadersResponse(
+                success=False,
+                message=ai_message,
+                errors=[str(e)]
+            ).model_dump() | {"error_details": error_info}
+    
     async def list_resources(self) -> List[Resource]:
         """List available resources (shader examples)."""
         resources = [
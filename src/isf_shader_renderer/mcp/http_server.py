@@ -4,14 +4,16 @@ import asyncio
 import logging
 from typing import Optional
 
-from fastapi import FastAPI, HTTPException, Request
+from fastapi import FastAPI, HTTPException, Request, WebSocket
 from fastapi.middleware.cors import CORSMiddleware
-from fastapi.responses import JSONResponse
+from fastapi.responses import JSONResponse, StreamingResponse
 import uvicorn
 
 from .handlers import ISFShaderHandlers
-from .models import RenderRequest, RenderResponse, ValidateRequest, ValidateResponse, GetShaderInfoRequest, GetShaderInfoResponse
+from .models import RenderRequest, RenderResponse, ValidateRequest, ValidateResponse, GetShaderInfoRequest, GetShaderInfoResponse, AnalyzeSequenceRequest, AnalyzeSequenceResponse, DiffShadersRequest, DiffShadersResponse, FindSimilarShadersRequest, FindSimilarShadersResponse
 from .config import MCPServerConfig
+from .preview import PreviewConnection
+from .streaming import JsonText, iter_json
 
 
 class ISFShaderHTTPServer:
@@ -25,7 +27,8 @@ class ISFShaderHTTPServer:
             description="HTTP server for ISF shader rendering via MCP",
             version="1.0.0"
         )
-        self.handlers = ISFShaderHandlers()
+        # Rendered frames are streamed from disk into the response body
+        self.handlers = ISFShaderHandlers(lazy_frames=True)
         self._setup_middleware()
         self._setup_routes()
     
@@ -74,6 +77,10 @@ class ISFShaderHTTPServer:
                     "/render",
                     "/validate", 
                     "/info",
+                    "/analyze",
+                    "/diff",
+                    "/similar",
+                    "/preview",
                     "/health"
                 ]
             }
@@ -155,9 +162,39 @@ class ISFShaderHTTPServer:
                                             "type": "boolean",
                                             "default": False,
                                             "description": "Enable verbose output"
+                                        },
+                                        "include_stats": {
+                                            "type": "boolean",
+                                            "default": False,
+                                            "description": "Return per-frame pixel statistics (blank/flat/NaN detection)"
+                                        },
+                                        "keyframes": {
+                                            "type": "integer",
+                                            "minimum": 1,
+                                            "maximum": 64,
+                                            "description": "Render this many most distinct frames from the time range instead of time_codes"
+                                        },
+                                        "start_time": {
+                                            "type": "number",
+                                            "default": 0.0,
+                                            "description": "Start of the keyframe search range (seconds)"
+                                        },
+                                        "end_time": {
+                                            "type": "number",
+                                            "default": 10.0,
+                                            "description": "End of the keyframe search range (seconds)"
+                                        },
+                                        "probe_samples": {
+                                            "type": "integer",
+                                            "default": 64,
+                                            "description": "Number of low-resolution probe frames used to pick keyframes"
+                                        },
+                                        "inputs": {
+                                            "type": "object",
+                                            "description": "Shader input values by name; image inputs take a base64 data: URL (file paths are refused)"
                                         }
                                     },
-                                    "required": ["shader_content", "time_codes"]
+                                    "required": ["shader_content"]
                                 }
                             },
                             {
@@ -169,6 +206,11 @@ class ISFShaderHTTPServer:
                                         "shader_content": {
                                             "type": "string",
                                             "description": "ISF shader source code to validate"
+                                        },
+                                        "include_stats": {
+                                            "type": "boolean",
+                                            "default": False,
+                                            "description": "Render a small probe frame and report its pixel statistics"
                                         }
                                     },
                                     "required": ["shader_content"]
@@ -187,6 +229,142 @@ class ISFShaderHTTPServer:
                                     },
                                     "required": ["shader_content"]
                                 }
+                            },
+                            {
+                                "name": "analyze_sequence",
+                                "description": "Detect loop period, static segments and peak motion of an animated ISF shader from a low-resolution probe sequence",
+                                "inputSchema": {
+                                    "type": "object",
+                                    "properties": {
+                                        "shader_content": {
+                                            "type": "string",
+                                            "description": "ISF shader source code"
+                                        },
+                                        "start_time": {
+                                            "type": "number",
+                                            "default": 0.0,
+                                            "description": "First probe time (seconds)"
+                                        },
+                                        "end_time": {
+                                            "type": "number",
+                                            "default": 20.0,
+                                            "description": "Last probe time (seconds)"
+                                        },
+                                        "samples": {
+                                            "type": "integer",
+                                            "default": 128,
+                                            "minimum": 4,
+                                            "maximum": 1024,
+                                            "description": "Number of low-resolution probe frames"
+                                        },
+                                        "probe_width": {
+                                            "type": "integer",
+                                            "default": 64,
+                                            "description": "Probe frame width in pixels"
+                                        },
+                                        "probe_height": {
+                                            "type": "integer",
+                                            "default": 36,
+                                            "description": "Probe frame height in pixels"
+                                        },
+                                        "suggestions": {
+                                            "type": "integer",
+                                            "default": 4,
+                                            "description": "Number of informative time codes to suggest"
+                                        }
+                                    },
+                                    "required": ["shader_content"]
+                                }
+                            },
+                            {
+                                "name": "diff_shaders",
+                                "description": "Render two versions of an ISF shader (or one shader with two input sets) and return PSNR/SSIM, changed regions and a diff heatmap",
+                                "inputSchema": {
+                                    "type": "object",
+                                    "properties": {
+                                        "shader_content": {
+                                            "type": "string",
+                                            "description": "ISF shader source code (version A)"
+                                        },
+                                        "shader_content_b": {
+                                            "type": "string",
+                                            "description": "ISF shader source code for version B (defaults to shader_content)"
+                                        },
+                                        "inputs_a": {
+                                            "type": "object",
+                                            "description": "Input values for version A"
+                                        },
+                                        "inputs_b": {
+                                            "type": "object",
+                                            "description": "Input values for version B (defaults to inputs_a)"
+                                        },
+                                        "time_codes": {
+                                            "type": "array",
+                                            "items": {"type": "number"},
+                                            "default": [0.0],
+                                            "description": "Time codes to compare (seconds)"
+                                        },
+                                        "width": {
+                                            "type": "integer",
+                                            "default": 640,
+                                            "description": "Comparison width in pixels"
+                                        },
+                                        "height": {
+                                            "type": "integer",
+                                            "default": 360,
+                                            "description": "Comparison height in pixels"
+                                        },
+                                        "threshold": {
+                                            "type": "integer",
+                                            "default": 8,
+                                            "minimum": 0,
+                                            "maximum": 255,
+                                            "description": "Per-pixel difference (0-255) counted as a change"
+                                        },
+                                        "include_heatmap": {
+                                            "type": "boolean",
+                                            "default": True,
+                                            "description": "Return a base64 PNG diff heatmap per time code"
+                                        }
+                                    },
+                                    "required": ["shader_content"]
+                                }
+                            },
+                            {
+                                "name": "find_similar_shaders",
+                                "description": "Find visually similar shaders in the fingerprinted shader library, given a shader or a rendered image",
+                                "inputSchema": {
+                                    "type": "object",
+                                    "properties": {
+                                        "shader_content": {
+                                            "type": "string",
+                                            "description": "ISF shader to find look-alikes for"
+                                        },
+                                        "image": {
+                                            "type": "string",
+                                            "description": "Base64 encoded image (PNG/JPEG) to find look-alikes for"
+                                        },
+                                        "library_path": {
+                                            "type": "string",
+                                            "description": "Golden store directory indexing the library (defaults to $ISF_SHADER_LIBRARY; others must lie under $ISF_SHADER_LIBRARY_ROOTS)"
+                                        },
+                                        "limit": {
+                                            "type": "integer",
+                                            "default": 10,
+                                            "minimum": 1,
+                                            "maximum": 100,
+                                            "description": "Maximum number of matches"
+                                        },
+                                        "max_distance": {
+                                            "type": "integer",
+                                            "default": 20,
+                                            "minimum": 0,
+                                            "maximum": 64,
+                                            "description": "Maximum perceptual hash distance in bits (0-64)"
+                                        }
+                                    },
+                                    "required": []
+                                }
                             }
                         ]
                         
@@ -213,10 +391,9 @@ class ISFShaderHTTPServer:
                             mcp_content = result["content"]
                         else:
                             # For responses without content (like validation), return as text
-                            import json
                             mcp_content = [{
                                 "type": "text",
-                                "text": json.dumps(result, indent=2)
+                                "text": JsonText(result, indent=2)
                             }]
                         
                         response = {
@@ -227,7 +404,7 @@ class ISFShaderHTTPServer:
                                 "isError": not result.get("success", True)
                             }
                         }
-                        return response
+                        return StreamingResponse(iter_json(response), media_type="application/json")
                     
                     elif method == "resources/list":
                         # Handle resources/list
@@ -306,10 +483,10 @@ class ISFShaderHTTPServer:
         @self.app.post("/render")
         async def render_shader(request: RenderRequest) -> RenderResponse:
             """Render ISF shader endpoint."""
-            logging.info(f"POST /render - Render shader called with {len(request.time_codes)} time codes")
+            logging.info(f"POST /render - Render shader called with {request.frame_count} frames")
             try:
                 # Validate request
-                if len(request.time_codes) > self.config.max_frames_per_request:
+                if request.frame_count > self.config.max_frames_per_request:
                     raise HTTPException(
                         status_code=400,
                         detail=f"Too many time codes. Maximum allowed: {self.config.max_frames_per_request}"
@@ -324,8 +501,9 @@ class ISFShaderHTTPServer:
                 # Call handler
                 result = await self.handlers.call_tool("render_shader", request.model_dump())
                 
-                # Convert to response model
-                return RenderResponse(**result)
+                # Base64File frames pass through validation and are streamed from disk
+                payload = RenderResponse(**result).model_dump()
+                return StreamingResponse(iter_json(payload), media_type="application/json")
                 
             except Exception as e:
                 logging.error(f"Error rendering shader: {e}")
@@ -353,6 +531,59 @@ class ISFShaderHTTPServer:
                 logging.error(f"Error getting shader info: {e}")
                 raise HTTPException(status_code=500, detail=str(e))
         
+        @self.app.post("/analyze")
+        async def analyze_sequence(request: AnalyzeSequenceRequest) -> AnalyzeSequenceResponse:
+            """Temporal analysis endpoint."""
+            logging.info(f"POST /analyze - Analyze sequence called with {request.samples} samples")
+            try:
+                result = await self.handlers.call_tool("analyze_sequence", request.model_dump())
+                return AnalyzeSequenceResponse(**result)
+            except Exception as e:
+                logging.error(f"Error analyzing shader sequence: {e}")
+                raise HTTPException(status_code=500, detail=str(e))
+        
+        @self.app.post("/diff")
+        async def diff_shaders(request: DiffShadersRequest) -> DiffShadersResponse:
+            """Shader comparison endpoint."""
+            logging.info(f"POST /diff - Diff shaders called with {len(request.time_codes)} time codes")
+            try:
+                if len(request.time_codes) > self.config.max_frames_per_request:
+                    raise HTTPException(
+                        status_code=400,
+                        detail=f"Too many time codes. Maximum allowed: {self.config.max_frames_per_request}"
+                    )
+                
+                if request.width > self.config.max_image_size or request.height > self.config.max_image_size:
+                    raise HTTPException(
+                        status_code=400,
+                        detail=f"Image dimensions too large. Maximum allowed: {self.config.max_image_size}x{self.config.max_image_size}"
+                    )
+                
+                result = await self.handlers.call_tool("diff_shaders", request.model_dump())
+                return DiffShadersResponse(**result)
+            except HTTPException:
+                raise
+            except Exception as e:
+                logging.error(f"Error diffing shaders: {e}")
+                raise HTTPException(status_code=500, detail=str(e))
+        
+        @self.app.post("/similar")
+        async def find_similar_shaders(request: FindSimilarShadersRequest) -> FindSimilarShadersResponse:
+            """Visual similarity search endpoint."""
+            logging.info(f"POST /similar - Find similar shaders called with limit {request.limit}")
+            try:
+                result = await self.handlers.call_tool("find_similar_shaders", request.model_dump())
+                return FindSimilarShadersResponse(**result)
+            except Exception as e:
+                logging.error(f"Error searching similar shaders: {e}")
+                raise HTTPException(status_code=500, detail=str(e))
+        
+        @self.app.websocket("/preview")
+        async def preview(websocket: WebSocket):
+            """Live preview stream of JPEG frames (see mcp/preview.py for the protocol)."""
+            logging.info("WS /preview - Preview connection opened")
+            await PreviewConnection(websocket, self.handlers.renderer, self.config.max_image_size).run()
+        
         @self.app.get("/resources")
         async def list_resources():
             """List available resources."""
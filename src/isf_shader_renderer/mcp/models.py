@@ -1,26 +1,54 @@
 """Pydantic models for MCP requests and responses."""
 
-from typing import List, Optional, Dict, Any
-from pydantic import BaseModel, Field
+from typing import List, Optional, Dict, Any, Union
+from pydantic import BaseModel, ConfigDict, Field, model_validator
+
+from .streaming import Base64File
 
 
 class RenderRequest(BaseModel):
     """Request model for rendering ISF shaders."""
     
     shader_content: str = Field(..., description="ISF shader source code")
-    time_codes: List[float] = Field(..., description="Time codes for rendering (seconds)")
+    time_codes: List[float] = Field(default_factory=list, description="Time codes for rendering (seconds)")
     width: int = Field(1920, description="Output width in pixels")
     height: int = Field(1080, description="Output height in pixels")
     quality: int = Field(95, ge=1, le=100, description="JPEG quality (1-100)")
     verbose: bool = Field(False, description="Enable verbose output")
+    include_stats: bool = Field(False, description="Return per-frame pixel statistics (blank/flat/NaN detection)")
+    keyframes: Optional[int] = Field(None, ge=1, le=64, description="Render this many most distinct frames from the time range instead of time_codes")
+    start_time: float = Field(0.0, description="Start of the keyframe search range (seconds)")
+    end_time: float = Field(10.0, description="End of the keyframe search range (seconds)")
+    probe_samples: int = Field(64, ge=4, le=1024, description="Number of low-resolution probe frames used to pick keyframes")
+    inputs: Optional[Dict[str, Any]] = Field(None, description="Shader input values by name; image inputs take a base64 data: URL (file paths are refused)")
+    
+    @model_validator(mode="after")
+    def check_frame_selection(self) -> "RenderRequest":
+        if self.keyframes is None and not self.time_codes:
+            raise ValueError("Either time_codes or keyframes must be provided")
+        if self.keyframes is not None and self.time_codes:
+            raise ValueError("time_codes and keyframes are mutually exclusive")
+        if self.keyframes is not None and self.end_time <= self.start_time:
+            raise ValueError("end_time must be greater than start_time")
+        return self
+    
+    @property
+    def frame_count(self) -> int:
+        """Number of full-resolution frames this request renders at most."""
+        return self.keyframes if self.keyframes is not None else len(self.time_codes)
 
 
 class RenderResponse(BaseModel):
     """Response model for rendering ISF shaders."""
     
+    model_config = ConfigDict(arbitrary_types_allowed=True)
+    
     success: bool = Field(..., description="Whether the rendering was successful")
     message: str = Field(..., description="Human-readable message")
-    rendered_frames: List[str] = Field(default_factory=list, description="Base64 encoded JPEG images")
+    rendered_frames: List[Union[str, Base64File]] = Field(
+        default_factory=list,
+        description="Base64 encoded images, or Base64File references encoded while the response is streamed",
+    )
     metadata: Dict[str, Any] = Field(default_factory=dict, description="Rendering metadata")
     logs: List[str] = Field(default_factory=list, description="All stdout/stderr output")
     shader_info: Optional[Dict[str, Any]] = Field(None, description="Extracted shader information")
@@ -30,6 +58,7 @@ class ValidateRequest(BaseModel):
     """Request model for validating ISF shaders."""
     
     shader_content: str = Field(..., description="ISF shader source code to validate")
+    include_stats: bool = Field(False, description="Render a small probe frame and report its pixel statistics")
 
 
 class ValidateResponse(BaseModel):
@@ -40,6 +69,7 @@ class ValidateResponse(BaseModel):
     shader_info: Optional[Dict[str, Any]] = Field(None, description="Extracted shader information")
     errors: List[str] = Field(default_factory=list, description="Validation errors")
     warnings: List[str] = Field(default_factory=list, description="Validation warnings")
+    stats: Optional[Dict[str, Any]] = Field(None, description="Pixel statistics of the probe frame")
 
 
 class GetShaderInfoRequest(BaseModel):
@@ -57,6 +87,100 @@ class GetShaderInfoResponse(BaseModel):
     errors: List[str] = Field(default_factory=list, description="Any errors encountered") 
 
 
+class AnalyzeSequenceRequest(BaseModel):
+    """Request model for temporal analysis of an animated shader."""
+    
+    shader_content: str = Field(..., description="ISF shader source code")
+    start_time: float = Field(0.0, description="First probe time (seconds)")
+    end_time: float = Field(20.0, description="Last probe time (seconds)")
+    samples: int = Field(128, ge=4, le=1024, description="Number of low-resolution probe frames")
+    probe_width: int = Field(64, ge=16, le=512, description="Probe frame width in pixels")
+    probe_height: int = Field(36, ge=9, le=512, description="Probe frame height in pixels")
+    suggestions: int = Field(4, ge=1, le=32, description="Number of informative time codes to suggest")
+    
+    @model_validator(mode="after")
+    def check_time_range(self) -> "AnalyzeSequenceRequest":
+        if self.end_time <= self.start_time:
+            raise ValueError("end_time must be greater than start_time")
+        return self
+
+
+class AnalyzeSequenceResponse(BaseModel):
+    """Response model for temporal analysis of an animated shader."""
+    
+    success: bool = Field(..., description="Whether the analysis was successful")
+    message: str = Field(..., description="Human-readable summary, e.g. the loop period")
+    analysis: Optional[Dict[str, Any]] = Field(None, description="Frame hashes, motion energy, loop period, static segments and suggested time codes")
+    errors: List[str] = Field(default_factory=list, description="Any errors encountered")
+
+
+class DiffShadersRequest(BaseModel):
+    """Request model for comparing two shader versions or two input sets."""
+    
+    shader_content: str = Field(..., description="ISF shader source code (version A)")
+    shader_content_b: Optional[str] = Field(None, description="ISF shader source code for version B (defaults to shader_content)")
+    inputs_a: Optional[Dict[str, Any]] = Field(None, description="Input values for version A")
+    inputs_b: Optional[Dict[str, Any]] = Field(None, description="Input values for version B (defaults to inputs_a)")
+    time_codes: List[float] = Field(default_factory=lambda: [0.0], min_length=1, description="Time codes to compare (seconds)")
+    width: int = Field(640, ge=1, description="Comparison width in pixels")
+    height: int = Field(360, ge=1, description="Comparison height in pixels")
+    threshold: int = Field(8, ge=0, le=255, description="Per-pixel difference (0-255) counted as a change")
+    include_heatmap: bool = Field(True, description="Return a base64 PNG diff heatmap per time code")
+    
+    @model_validator(mode="after")
+    def check_two_versions(self) -> "DiffShadersRequest":
+        if self.shader_content_b is None and self.inputs_b is None:
+            raise ValueError("Provide shader_content_b or inputs_b to compare against")
+        return self
+
+
+class DiffShadersResponse(BaseModel):
+    """Response model for comparing two shader versions or two input sets."""
+    
+    success: bool = Field(..., description="Whether the comparison was successful")
+    message: str = Field(..., description="Human-readable summary of the differences")
+    comparisons: List[Dict[str, Any]] = Field(default_factory=list, description="Per time code PSNR, SSIM, changed fraction and changed regions")
+    heatmaps: List[str] = Field(default_factory=list, description="Base64 encoded PNG diff heatmaps")
+    errors: List[str] = Field(default_factory=list, description="Any errors encountered")
+
+
+class FindSimilarShadersRequest(BaseModel):
+    """Request model for visual similarity search over the shader library."""
+    
+    shader_content: Optional[str] = Field(None, description="ISF shader to find look-alikes for")
+    image: Optional[str] = Field(None, description="Base64 encoded image (PNG/JPEG) to find look-alikes for")
+    library_path: Optional[str] = Field(None, description="Golden store directory indexing the library (defaults to $ISF_SHADER_LIBRARY; others must lie under $ISF_SHADER_LIBRARY_ROOTS)")
+    limit: int = Field(10, ge=1, le=100, description="Maximum number of matches")
+    max_distance: int = Field(20, ge=0, le=64, description="Maximum perceptual hash distance in bits (0-64)")
+    
+    @model_validator(mode="after")
+    def check_query(self) -> "FindSimilarShadersRequest":
+        if (self.shader_content is None) == (self.image is None):
+            raise ValueError("Provide exactly one of shader_content or image")
+        return self
+
+
+class FindSimilarShadersResponse(BaseModel):
+    """Response model for visual similarity search over the shader library."""
+    
+    success: bool = Field(..., description="Whether the search was successful")
+    message: str = Field(..., description="Human-readable message")
+    matches: List[Dict[str, Any]] = Field(default_factory=list, description="Library shaders ordered by visual distance")
+    errors: List[str] = Field(default_factory=list, description="Any errors encountered")
+
+
+class PreviewSettings(BaseModel):
+    """Settings message of the /preview WebSocket; later messages update only the fields they set."""
+    
+    shader_content: Optional[str] = Field(None, description="ISF shader source code (required in the first message)")
+    width: int = Field(640, ge=16, description="Target preview width in pixels")
+    height: int = Field(360, ge=16, description="Target preview height in pixels")
+    fps: float = Field(30.0, gt=0, le=120, description="Target frames per second")
+    quality: int = Field(75, ge=1, le=100, description="JPEG quality (1-100)")
+    inputs: Dict[str, Any] = Field(default_factory=dict, description="Shader input values; updates are merged into the current values")
+    time: Optional[float] = Field(None, description="Pin TIME to this value (seconds); null follows the wall clock")
+
+
 class Resource(BaseModel):
     uri: str
     name: str
@@ -0,0 +1,264 @@
+"""Live preview of a shader over a WebSocket, with frame dropping and adaptive resolution."""
+
+import asyncio
+import logging
+import time
+from concurrent.futures import ThreadPoolExecutor
+from dataclasses import replace
+from typing import Any, Dict, Optional, Tuple
+
+from fastapi import WebSocket, WebSocketDisconnect
+from pydantic import ValidationError
+
+from ..buffers import encode_image
+from ..config import ShaderConfig
+from ..pixels import output_image
+from ..renderer import RenderSession, ShaderRenderer, _error_message
+from .models import PreviewSettings
+
+logger = logging.getLogger(__name__)
+
+# Resolution scale bounds relative to the requested size
+MIN_PREVIEW_SCALE = 0.25
+MAX_PREVIEW_SCALE = 1.0
+
+# Seconds between stats messages
+STATS_INTERVAL = 1.0
+
+
+class AdaptiveResolution:
+    """
+    Scale the preview resolution to the time a frame takes.
+
+    Render plus encode time is smoothed with an exponential moving average.
+    When it exceeds 85% of the frame period the scale drops by 20%; when
+    it stays under 40% (with room to grow) for a second's worth of frames,
+    the scale grows back by 25%. Pixel cost is quadratic in the scale, so
+    these steps settle quickly without oscillating.
+    """
+
+    def __init__(self, smoothing: float = 0.3):
+        self.scale = MAX_PREVIEW_SCALE
+        self.smoothing = smoothing
+        self.frame_seconds: Optional[float] = None
+        self._fast_frames = 0
+
+    def update(self, frame_seconds: float, period: float) -> float:
+        """Record one frame's render+encode time and return the new scale."""
+        if self.frame_seconds is None:
+            self.frame_seconds = frame_seconds
+        else:
+            self.frame_seconds += self.smoothing * (frame_seconds - self.frame_seconds)
+
+        if self.frame_seconds > 0.85 * period and self.scale > MIN_PREVIEW_SCALE:
+            self.scale = max(self.scale * 0.8, MIN_PREVIEW_SCALE)
+            # The average was measured at the old size; restart it at the new one
+            self.frame_seconds = None
+            self._fast_frames = 0
+        elif self.frame_seconds < 0.4 * period and self.scale < MAX_PREVIEW_SCALE:
+            self._fast_frames += 1
+            if self._fast_frames >= max(int(1.0 / period), 1):
+                self.scale = min(self.scale * 1.25, MAX_PREVIEW_SCALE)
+                self.frame_seconds = None
+                self._fast_frames = 0
+        else:
+            self._fast_frames = 0
+        return self.scale
+
+    def size(self, width: int, height: int) -> Tuple[int, int]:
+        """Scaled render size, kept even and at least 16 pixels."""
+        return (
+            max(int(width * self.scale) // 2 * 2, 16),
+            max(int(height * self.scale) // 2 * 2, 16),
+        )
+
+
+class PreviewConnection:
+    """
+    One /preview client.
+
+    The first message must carry shader_content; later messages update any
+    settings. Three tasks run concurrently: the receiver merges settings
+    (latest wins), the render loop produces JPEGs on a frame clock, and the
+    sender transmits only the newest frame, so a slow client never builds
+    a backlog; frames replaced before they were sent are counted as
+    dropped. The shader is compiled once per connection (and again only
+    when the client sends new source), on a dedicated thread that also owns
+    every render call for that session.
+    """
+
+    def __init__(self, websocket: WebSocket, renderer: ShaderRenderer, max_image_size: int = 4096):
+        self.websocket = websocket
+        self.renderer = renderer
+        self.max_image_size = max_image_size
+        self.settings = PreviewSettings()
+        self.scaler = AdaptiveResolution()
+        self._executor = ThreadPoolExecutor(max_workers=1, thread_name_prefix="preview-render")
+        self._session: Optional[RenderSession] = None
+        self._compiled_source: Optional[str] = None
+        self._frame: Optional[Tuple[bytes, Dict[str, Any]]] = None
+        self._frame_ready = asyncio.Event()
+        self._changed = asyncio.Event()
+        self._start = time.perf_counter()
+        self.sent = 0
+        self.dropped = 0
+        self.render_ms = 0.0
+        self.encode_ms = 0.0
+
+    def _apply(self, message: Dict[str, Any]) -> None:
+        """Merge a settings message into the current settings."""
+        update = PreviewSettings(**message)
+        fields = update.model_fields_set
+        merged = self.settings.model_dump()
+        merged.update({name: getattr(update, name) for name in fields if name != "inputs"})
+        if "inputs" in fields:
+            merged["inputs"] = {**self.settings.inputs, **update.inputs}
+        settings = PreviewSettings(**merged)
+        if settings.width > self.max_image_size or settings.height > self.max_image_size:
+            raise ValueError(f"Preview size too large. Maximum allowed: {self.max_image_size}x{self.max_image_size}")
+        self.settings = settings
+        self._changed.set()
+
+    async def _send_json(self, payload: Dict[str, Any]) -> None:
+        await self.websocket.send_json(payload)
+
+    async def run(self) -> None:
+        """Serve the connection until the client disconnects."""
+        await self.websocket.accept()
+        try:
+            try:
+                self._apply(await self.websocket.receive_json())
+                if not self.settings.shader_content:
+                    raise ValueError("The first message must include shader_content")
+            except (ValidationError, ValueError, TypeError) as e:
+                await self._send_json({"type": "error", "message": str(e)})
+                await self.websocket.close(code=1003)
+                return
+
+            tasks = [
+                asyncio.create_task(self._receive_loop()),
+                asyncio.create_task(self._render_loop()),
+                asyncio.create_task(self._send_loop()),
+            ]
+            try:
+                done, _ = await asyncio.wait(tasks, return_when=asyncio.FIRST_EXCEPTION)
+                for task in done:
+                    error = task.exception()
+                    if error is not None and not isinstance(error, WebSocketDisconnect):
+                        raise error
+            finally:
+                for task in tasks:
+                    task.cancel()
+                await asyncio.gather(*tasks, return_exceptions=True)
+        except WebSocketDisconnect:
+            pass
+        finally:
+            await asyncio.get_running_loop().run_in_executor(self._executor, self._close_session)
+            self._executor.shutdown(wait=False)
+            logger.info(f"Preview closed after {self.sent} frames ({self.dropped} dropped)")
+
+    async def _receive_loop(self) -> None:
+        while True:
+            message = await self.websocket.receive_json()
+            try:
+                self._apply(message)
+            except (ValidationError, ValueError, TypeError) as e:
+                await self._send_json({"type": "error", "message": str(e)})
+
+    async def _render_loop(self) -> None:
+        loop = asyncio.get_running_loop()
+        next_tick = loop.time()
+        while True:
+            settings = self.settings
+            self._changed.clear()
+            period = 1.0 / settings.fps
+            width, height = self.scaler.size(settings.width, settings.height)
+            time_code = settings.time if settings.time is not None else time.perf_counter() - self._start
+            try:
+                jpeg, render_seconds, encode_seconds = await loop.run_in_executor(
+                    self._executor, self._render_jpeg, settings, time_code, width, height
+                )
+            except RuntimeError as e:
+                await self._send_json({"type": "error", "message": _error_message(e)})
+                # Nothing to show until the client sends a fix
+                await self._changed.wait()
+                next_tick = loop.time()
+                continue
+
+            self.render_ms = render_seconds * 1000
+            self.encode_ms = encode_seconds * 1000
+            self.scaler.update(render_seconds + encode_seconds, period)
+            if self._frame is not None:
+                self.dropped += 1
+            self._frame = (jpeg, {"time": time_code, "width": width, "height": height})
+            self._frame_ready.set()
+
+            if settings.time is not None and not self._changed.is_set():
+                # A pinned TIME renders the same frame until something changes
+                await self._changed.wait()
+                next_tick = loop.time()
+                continue
+            next_tick += period
+            delay = next_tick - loop.time()
+            if delay > 0:
+                await asyncio.sleep(delay)
+            else:
+                # Behind schedule: start from now rather than rendering a burst to catch up
+                next_tick = loop.time()
+
+    async def _send_loop(self) -> None:
+        last_stats = time.perf_counter()
+        sent_at_last_stats = 0
+        while True:
+            await self._frame_ready.wait()
+            self._frame_ready.clear()
+            frame, self._frame = self._frame, None
+            if frame is None:
+                continue
+            await self.websocket.send_bytes(frame[0])
+            self.sent += 1
+
+            now = time.perf_counter()
+            if now - last_stats >= STATS_INTERVAL:
+                width, height = frame[1]["width"], frame[1]["height"]
+                await self._send_json({
+                    "type": "stats",
+                    "fps": round((self.sent - sent_at_last_stats) / (now - last_stats), 1),
+                    "target_fps": self.settings.fps,
+                    "scale": round(self.scaler.scale, 3),
+                    "width": width,
+                    "height": height,
+                    "time": round(frame[1]["time"], 3),
+                    "render_ms": round(self.render_ms, 2),
+                    "encode_ms": round(self.encode_ms, 2),
+                    "sent": self.sent,
+                    "dropped": self.dropped,
+                })
+                sent_at_last_stats = self.sent
+                last_stats = now
+
+    def _render_jpeg(
+        self, settings: PreviewSettings, time_code: float, width: int, height: int
+    ) -> Tuple[bytes, float, float]:
+        """Render and encode one frame on the session thread."""
+        if self._session is None or settings.shader_content != self._compiled_source:
+            self._close_session()
+            self._compiled_source = settings.shader_content
+            self._session = self.renderer.session(
+                settings.shader_content,
+                ShaderConfig(input="<preview>", output="", times=[0.0], width=width, height=height),
+            )
+        self._session.shader_config = replace(self._session.shader_config, inputs=settings.inputs or None)
+
+        started = time.perf_counter()
+        image = self._session.render_image(time_code, width, height)
+        rendered = time.perf_counter()
+        with output_image(image, "JPEG") as rgb:
+            jpeg = encode_image(rgb, "JPEG", quality=settings.quality)
+        return jpeg, rendered - started, time.perf_counter() - rendered
+
+    def _close_session(self) -> None:
+        if self._session is not None:
+            self._session.close()
+            self._session = None
+            self._compiled_source = None
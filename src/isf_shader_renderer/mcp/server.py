@@ -3,13 +3,14 @@
 import asyncio
 import logging
 import sys
-from typing import List
+from typing import List, Optional
 
 from mcp.server import Server
 from mcp.server.stdio import stdio_server
 from mcp.server.models import InitializationOptions
 from mcp import Tool, Resource as MCPResource
 from .handlers import ISFShaderHandlers
+from .streaming import json_text
 from mcp.server.fastmcp import Image as FastMCPImage
 
 
@@ -58,30 +59,43 @@ def run_http_server(logger, host: str, port: int):
     @server.tool()
     async def render_shader(
         shader_content: str,
-        time_codes: list[float],
+        time_codes: Optional[list[float]] = None,
         width: int = 1920,
         height: int = 1080,
         quality: int = 95,
-        verbose: bool = False
+        verbose: bool = False,
+        include_stats: bool = False,
+        keyframes: Optional[int] = None,
+        start_time: float = 0.0,
+        end_time: float = 10.0,
+        probe_samples: int = 64,
+        inputs: Optional[dict] = None
     ) -> dict:
-        """Render an ISF shader to PNG images at specified time codes."""
-        logger.info(f"render_shader called with {len(time_codes)} time codes")
+        """Render an ISF shader to PNG images at specified time codes, or at the most distinct keyframes of a time range."""
+        logger.info(f"render_shader called with {len(time_codes or [])} time codes, keyframes={keyframes}")
         result = await handlers.call_tool("render_shader", {
             "shader_content": shader_content,
-            "time_codes": time_codes,
+            "time_codes": time_codes or [],
             "width": width,
             "height": height,
             "quality": quality,
-            "verbose": verbose
+            "verbose": verbose,
+            "include_stats": include_stats,
+            "keyframes": keyframes,
+            "start_time": start_time,
+            "end_time": end_time,
+            "probe_samples": probe_samples,
+            "inputs": inputs
         })
         return result
     
     @server.tool()
-    async def validate_shader(shader_content: str) -> dict:
+    async def validate_shader(shader_content: str, include_stats: bool = False) -> dict:
         """Validate ISF shader syntax and extract metadata."""
         logger.info("validate_shader called")
         result = await handlers.call_tool("validate_shader", {
-            "shader_content": shader_content
+            "shader_content": shader_content,
+            "include_stats": include_stats
         })
         return result
     
@@ -94,6 +108,75 @@ def run_http_server(logger, host: str, port: int):
         })
         return result
     
+    @server.tool()
+    async def analyze_sequence(
+        shader_content: str,
+        start_time: float = 0.0,
+        end_time: float = 20.0,
+        samples: int = 128,
+        probe_width: int = 64,
+        probe_height: int = 36,
+        suggestions: int = 4
+    ) -> dict:
+        """Detect loop period, static segments and peak motion of an animated ISF shader from a low-resolution probe sequence."""
+        logger.info(f"analyze_sequence called with {samples} samples")
+        result = await handlers.call_tool("analyze_sequence", {
+            "shader_content": shader_content,
+            "start_time": start_time,
+            "end_time": end_time,
+            "samples": samples,
+            "probe_width": probe_width,
+            "probe_height": probe_height,
+            "suggestions": suggestions
+        })
+        return result
+    
+    @server.tool()
+    async def diff_shaders(
+        shader_content: str,
+        shader_content_b: Optional[str] = None,
+        inputs_a: Optional[dict] = None,
+        inputs_b: Optional[dict] = None,
+        time_codes: Optional[list[float]] = None,
+        width: int = 640,
+        height: int = 360,
+        threshold: int = 8,
+        include_heatmap: bool = True
+    ) -> dict:
+        """Render two versions of an ISF shader (or one shader with two input sets) and return PSNR/SSIM, changed regions and a diff heatmap."""
+        logger.info("diff_shaders called")
+        result = await handlers.call_tool("diff_shaders", {
+            "shader_content": shader_content,
+            "shader_content_b": shader_content_b,
+            "inputs_a": inputs_a,
+            "inputs_b": inputs_b,
+            "time_codes": time_codes or [0.0],
+            "width": width,
+            "height": height,
+            "threshold": threshold,
+            "include_heatmap": include_heatmap
+        })
+        return result
+    
+    @server.tool()
+    async def find_similar_shaders(
+        shader_content: Optional[str] = None,
+        image: Optional[str] = None,
+        library_path: Optional[str] = None,
+        limit: int = 10,
+        max_distance: int = 20
+    ) -> dict:
+        """Find visually similar shaders in the fingerprinted shader library, given a shader or a rendered image."""
+        logger.info("find_similar_shaders called")
+        result = await handlers.call_tool("find_similar_shaders", {
+            "shader_content": shader_content,
+            "image": image,
+            "library_path": library_path,
+            "limit": limit,
+            "max_distance": max_distance
+        })
+        return result
+    
     # Register resources
     @server.resource("isf://examples/simple.fs")
     async def simple_shader() -> str:
@@ -145,7 +228,8 @@ def run_stdio_server(logger):
     
     # Create standard MCP server
     server = Server("isf-shader-renderer")
-    handlers = ISFShaderHandlers()
+    # Frames are only base64-encoded if a text response actually includes them
+    handlers = ISFShaderHandlers(lazy_frames=True)
     
     # Define tools
     render_shader_tool = Tool(
@@ -184,9 +268,39 @@ def run_stdio_server(logger):
                     "type": "boolean",
                     "default": False,
                     "description": "Enable verbose output"
+                },
+                "include_stats": {
+                    "type": "boolean",
+                    "default": False,
+                    "description": "Return per-frame pixel statistics (blank/flat/NaN detection)"
+                },
+                "keyframes": {
+                    "type": "integer",
+                    "minimum": 1,
+                    "maximum": 64,
+                    "description": "Render this many most distinct frames from the time range instead of time_codes"
+                },
+                "start_time": {
+                    "type": "number",
+                    "default": 0.0,
+                    "description": "Start of the keyframe search range (seconds)"
+                },
+                "end_time": {
+                    "type": "number",
+                    "default": 10.0,
+                    "description": "End of the keyframe search range (seconds)"
+                },
+                "probe_samples": {
+                    "type": "integer",
+                    "default": 64,
+                    "description": "Number of low-resolution probe frames used to pick keyframes"
+                },
+                "inputs": {
+                    "type": "object",
+                    "description": "Shader input values by name; image inputs take a base64 data: URL (file paths are refused)"
                 }
             },
-            "required": ["shader_content", "time_codes"]
+            "required": ["shader_content"]
         }
     )
     
@@ -199,6 +313,11 @@ def run_stdio_server(logger):
                 "shader_content": {
                     "type": "string",
                     "description": "ISF shader source code to validate"
+                },
+                "include_stats": {
+                    "type": "boolean",
+                    "default": False,
+                    "description": "Render a small probe frame and report its pixel statistics"
                 }
             },
             "required": ["shader_content"]
@@ -220,11 +339,150 @@ def run_stdio_server(logger):
         }
     )
     
+    analyze_sequence_tool = Tool(
+        name="analyze_sequence",
+        description="Detect loop period, static segments and peak motion of an animated ISF shader from a low-resolution probe sequence",
+        inputSchema={
+            "type": "object",
+            "properties": {
+                "shader_content": {
+                    "type": "string",
+                    "description": "ISF shader source code"
+                },
+                "start_time": {
+                    "type": "number",
+                    "default": 0.0,
+                    "description": "First probe time (seconds)"
+                },
+                "end_time": {
+                    "type": "number",
+                    "default": 20.0,
+                    "description": "Last probe time (seconds)"
+                },
+                "samples": {
+                    "type": "integer",
+                    "default": 128,
+                    "minimum": 4,
+                    "maximum": 1024,
+                    "description": "Number of low-resolution probe frames"
+                },
+                "probe_width": {
+                    "type": "integer",
+                    "default": 64,
+                    "description": "Probe frame width in pixels"
+                },
+                "probe_height": {
+                    "type": "integer",
+                    "default": 36,
+                    "description": "Probe frame height in pixels"
+                },
+                "suggestions": {
+                    "type": "integer",
+                    "default": 4,
+                    "description": "Number of informative time codes to suggest"
+                }
+            },
+            "required": ["shader_content"]
+        }
+    )
+    
+    diff_shaders_tool = Tool(
+        name="diff_shaders",
+        description="Render two versions of an ISF shader (or one shader with two input sets) and return PSNR/SSIM, changed regions and a diff heatmap",
+        inputSchema={
+            "type": "object",
+            "properties": {
+                "shader_content": {
+                    "type": "string",
+                    "description": "ISF shader source code (version A)"
+                },
+                "shader_content_b": {
+                    "type": "string",
+                    "description": "ISF shader source code for version B (defaults to shader_content)"
+                },
+                "inputs_a": {
+                    "type": "object",
+                    "description": "Input values for version A"
+                },
+                "inputs_b": {
+                    "type": "object",
+                    "description": "Input values for version B (defaults to inputs_a)"
+                },
+                "time_codes": {
+                    "type": "array",
+                    "items": {"type": "number"},
+                    "default": [0.0],
+                    "description": "Time codes to compare (seconds)"
+                },
+                "width": {
+                    "type": "integer",
+                    "default": 640,
+                    "description": "Comparison width in pixels"
+                },
+                "height": {
+                    "type": "integer",
+                    "default": 360,
+                    "description": "Comparison height in pixels"
+                },
+                "threshold": {
+                    "type": "integer",
+                    "default": 8,
+                    "minimum": 0,
+                    "maximum": 255,
+                    "description": "Per-pixel difference (0-255) counted as a change"
+                },
+                "include_heatmap": {
+                    "type": "boolean",
+                    "default": True,
+                    "description": "Return a base64 PNG diff heatmap per time code"
+                }
+            },
+            "required": ["shader_content"]
+        }
+    )
+    
+    find_similar_shaders_tool = Tool(
+        name="find_similar_shaders",
+        description="Find visually similar shaders in the fingerprinted shader library, given a shader or a rendered image",
+        inputSchema={
+            "type": "object",
+            "properties": {
+                "shader_content": {
+                    "type": "string",
+                    "description": "ISF shader to find look-alikes for"
+                },
+                "image": {
+                    "type": "string",
+                    "description": "Base64 encoded image (PNG/JPEG) to find look-alikes for"
+                },
+                "library_path": {
+                    "type": "string",
+                    "description": "Golden store directory indexing the library (defaults to $ISF_SHADER_LIBRARY; others must lie under $ISF_SHADER_LIBRARY_ROOTS)"
+                },
+                "limit": {
+                    "type": "integer",
+                    "default": 10,
+                    "minimum": 1,
+                    "maximum": 100,
+                    "description": "Maximum number of matches"
+                },
+                "max_distance": {
+                    "type": "integer",
+                    "default": 20,
+                    "minimum": 0,
+                    "maximum": 64,
+                    "description": "Maximum perceptual hash distance in bits (0-64)"
+                }
+            },
+            "required": []
+        }
+    )
+    
     # Register handlers
     @server.list_tools()
     async def list_tools() -> List[Tool]:
         logger.info("list_tools called")
-        return [render_shader_tool, validate_shader_tool, get_shader_info_tool]
+        return [render_shader_tool, validate_shader_tool, get_shader_info_tool, analyze_sequence_tool, diff_shaders_tool, find_similar_shaders_tool]
 
     @server.list_resources()
     async def list_resources() -> List[MCPResource]:
@@ -256,11 +514,10 @@ def run_stdio_server(logger):
                 "isError": not result.get("success", True)
             }
         # For other tools or if no images, return as text
-        import json
         return {
             "content": [{
                 "type": "text",
-                "text": json.dumps(result, indent=2)
+                "text": json_text(result, indent=2)
             }],
             "isError": not result.get("success", True)
         }
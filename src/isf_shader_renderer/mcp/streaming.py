@@ -0,0 +1,166 @@
+"""Streaming JSON serialization of tool results with file-backed base64 frames."""
+
+import base64
+import json
+from pathlib import Path
+from typing import Any, Iterator, Optional, Union
+
+# File bytes encoded per base64 chunk; a multiple of 3, so chunks join without padding
+BASE64_CHUNK_BYTES = 3 * 16 * 1024
+
+# Small JSON tokens are coalesced into writes of about this many bytes
+WRITE_CHUNK_BYTES = 64 * 1024
+
+
+class Base64File:
+    """
+    An encoded image file standing in for its base64 string in a tool result.
+
+    iter_json streams the file into the response chunk by chunk, so a frame
+    is never held as a base64 Python string (nor as a string inside the
+    serialized response): memory per frame is one chunk instead of the
+    encoded file plus its copies.
+    """
+
+    __slots__ = ("path",)
+
+    def __init__(self, path: Union[str, Path]):
+        self.path = Path(path)
+
+    def __len__(self) -> int:
+        """Length of the base64 encoding."""
+        return 4 * ((self.path.stat().st_size + 2) // 3)
+
+    def __repr__(self) -> str:
+        return f"Base64File({str(self.path)!r})"
+
+    def chunks(self, chunk_bytes: int = BASE64_CHUNK_BYTES) -> Iterator[bytes]:
+        """Yield the base64 encoding of the file in ASCII chunks."""
+        buffer = bytearray(chunk_bytes)
+        view = memoryview(buffer)
+        with open(self.path, "rb") as f:
+            while True:
+                filled = 0
+                # Fill whole chunks, so only the last one carries padding
+                while filled < chunk_bytes:
+                    read = f.readinto(view[filled:])
+                    if not read:
+                        break
+                    filled += read
+                if not filled:
+                    return
+                yield base64.b64encode(view[:filled])
+                if filled < chunk_bytes:
+                    return
+
+    def text(self) -> str:
+        """The whole base64 string, for callers that need one."""
+        return b"".join(self.chunks()).decode("ascii")
+
+
+class JsonText:
+    """A value embedded as a string holding its JSON (MCP text content), streamed like any other."""
+
+    __slots__ = ("value", "indent")
+
+    def __init__(self, value: Any, indent: Optional[int] = None):
+        self.value = value
+        self.indent = indent
+
+
+def _key(key: Any) -> str:
+    """Encode a dict key the way json.dumps does."""
+    if isinstance(key, str):
+        return json.dumps(key)
+    if key is True:
+        return '"true"'
+    if key is False:
+        return '"false"'
+    if key is None:
+        return '"null"'
+    return json.dumps(json.dumps(key))
+
+
+def _pieces(value: Any, indent: Optional[int], level: int) -> Iterator[Union[str, bytes]]:
+    """Yield JSON text as str tokens and pre-encoded ASCII bytes chunks."""
+    if isinstance(value, Base64File):
+        yield '"'
+        yield from value.chunks()
+        yield '"'
+    elif isinstance(value, JsonText):
+        yield '"'
+        for piece in _pieces(value.value, value.indent, 0):
+            # base64 chunks need no escaping; text tokens are escaped as string content
+            yield piece if isinstance(piece, bytes) else json.dumps(piece)[1:-1]
+        yield '"'
+    elif isinstance(value, dict):
+        if not value:
+            yield "{}"
+            return
+        inner, close, separator = _layout(indent, level)
+        yield "{" + inner
+        for i, (key, item) in enumerate(value.items()):
+            if i:
+                yield separator
+            yield _key(key) + (": " if indent is not None else ":")
+            yield from _pieces(item, indent, level + 1)
+        yield close + "}"
+    elif isinstance(value, (list, tuple)):
+        if not value:
+            yield "[]"
+            return
+        inner, close, separator = _layout(indent, level)
+        yield "[" + inner
+        for i, item in enumerate(value):
+            if i:
+                yield separator
+            yield from _pieces(item, indent, level + 1)
+        yield close + "]"
+    else:
+        yield json.dumps(value)
+
+
+def _layout(indent: Optional[int], level: int):
+    """(after opening bracket, before closing bracket, between items) for a nesting level."""
+    if indent is None:
+        return "", "", ","
+    inner = "\n" + " " * (indent * (level + 1))
+    return inner, "\n" + " " * (indent * level), "," + inner
+
+
+def iter_json(value: Any, indent: Optional[int] = None) -> Iterator[bytes]:
+    """
+    Serialize a value to UTF-8 JSON incrementally.
+
+    Base64File values are streamed from disk and JsonText values are
+    embedded as JSON strings, both without building the full text. Small
+    tokens are coalesced into writes of about WRITE_CHUNK_BYTES.
+
+    Args:
+        value: JSON-compatible value, possibly containing Base64File/JsonText
+        indent: Indentation as in json.dumps (None for compact output)
+
+    Yields:
+        Chunks of the document
+    """
+    pending = []
+    size = 0
+    for piece in _pieces(value, indent, 0):
+        if isinstance(piece, bytes):
+            if pending:
+                yield "".join(pending).encode()
+                pending, size = [], 0
+            yield piece
+            continue
+        pending.append(piece)
+        size += len(piece)
+        if size >= WRITE_CHUNK_BYTES:
+            yield "".join(pending).encode()
+            pending, size = [], 0
+    if pending:
+        yield "".join(pending).encode()
+
+
+def json_text(value: Any, indent: Optional[int] = None) -> str:
+    """Serialize a value that may contain Base64File/JsonText to a JSON string."""
+    return b"".join(iter_json(value, indent)).decode()
@@ -124,8 +124,16 @@ def create_temp_file(suffix: str = ".jpg", directory: Optional[Path] = None) ->
 def encode_image_to_base64(image_path: Path) -> str:
     """Encode image file to base64 string."""
     with open(image_path, "rb") as f:
-        image_data = f.read()
-        return base64.b64encode(image_data).decode()
+        # The file bytes are released before the str copy is made
+        encoded = base64.b64encode(f.read())
+    return encoded.decode("ascii")
+
+
+def encode_array_to_base64_png(pixels: "np.ndarray") -> str:
+    """Encode an in-memory pixel array as a base64 PNG string."""
+    from PIL import Image
+    from ..buffers import encode_image
+    return base64.b64encode(encode_image(Image.fromarray(pixels), "PNG")).decode()
 
 
 def decode_base64_to_image(base64_data: str, output_path: Path) -> None:
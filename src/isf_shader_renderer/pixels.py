@@ -0,0 +1,203 @@
+"""Pixel conversion kernels for rendered frames, vectorized and in place where possible."""
+
+from contextlib import contextmanager
+from pathlib import Path
+from typing import Iterator, Optional, Union
+
+import numpy as np
+from PIL import Image
+
+from .buffers import frame_pool, image_into
+
+# Rows processed per block, bounding the temporaries of the table-driven kernels
+BLOCK_ROWS = 64
+
+# Output formats that cannot store an alpha channel (Pillow format names)
+FORMATS_WITHOUT_ALPHA = ("JPEG", "PPM")
+
+
+def _premultiply_table() -> np.ndarray:
+    """table[a, c] = round(c * a / 255)."""
+    a = np.arange(256, dtype=np.uint32)[:, None]
+    c = np.arange(256, dtype=np.uint32)[None, :]
+    return ((c * a + 127) // 255).astype(np.uint8)
+
+
+def _unpremultiply_table() -> np.ndarray:
+    """table[a, c] = min(round(c * 255 / a), 255), and 0 where a is 0."""
+    a = np.arange(256, dtype=np.uint32)[:, None]
+    c = np.arange(256, dtype=np.uint32)[None, :]
+    table = np.minimum((c * 255 + a // 2) // np.maximum(a, 1), 255)
+    table[0] = 0
+    return table.astype(np.uint8)
+
+
+def _srgb_to_linear_table() -> np.ndarray:
+    """8-bit sRGB code to 16-bit linear light."""
+    s = np.arange(256, dtype=np.float64) / 255.0
+    linear = np.where(s <= 0.04045, s / 12.92, ((s + 0.055) / 1.055) ** 2.4)
+    return np.round(linear * 65535.0).astype(np.uint16)
+
+
+def _linear_to_srgb_table() -> np.ndarray:
+    """16-bit linear light to 8-bit sRGB code."""
+    linear = np.arange(65536, dtype=np.float64) / 65535.0
+    s = np.where(linear <= 0.0031308, linear * 12.92, 1.055 * linear ** (1.0 / 2.4) - 0.055)
+    return np.round(s * 255.0).astype(np.uint8)
+
+
+# 64 KB each; an exact table lookup replaces the per-pixel multiply, divide or pow
+_PREMULTIPLY = _premultiply_table()
+_UNPREMULTIPLY = _unpremultiply_table()
+_SRGB_TO_LINEAR = _srgb_to_linear_table()
+_LINEAR_TO_SRGB = _linear_to_srgb_table()
+
+
+def _check_rgba(pixels: np.ndarray, dtype=np.uint8) -> None:
+    if pixels.ndim != 3 or pixels.shape[2] != 4 or pixels.dtype != dtype:
+        raise ValueError(f"Expected a (height, width, 4) {np.dtype(dtype).name} array, got {pixels.shape} {pixels.dtype}")
+
+
+def flip_vertical(pixels: np.ndarray) -> np.ndarray:
+    """
+    Reverse the row order in place (GL bottom-up readback to top-down).
+
+    Rows are swapped block by block through a small scratch buffer, so the
+    frame is never copied whole.
+
+    Returns:
+        The same array
+    """
+    height = pixels.shape[0]
+    scratch = np.empty((min(BLOCK_ROWS, height // 2),) + pixels.shape[1:], dtype=pixels.dtype)
+    for top in range(0, height // 2, BLOCK_ROWS):
+        rows = min(BLOCK_ROWS, height // 2 - top)
+        bottom = height - top - rows
+        block = scratch[:rows]
+        block[...] = pixels[top:top + rows]
+        pixels[top:top + rows] = pixels[bottom:bottom + rows][::-1]
+        pixels[bottom:bottom + rows] = block[::-1]
+    return pixels
+
+
+def drop_alpha(pixels: np.ndarray, out: Optional[np.ndarray] = None) -> np.ndarray:
+    """
+    Copy the RGB channels of an RGBA frame.
+
+    Args:
+        pixels: (height, width, 4) frame
+        out: Optional (height, width, 3) buffer of the same dtype
+
+    Returns:
+        The RGB frame
+    """
+    if out is None:
+        out = np.empty(pixels.shape[:2] + (3,), dtype=pixels.dtype)
+    np.copyto(out, pixels[..., :3])
+    return out
+
+
+def _apply_by_alpha(pixels: np.ndarray, table: np.ndarray) -> np.ndarray:
+    """Replace each color channel c by table[alpha, c], block by block."""
+    _check_rgba(pixels)
+    for top in range(0, pixels.shape[0], BLOCK_ROWS):
+        block = pixels[top:top + BLOCK_ROWS]
+        block[..., :3] = table[block[..., 3:4], block[..., :3]]
+    return pixels
+
+
+def premultiply(pixels: np.ndarray) -> np.ndarray:
+    """Convert an 8-bit RGBA frame from straight to premultiplied alpha, in place."""
+    return _apply_by_alpha(pixels, _PREMULTIPLY)
+
+
+def unpremultiply(pixels: np.ndarray) -> np.ndarray:
+    """Convert an 8-bit RGBA frame from premultiplied to straight alpha, in place (alpha 0 gives black)."""
+    return _apply_by_alpha(pixels, _UNPREMULTIPLY)
+
+
+def srgb_to_linear(pixels: np.ndarray, out: Optional[np.ndarray] = None) -> np.ndarray:
+    """
+    Decode 8-bit sRGB color channels to 16-bit linear light; alpha is widened unchanged.
+
+    Returns:
+        uint16 frame of the same shape (out, if given)
+    """
+    _check_rgba(pixels)
+    if out is None:
+        out = np.empty(pixels.shape, dtype=np.uint16)
+    np.take(_SRGB_TO_LINEAR, pixels[..., :3], out=out[..., :3])
+    np.multiply(pixels[..., 3], 257, out=out[..., 3], dtype=np.uint16)
+    return out
+
+
+def linear_to_srgb(pixels: np.ndarray, out: Optional[np.ndarray] = None) -> np.ndarray:
+    """
+    Encode 16-bit linear color channels to 8-bit sRGB; alpha is narrowed with rounding.
+
+    Returns:
+        uint8 frame of the same shape (out, if given)
+    """
+    _check_rgba(pixels, np.uint16)
+    if out is None:
+        out = np.empty(pixels.shape, dtype=np.uint8)
+    np.take(_LINEAR_TO_SRGB, pixels[..., :3], out=out[..., :3])
+    out[..., 3] = to_8bit(pixels[..., 3])
+    return out
+
+
+def to_8bit(values: np.ndarray, out: Optional[np.ndarray] = None) -> np.ndarray:
+    """
+    Quantize uint16 or float ([0, 1]) values to uint8 with round-to-nearest.
+
+    Returns:
+        uint8 array of the same shape (out, if given)
+    """
+    if out is None:
+        out = np.empty(values.shape, dtype=np.uint8)
+    if values.dtype == np.uint16:
+        # Exact integer round-half-up of v * 255 / 65535
+        np.copyto(out, (values.astype(np.uint32) * 255 + 32767) // 65535, casting="unsafe")
+    else:
+        np.copyto(out, np.clip(values, 0.0, 1.0) * 255.0 + 0.5, casting="unsafe")
+    return out
+
+
+def to_16bit(values: np.ndarray, out: Optional[np.ndarray] = None) -> np.ndarray:
+    """
+    Quantize uint8 or float ([0, 1]) values to uint16 (8-bit codes map exactly: v * 257).
+
+    Returns:
+        uint16 array of the same shape (out, if given)
+    """
+    if out is None:
+        out = np.empty(values.shape, dtype=np.uint16)
+    if values.dtype == np.uint8:
+        np.multiply(values, 257, out=out, dtype=np.uint16)
+    else:
+        np.copyto(out, np.clip(values, 0.0, 1.0) * 65535.0 + 0.5, casting="unsafe")
+    return out
+
+
+def image_format(path: Union[str, Path]) -> Optional[str]:
+    """Pillow format name for a file name, from its extension."""
+    return Image.registered_extensions().get(Path(path).suffix.lower())
+
+
+@contextmanager
+def output_image(image: Image.Image, format: Optional[str]) -> Iterator[Image.Image]:
+    """
+    Yield a frame in a mode the output format can store.
+
+    RGBA frames bound for formats without alpha are reduced to RGB in a
+    pooled buffer, instead of a fresh conversion per frame; the yielded
+    image is only valid inside the block.
+    """
+    if image.mode != "RGBA" or (format or "").upper() not in FORMATS_WITHOUT_ALPHA:
+        yield image
+        return
+    width, height = image.size
+    pool = frame_pool()
+    with pool.lease(width, height) as rgba, pool.lease(width, height, 3) as rgb:
+        drop_alpha(image_into(image, rgba), out=rgb)
+        yield Image.frombuffer("RGB", (width, height), rgb, "raw", "RGB", 0, 1)
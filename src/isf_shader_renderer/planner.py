@@ -0,0 +1,450 @@
+"""Dry-run planning of renders: probe-based cost profiles and predicted totals."""
+
+import hashlib
+import io
+import json
+import logging
+import os
+import platform
+import statistics
+import time
+from dataclasses import asdict, dataclass, field
+from pathlib import Path
+from typing import Any, Dict, Iterable, List, Optional, Sequence, Tuple, Union
+
+from .canonical import canonical_hash, canonical_json
+from .config import Defaults, ShaderConfig
+from .pixels import image_format, output_image
+from .renderer import ShaderRenderer
+from .sharding import SHARDS_PER_WORKER, plan_shards, stateful_reason
+from .render_graph import shader_footprint
+from .writer import WRITE_BATCH_FRAMES, WRITE_QUEUE_FRAMES
+
+logger = logging.getLogger(__name__)
+
+# Sizes of the probe renders; two sizes separate per-frame from per-pixel cost
+PROBE_SIZES = ((64, 36), (256, 144))
+# Time codes of the sequence sampled at each probe size (first, middle, last)
+PROBE_TIMES = 3
+# Seconds to spawn a worker process and import the renderer in it
+WORKER_STARTUP_SECONDS = 0.5
+# A smaller worker count is preferred while it is within this fraction of the fastest
+JOBS_TOLERANCE = 0.05
+# Fraction of physical memory a plan may fill when choosing the worker count
+MEMORY_BUDGET_FRACTION = 0.8
+PROFILE_VERSION = 3
+
+
+@dataclass
+class ShaderProfile:
+    """
+    Measured cost of one shader job, independent of the output size.
+
+    Render and encode times and file sizes are modelled as a fixed part
+    plus a part proportional to the pixel count, fitted from probe renders
+    at PROBE_SIZES. File sizes extrapolated from small probes tend to run
+    high, since larger frames of the same image compress better.
+
+    Memory is measured in the planning process: process_bytes is its
+    resident size before the probe, standing in for a fresh worker, and
+    shader_bytes the growth while the probe's session was open. Memory
+    an earlier probe left to the allocator or GL driver is reused rather
+    than counted again, and GPU memory the driver does not map is not
+    seen at all, so both can read low. Where the current resident size
+    cannot be read (no /proc), only a rise of the high-water mark counts.
+    """
+
+    compile_seconds: float
+    frame_seconds: float
+    pixel_seconds: float
+    encode_pixel_seconds: float
+    file_bytes: float
+    pixel_bytes: float
+    # Resident size of the process before the shader was compiled
+    process_bytes: int
+    # Resident growth from compiling and rendering the shader
+    shader_bytes: int = 0
+    # Why frames must be rendered in order, if they must (see stateful_reason)
+    stateful: Optional[str] = None
+
+    def render_seconds(self, pixels: int) -> float:
+        return self.frame_seconds + self.pixel_seconds * pixels
+
+    def encode_seconds(self, pixels: int) -> float:
+        return self.encode_pixel_seconds * pixels
+
+    def output_bytes(self, pixels: int) -> float:
+        return self.file_bytes + self.pixel_bytes * pixels
+
+    def to_dict(self) -> Dict[str, Any]:
+        return asdict(self)
+
+    @classmethod
+    def from_dict(cls, data: Dict[str, Any]) -> "ShaderProfile":
+        return cls(**data)
+
+
+def _fit(samples: Sequence[Tuple[int, float]]) -> Tuple[float, float]:
+    """(fixed, per-pixel) line through (pixels, value) samples, neither negative."""
+    (p0, v0), (p1, v1) = samples[0], samples[-1]
+    slope = max((v1 - v0) / (p1 - p0), 0.0) if p1 != p0 else 0.0
+    return max(v0 - slope * p0, 0.0), slope
+
+
+def _resident_bytes() -> int:
+    """Current resident size of this process (its peak where that cannot be read)."""
+    try:
+        with open("/proc/self/statm") as statm:
+            return int(statm.read().split()[1]) * os.sysconf("SC_PAGE_SIZE")
+    except (OSError, ValueError, IndexError):
+        return _peak_resident_bytes()
+
+
+def _peak_resident_bytes() -> int:
+    """Peak resident size of this process (0 where it cannot be read)."""
+    try:
+        import resource
+    except ImportError:
+        return 0
+    peak = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+    # Linux reports kilobytes, macOS bytes
+    return peak if platform.system() == "Darwin" else peak * 1024
+
+
+def _probe_times(times: Sequence[float]) -> List[float]:
+    count = len(times)
+    if count == 0:
+        return [0.0]
+    indices = sorted({round(i * (count - 1) / max(PROBE_TIMES - 1, 1)) for i in range(PROBE_TIMES)})
+    return [float(times[i]) for i in indices]
+
+
+def probe_shader(
+    renderer: ShaderRenderer,
+    shader_content: str,
+    shader_config: ShaderConfig,
+    defaults: Optional[Defaults] = None,
+) -> ShaderProfile:
+    """
+    Profile a shader job from a few small renders.
+
+    The shader is compiled once, rendered at every PROBE_SIZES size at up
+    to PROBE_TIMES time codes of the job, and each frame is encoded in
+    memory in the job's output format. No file is written.
+
+    Args:
+        renderer: Renderer providing sessions (and input, audio and video handling)
+        shader_content: The ISF shader source code
+        shader_config: The job; its times are sampled, its size is not used
+        defaults: Quality for a job that leaves it unset
+
+    Returns:
+        The shader's profile
+
+    Raises:
+        RuntimeError: If the shader fails to compile or render
+    """
+    defaults = defaults or Defaults()
+    format = image_format(shader_config.output)
+    quality = shader_config.get_quality(defaults)
+    times = _probe_times(shader_config.times)
+
+    # Measured against this baseline: the peak is the whole process's high-water mark
+    baseline_bytes = _resident_bytes()
+    baseline_peak = _peak_resident_bytes()
+    started = time.perf_counter()
+    with renderer.session(shader_content, shader_config) as session:
+        # The first frame pays for lazy setup, as the first frame of a real run does
+        session.render_image(times[0], *PROBE_SIZES[0])
+        compile_seconds = time.perf_counter() - started
+
+        render_samples, encode_samples, byte_samples = [], [], []
+        for width, height in PROBE_SIZES:
+            renders, encodes, sizes = [], [], []
+            for time_code in times:
+                started = time.perf_counter()
+                image = session.render_image(time_code, width, height)
+                renders.append(time.perf_counter() - started)
+                if format is None:
+                    # Raw frames (--output -) are not encoded
+                    encodes.append(0.0)
+                    sizes.append(width * height * 4)
+                    continue
+                buffer = io.BytesIO()
+                started = time.perf_counter()
+                with output_image(image, format) as savable:
+                    savable.save(buffer, format=format, quality=quality)
+                encodes.append(time.perf_counter() - started)
+                sizes.append(buffer.tell())
+            pixels = width * height
+            render_samples.append((pixels, statistics.median(renders)))
+            encode_samples.append((pixels, statistics.median(encodes)))
+            byte_samples.append((pixels, statistics.median(sizes)))
+        shader_bytes = _resident_bytes() - baseline_bytes
+
+    # A spike freed before the session closed shows only as a higher peak
+    peak = _peak_resident_bytes()
+    if peak > baseline_peak:
+        shader_bytes = max(shader_bytes, peak - baseline_bytes)
+    frame_seconds, pixel_seconds = _fit(render_samples)
+    # Encoding is taken as proportional to the pixels, from the larger probe
+    _, encode_pixel_seconds = _fit([(0, 0.0), encode_samples[-1]])
+    file_bytes, pixel_bytes = _fit(byte_samples)
+    return ShaderProfile(
+        compile_seconds=compile_seconds,
+        frame_seconds=frame_seconds,
+        pixel_seconds=pixel_seconds,
+        encode_pixel_seconds=encode_pixel_seconds,
+        file_bytes=file_bytes,
+        pixel_bytes=pixel_bytes,
+        process_bytes=baseline_bytes,
+        shader_bytes=max(shader_bytes, 0),
+        stateful=stateful_reason(shader_content),
+    )
+
+
+def profile_key(shader_content: str, shader_config: ShaderConfig, defaults: Optional[Defaults] = None) -> str:
+    """
+    Key of everything a profile depends on except the size and time codes.
+
+    The host is part of the key, so a profile measured on another machine
+    is probed again rather than trusted.
+    """
+    defaults = defaults or Defaults()
+    identity = {
+        "shader": canonical_hash(shader_content),
+        "inputs": shader_config.inputs or {},
+        "audio": shader_config.audio,
+        "video": shader_config.video,
+        "specialize": shader_config.specialize,
+        "format": image_format(shader_config.output),
+        "quality": shader_config.get_quality(defaults),
+        "host": [platform.node(), platform.machine(), os.cpu_count()],
+    }
+    return hashlib.blake2b(canonical_json(identity).encode("utf-8"), digest_size=8).hexdigest()
+
+
+class ProfileCache:
+    """Shader profiles from earlier plans, kept in a JSON file and rewritten atomically."""
+
+    def __init__(self, path: Union[str, Path]):
+        self.path = Path(path)
+        self._profiles: Dict[str, Dict[str, Any]] = {}
+        try:
+            with open(self.path, "r", encoding="utf-8") as f:
+                data = json.load(f)
+            if data.get("version") == PROFILE_VERSION:
+                self._profiles = dict(data.get("profiles", {}))
+        except (OSError, ValueError, AttributeError):
+            pass
+
+    def __len__(self) -> int:
+        return len(self._profiles)
+
+    def get(self, key: str) -> Optional[ShaderProfile]:
+        data = self._profiles.get(key)
+        if data is None:
+            return None
+        try:
+            return ShaderProfile.from_dict(data)
+        except TypeError:
+            return None
+
+    def put(self, key: str, profile: ShaderProfile) -> None:
+        self._profiles[key] = profile.to_dict()
+
+    def save(self) -> None:
+        data = {"version": PROFILE_VERSION, "profiles": self._profiles}
+        self.path.parent.mkdir(parents=True, exist_ok=True)
+        temporary = self.path.with_name(self.path.name + ".tmp")
+        with open(temporary, "w", encoding="utf-8") as f:
+            json.dump(data, f, indent=1, sort_keys=True)
+        os.replace(temporary, self.path)
+
+
+@dataclass
+class JobPlan:
+    """Predicted cost of one shader job."""
+
+    input: str
+    frames: int
+    width: int
+    height: int
+    profile: ShaderProfile
+    # Whether the profile came from the cache rather than a probe
+    cached: bool = False
+    # Pass textures as pyvvisf allocates them, one per target
+    target_bytes: int = 0
+    # Pass textures if targets shared them (see render_graph.shader_footprint); a projection only
+    aliased_target_bytes: int = 0
+
+    @property
+    def pixels(self) -> int:
+        return self.width * self.height
+
+    @property
+    def frame_bytes(self) -> int:
+        return self.pixels * 4
+
+    @property
+    def output_bytes(self) -> int:
+        return int(self.frames * self.profile.output_bytes(self.pixels))
+
+    def _process_bytes(self, aliased: bool = False) -> int:
+        # The readback buffer and its image, plus the pass textures
+        targets = self.aliased_target_bytes if aliased else self.target_bytes
+        return self.profile.process_bytes + self.profile.shader_bytes + 2 * self.frame_bytes + targets
+
+    def shards(self, jobs: int) -> int:
+        """Shards the job is split into with this many workers (as render_sharded plans it)."""
+        if jobs <= 1 or self.profile.stateful:
+            return 1
+        return max(len(plan_shards(self.frames, jobs * SHARDS_PER_WORKER)), 1)
+
+    def wall_seconds(self, jobs: int = 1, cores: Optional[int] = None) -> float:
+        """
+        Predicted time to render the job.
+
+        One process renders while the write-behind queue encodes, so a
+        frame costs the slower of the two; workers render and encode their
+        own frames, compile once per shard, and run no faster than the cores
+        available to them.
+        """
+        render = self.profile.render_seconds(self.pixels)
+        encode = self.profile.encode_seconds(self.pixels)
+        if jobs <= 1:
+            return self.profile.compile_seconds + self.frames * max(render, encode)
+        shards = self.shards(jobs)
+        parallel = max(min(jobs, shards, cores or jobs), 1)
+        work = self.frames * (render + encode) + shards * self.profile.compile_seconds
+        return WORKER_STARTUP_SECONDS + work / parallel
+
+    def peak_bytes(self, jobs: int = 1, aliased: bool = False) -> int:
+        """
+        Predicted peak resident memory of the render, across all its processes.
+
+        With aliased, pass textures count at their aliased footprint, which
+        the renderer does not apply yet; admission uses the default.
+        """
+        if jobs <= 1:
+            queued = (WRITE_QUEUE_FRAMES + WRITE_BATCH_FRAMES) * self.frame_bytes
+            return self._process_bytes(aliased) + queued
+        workers = min(jobs, self.shards(jobs))
+        return self.profile.process_bytes + workers * self._process_bytes(aliased)
+
+
+@dataclass
+class RenderPlan:
+    """Predicted totals of a batch and the worker count that minimises its wall time."""
+
+    jobs: List[JobPlan]
+    cores: int
+    memory_bytes: Optional[int]
+    # (shader input, error) of jobs that could not be probed
+    failed: List[Tuple[str, str]] = field(default_factory=list)
+
+    @property
+    def frames(self) -> int:
+        return sum(job.frames for job in self.jobs)
+
+    @property
+    def output_bytes(self) -> int:
+        return sum(job.output_bytes for job in self.jobs)
+
+    def wall_seconds(self, jobs: int = 1) -> float:
+        """Predicted wall time; jobs render one after another, each across the workers."""
+        return sum(job.wall_seconds(jobs, self.cores) for job in self.jobs)
+
+    def peak_bytes(self, jobs: int = 1, aliased: bool = False) -> int:
+        return max((job.peak_bytes(jobs, aliased) for job in self.jobs), default=0)
+
+    def best_jobs(self) -> int:
+        """
+        The worker count to pass as --jobs.
+
+        Counts from 1 to the number of cores whose predicted peak memory
+        fits the budget are compared, and the smallest within
+        JOBS_TOLERANCE of the fastest is chosen, since extra workers that
+        barely help still cost memory and startup.
+        """
+        budget = self.memory_bytes * MEMORY_BUDGET_FRACTION if self.memory_bytes else None
+        candidates = [
+            jobs for jobs in range(1, max(self.cores, 1) + 1)
+            if jobs == 1 or budget is None or self.peak_bytes(jobs) <= budget
+        ]
+        times = {jobs: self.wall_seconds(jobs) for jobs in candidates}
+        fastest = min(times.values())
+        return next(jobs for jobs in candidates if times[jobs] <= fastest * (1 + JOBS_TOLERANCE))
+
+
+def available_cores() -> int:
+    """CPUs this process may run on."""
+    try:
+        return len(os.sched_getaffinity(0))
+    except AttributeError:
+        return os.cpu_count() or 1
+
+
+def physical_memory() -> Optional[int]:
+    """Physical memory in bytes, or None where it cannot be read."""
+    try:
+        return os.sysconf("SC_PHYS_PAGES") * os.sysconf("SC_PAGE_SIZE")
+    except (AttributeError, ValueError, OSError):
+        return None
+
+
+def plan_render(
+    renderer: ShaderRenderer,
+    jobs: Iterable[Tuple[str, ShaderConfig]],
+    defaults: Optional[Defaults] = None,
+    cache: Optional[ProfileCache] = None,
+) -> RenderPlan:
+    """
+    Predict the cost of rendering shader jobs without rendering their frames.
+
+    Each job is profiled by probe_shader unless the cache holds a profile
+    for it; new profiles are added to the cache and the cache is saved.
+    Jobs whose probe fails are listed in the plan's failed and left out of
+    its totals.
+
+    Args:
+        renderer: Renderer used for the probes
+        jobs: (shader source, configuration) pairs, consumed once
+        defaults: Size and quality for fields a configuration leaves unset
+        cache: Profiles of earlier plans
+
+    Returns:
+        The plan
+    """
+    defaults = defaults or Defaults()
+    plan = RenderPlan([], available_cores(), physical_memory())
+    probed = 0
+    for shader_content, shader_config in jobs:
+        key = profile_key(shader_content, shader_config, defaults)
+        profile = cache.get(key) if cache is not None else None
+        cached = profile is not None
+        if profile is None:
+            try:
+                profile = probe_shader(renderer, shader_content, shader_config, defaults)
+            except Exception as e:
+                logger.error(f"Failed to probe {shader_config.input}: {e}")
+                plan.failed.append((shader_config.input, str(e)))
+                continue
+            probed += 1
+            if cache is not None:
+                cache.put(key, profile)
+        width, height = shader_config.get_width(defaults), shader_config.get_height(defaults)
+        footprint = shader_footprint(shader_content, width, height, shader_config.inputs)
+        plan.jobs.append(JobPlan(
+            shader_config.input,
+            len(shader_config.times),
+            width,
+            height,
+            profile,
+            cached,
+            footprint.unaliased_bytes,
+            footprint.target_bytes,
+        ))
+    if cache is not None and probed:
+        cache.save()
+    return plan
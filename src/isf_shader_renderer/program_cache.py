@@ -0,0 +1,196 @@
+"""Cache of compiled shader programs keyed on the GLSL body, not the metadata."""
+
+import hashlib
+import logging
+from collections import OrderedDict
+from functools import lru_cache
+from typing import Any, Dict, List, Optional, Tuple
+
+import pyvvisf
+from PIL import Image
+
+from .canonical import CANONICAL_CACHE_SIZE, canonical_glsl, canonical_json
+from .specialize import split_isf_source
+
+logger = logging.getLogger(__name__)
+
+# Number of compiled programs kept alive, evicted least recently used first
+PROGRAM_CACHE_SIZE = 16
+
+# Header keys that change the generated program; everything else (DESCRIPTION,
+# CREDIT, CATEGORIES and per-input LABEL/DEFAULT/MIN/MAX/VALUES/LABELS) only
+# affects uniform values or documentation
+_STRUCTURAL_KEYS = ("PASSES", "IMPORTED", "ISFVSN", "PERSISTENT_BUFFERS")
+
+# Values of inputs declared without a DEFAULT, as a fresh compile leaves the uniforms
+_ZERO_VALUES = {
+    "float": 0.0,
+    "long": 0,
+    "bool": False,
+    "event": False,
+    "color": (0.0, 0.0, 0.0, 0.0),
+    "point2D": (0.0, 0.0),
+}
+# Input types backed by textures; unset, they sample as transparent black
+_TEXTURE_TYPES = ("image", "audio", "audioFFT")
+
+
+@lru_cache(maxsize=CANONICAL_CACHE_SIZE)
+def program_key(shader_content: str) -> Optional[str]:
+    """
+    Key identifying the compiled program of a shader.
+
+    Two sources share a key when their canonical GLSL bodies are identical
+    and their headers declare the same inputs (name and type), passes and
+    imports, so a header-only edit of a DEFAULT, LABEL or MIN/MAX, or a
+    comment/whitespace edit of the body, maps to the same program.
+
+    Args:
+        shader_content: The ISF shader source code
+
+    Returns:
+        Hex key, or None for shaders that must not share a program (persistent
+        buffers carry state from one render to the next)
+    """
+    metadata, _, body = split_isf_source(shader_content)
+    structure: Dict[str, Any] = {}
+    if metadata is not None:
+        passes = metadata.get("PASSES") or []
+        if metadata.get("PERSISTENT_BUFFERS") or any(
+            isinstance(p, dict) and p.get("PERSISTENT") for p in passes
+        ):
+            return None
+        structure = {key: metadata[key] for key in _STRUCTURAL_KEYS if key in metadata}
+        structure["INPUTS"] = [
+            [definition.get("NAME"), definition.get("TYPE")]
+            for definition in metadata.get("INPUTS", [])
+        ]
+    digest = hashlib.sha256()
+    digest.update(canonical_json(structure).encode("utf-8"))
+    digest.update(b"\0")
+    digest.update("\n".join(canonical_glsl(body)[0]).encode("utf-8"))
+    return digest.hexdigest()
+
+
+def header_defaults(shader_content: str) -> List[Tuple[str, Any]]:
+    """
+    Return the (name, DEFAULT) pairs declared in a shader's header.
+
+    Array defaults (colors, points) are returned as tuples, matching what
+    ISFRenderer.set_input accepts.
+    """
+    metadata, _, _ = split_isf_source(shader_content)
+    if metadata is None:
+        return []
+    defaults = []
+    for definition in metadata.get("INPUTS", []):
+        if "DEFAULT" not in definition or not definition.get("NAME"):
+            continue
+        value = definition["DEFAULT"]
+        if isinstance(value, list):
+            value = tuple(value)
+        defaults.append((definition["NAME"], value))
+    return defaults
+
+
+def header_resets(shader_content: str) -> List[Tuple[str, Any]]:
+    """
+    Return the (name, value) pairs that reset every input a header declares.
+
+    Inputs with a DEFAULT take it; the others take MIN, or their type's
+    zero value, and texture inputs a transparent 1x1 image. Inputs of
+    unknown type are left out.
+    """
+    metadata, _, _ = split_isf_source(shader_content)
+    if metadata is None:
+        return []
+    defaults = dict(header_defaults(shader_content))
+    resets = []
+    for definition in metadata.get("INPUTS", []):
+        name, kind = definition.get("NAME"), definition.get("TYPE")
+        if not name:
+            continue
+        if name in defaults:
+            value = defaults[name]
+        elif kind in _TEXTURE_TYPES:
+            value = Image.new("RGBA", (1, 1))
+        elif kind in _ZERO_VALUES:
+            value = definition.get("MIN", _ZERO_VALUES[kind])
+            if isinstance(value, list):
+                value = tuple(value)
+        else:
+            continue
+        resets.append((name, value))
+    return resets
+
+
+class ProgramCache:
+    """
+    LRU cache of compiled ISFRenderer programs.
+
+    Every lookup rebinds every input the header declares (see
+    header_resets), so a reused program starts from the same uniform state
+    as a fresh compile of the new header and never inherits inputs set by
+    an earlier render. The program's MIN/MAX clamping, if any, still
+    follows the header it was compiled from.
+    """
+
+    def __init__(self, max_size: int = PROGRAM_CACHE_SIZE):
+        self.max_size = max_size
+        self._programs: "OrderedDict[str, Any]" = OrderedDict()
+        self.hits = 0
+        self.misses = 0
+
+    def __len__(self) -> int:
+        return len(self._programs)
+
+    def acquire(self, shader_content: str) -> Tuple[Any, bool]:
+        """
+        Return a compiled program for a shader with its defaults bound.
+
+        Args:
+            shader_content: The ISF shader source code
+
+        Returns:
+            (renderer, cached). When cached is False the renderer is a fresh,
+            uncached ISFRenderer that the caller must close with __exit__.
+        """
+        key = program_key(shader_content)
+        if key is None:
+            renderer = pyvvisf.ISFRenderer(shader_content)
+            renderer.__enter__()
+            return renderer, False
+
+        renderer = self._programs.get(key)
+        if renderer is not None:
+            self._programs.move_to_end(key)
+            self.hits += 1
+            self._reset_inputs(renderer, shader_content)
+            return renderer, True
+
+        self.misses += 1
+        renderer = pyvvisf.ISFRenderer(shader_content)
+        renderer.__enter__()
+        self._programs[key] = renderer
+        while len(self._programs) > self.max_size:
+            _, evicted = self._programs.popitem(last=False)
+            evicted.__exit__(None, None, None)
+        return renderer, True
+
+    def _reset_inputs(self, renderer, shader_content: str) -> None:
+        """Reset every declared input to its value in the current header."""
+        for name, value in header_resets(shader_content):
+            try:
+                renderer.set_input(name, value)
+            except Exception as e:
+                logger.warning(f"Failed to reset input '{name}': {e}")
+
+    def stats(self) -> Dict[str, int]:
+        """Return cache hit/miss counters."""
+        return {"size": len(self._programs), "hits": self.hits, "misses": self.misses}
+
+    def clear(self) -> None:
+        """Release every cached program."""
+        while self._programs:
+            _, renderer = self._programs.popitem()
+            renderer.__exit__(None, None, None)
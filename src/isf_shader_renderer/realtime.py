@@ -0,0 +1,306 @@
+"""Real-time rendering on a wall clock into a shared-memory frame ring."""
+
+import os
+import struct
+import sys
+import threading
+import time
+from dataclasses import dataclass
+from multiprocessing import resource_tracker, shared_memory
+from typing import Callable, Dict, Optional, Tuple
+
+import numpy as np
+
+# Shared-memory layout (little endian), for consumers in other languages:
+#
+#   header (64 bytes)
+#     0   4s   magic "ISFR"
+#     4   u32  layout version
+#     8   u32  width
+#     12  u32  height
+#     16  u32  channels (4, RGBA)
+#     20  u32  slot count
+#     24  u64  bytes per frame
+#     32  u64  sequence number of the latest complete frame (0: none yet)
+#     40  f64  frames per second
+#   slot table (slots x 32 bytes)
+#     0   u64  sequence number of the frame in the slot (0 while being written)
+#     8   f64  shader TIME of the frame (seconds)
+#     16  u64  CLOCK_MONOTONIC publish time (ns)
+#     24  u64  reserved
+#   frames (slots x bytes per frame), frame n in slot n % slots, rows top-down
+RING_MAGIC = b"ISFR"
+RING_VERSION = 1
+HEADER_SIZE = 64
+SLOT_ENTRY_SIZE = 32
+DEFAULT_RING_NAME = "isf-render"
+DEFAULT_RING_SLOTS = 3
+
+_HEADER = struct.Struct("<4sIIIIIQQd")
+_LATEST = struct.Struct("<Q")
+_SLOT = struct.Struct("<QdQQ")
+
+# Latency samples kept for percentiles (a fixed window, so long runs do not grow)
+LATENCY_WINDOW = 4096
+
+
+class FrameRing:
+    """
+    Ring of RGBA frames in POSIX shared memory.
+
+    The producer writes frame n into slot n % slots, clearing the slot's
+    sequence number while it writes, then publishes the frame by storing
+    its sequence number in the slot and the header. A consumer reads the
+    header's latest sequence number, maps the slot's pixels without copying
+    and checks that the slot still holds that sequence number when done.
+    """
+
+    def __init__(self, shm: shared_memory.SharedMemory, owner: bool):
+        self._shm = shm
+        self.owner = owner
+        magic, version, width, height, channels, slots, frame_bytes, _, fps = _HEADER.unpack_from(shm.buf, 0)
+        if magic != RING_MAGIC or version != RING_VERSION:
+            raise ValueError(f"Shared memory '{shm.name}' is not an ISF frame ring")
+        self.width, self.height, self.channels = width, height, channels
+        self.slots, self.frame_bytes, self.fps = slots, frame_bytes, fps
+        frames_offset = HEADER_SIZE + slots * SLOT_ENTRY_SIZE
+        self._frames = np.ndarray(
+            (slots, height, width, channels), dtype=np.uint8, buffer=shm.buf, offset=frames_offset
+        )
+
+    @classmethod
+    def create(
+        cls,
+        width: int,
+        height: int,
+        slots: int = DEFAULT_RING_SLOTS,
+        name: Optional[str] = DEFAULT_RING_NAME,
+        fps: float = 0.0,
+    ) -> "FrameRing":
+        """Create (or replace a stale) ring segment."""
+        frame_bytes = width * height * 4
+        size = HEADER_SIZE + slots * (SLOT_ENTRY_SIZE + frame_bytes)
+        try:
+            shm = shared_memory.SharedMemory(name=name, create=True, size=size)
+        except FileExistsError:
+            # Left behind by a producer that did not exit cleanly
+            stale = shared_memory.SharedMemory(name=name)
+            stale.close()
+            stale.unlink()
+            shm = shared_memory.SharedMemory(name=name, create=True, size=size)
+        shm.buf[:HEADER_SIZE + slots * SLOT_ENTRY_SIZE] = bytes(HEADER_SIZE + slots * SLOT_ENTRY_SIZE)
+        _HEADER.pack_into(shm.buf, 0, RING_MAGIC, RING_VERSION, width, height, 4, slots, frame_bytes, 0, fps)
+        return cls(shm, owner=True)
+
+    @classmethod
+    def attach(cls, name: str = DEFAULT_RING_NAME) -> "FrameRing":
+        """
+        Attach to a ring created by another process.
+
+        The segment is not registered with this process's resource tracker,
+        which before Python 3.13 would unlink the producer's ring when this
+        consumer exits.
+        """
+        if sys.version_info >= (3, 13):
+            return cls(shared_memory.SharedMemory(name=name, track=False), owner=False)
+        shm = shared_memory.SharedMemory(name=name)
+        if os.name == "posix":
+            resource_tracker.unregister(shm._name, "shared_memory")
+        return cls(shm, owner=False)
+
+    @property
+    def name(self) -> str:
+        """Name of the shared-memory segment (/dev/shm/<name> on Linux)."""
+        return self._shm.name
+
+    @property
+    def latest_sequence(self) -> int:
+        """Sequence number of the latest published frame (0 before the first)."""
+        return _LATEST.unpack_from(self._shm.buf, 32)[0]
+
+    def slot(self, sequence: int) -> Tuple[int, float, int]:
+        """Return (sequence, time, publish_ns) of the slot that holds a sequence number."""
+        sequence_in_slot, time_code, published_ns, _ = _SLOT.unpack_from(
+            self._shm.buf, HEADER_SIZE + (sequence % self.slots) * SLOT_ENTRY_SIZE
+        )
+        return sequence_in_slot, time_code, published_ns
+
+    def frame_view(self, sequence: int) -> np.ndarray:
+        """Zero-copy (height, width, 4) view of the slot for a sequence number."""
+        return self._frames[sequence % self.slots]
+
+    def begin_write(self, sequence: int) -> np.ndarray:
+        """Invalidate the slot for a new frame and return its pixels to fill."""
+        _SLOT.pack_into(self._shm.buf, HEADER_SIZE + (sequence % self.slots) * SLOT_ENTRY_SIZE, 0, 0.0, 0, 0)
+        return self._frames[sequence % self.slots]
+
+    def publish(self, sequence: int, time_code: float, published_ns: int) -> None:
+        """Mark a written frame as complete and make it the latest."""
+        _SLOT.pack_into(
+            self._shm.buf, HEADER_SIZE + (sequence % self.slots) * SLOT_ENTRY_SIZE,
+            sequence, time_code, published_ns, 0,
+        )
+        _LATEST.pack_into(self._shm.buf, 32, sequence)
+
+    def close(self) -> None:
+        """Unmap the ring; the creating process also removes the segment."""
+        self._frames = None
+        self._shm.close()
+        if self.owner:
+            self._shm.unlink()
+
+
+@dataclass
+class RealtimeStats:
+    """Frame accounting of a real-time run."""
+
+    frames: int = 0
+    dropped: int = 0
+    late: int = 0
+    elapsed: float = 0.0
+    latency_mean_ms: float = 0.0
+    latency_p50_ms: float = 0.0
+    latency_p95_ms: float = 0.0
+    latency_p99_ms: float = 0.0
+    latency_max_ms: float = 0.0
+
+    @property
+    def effective_fps(self) -> float:
+        """Frames actually published per second."""
+        return self.frames / self.elapsed if self.elapsed > 0 else 0.0
+
+    def describe(self) -> str:
+        """One-line summary."""
+        return (
+            f"{self.frames} frames ({self.effective_fps:.1f} fps), {self.dropped} dropped, {self.late} late; "
+            f"latency mean {self.latency_mean_ms:.2f} ms, p95 {self.latency_p95_ms:.2f} ms, "
+            f"p99 {self.latency_p99_ms:.2f} ms, max {self.latency_max_ms:.2f} ms"
+        )
+
+
+class DeadlineScheduler:
+    """
+    Fixed-rate frame deadlines on a monotonic clock.
+
+    Frame k is due at start + k / fps and renders shader TIME k / fps. When
+    rendering falls more than a full period behind, the frames whose slots
+    have passed are dropped (counted, never rendered) so output stays locked
+    to the wall clock instead of drifting. Latency is measured from a frame's
+    deadline to its publication.
+    """
+
+    def __init__(self, fps: float, clock: Callable[[], int] = time.monotonic_ns):
+        if fps <= 0:
+            raise ValueError("fps must be positive")
+        self.fps = fps
+        self.period_ns = int(round(1e9 / fps))
+        self._clock = clock
+        self.start_ns = clock()
+        self.next_frame = 0
+        self._latencies = np.zeros(LATENCY_WINDOW, dtype=np.float64)
+        self.stats = RealtimeStats()
+
+    def deadline(self, frame: int) -> int:
+        """Monotonic time (ns) at which a frame is due."""
+        return self.start_ns + frame * self.period_ns
+
+    def next(self) -> Tuple[int, float]:
+        """
+        Pick the frame to render now, dropping frames that are already too late.
+
+        Returns:
+            (frame number, shader TIME in seconds)
+        """
+        now = self._clock()
+        current = (now - self.start_ns) // self.period_ns
+        if current > self.next_frame:
+            self.stats.dropped += current - self.next_frame
+            self.next_frame = current
+        frame = self.next_frame
+        return frame, frame * self.period_ns / 1e9
+
+    def finish(self, frame: int, published_ns: int) -> int:
+        """
+        Record a published frame.
+
+        Returns:
+            Nanoseconds to wait before the next frame is due (0 if overdue)
+        """
+        latency = published_ns - self.deadline(frame)
+        self._latencies[self.stats.frames % LATENCY_WINDOW] = max(latency, 0) / 1e6
+        self.stats.frames += 1
+        if latency > self.period_ns:
+            self.stats.late += 1
+        self.next_frame = frame + 1
+        return max(self.deadline(self.next_frame) - self._clock(), 0)
+
+    def summary(self) -> RealtimeStats:
+        """Statistics so far, with latency percentiles over the recent window."""
+        stats = self.stats
+        stats.elapsed = (self._clock() - self.start_ns) / 1e9
+        samples = self._latencies[:min(stats.frames, LATENCY_WINDOW)]
+        if samples.size:
+            p50, p95, p99 = np.percentile(samples, [50, 95, 99])
+            stats.latency_mean_ms = float(samples.mean())
+            stats.latency_p50_ms, stats.latency_p95_ms, stats.latency_p99_ms = float(p50), float(p95), float(p99)
+            stats.latency_max_ms = float(samples.max())
+        return stats
+
+
+def run_realtime(
+    render: Callable[[float, np.ndarray], None],
+    ring: FrameRing,
+    fps: float,
+    duration: Optional[float] = None,
+    stop: Optional[threading.Event] = None,
+    report: Optional[Callable[[RealtimeStats], None]] = None,
+    report_interval: float = 5.0,
+) -> RealtimeStats:
+    """
+    Render frames on a wall-clock schedule into a frame ring.
+
+    Args:
+        render: Renders shader TIME t into the given (height, width, 4) buffer
+        ring: Ring the frames are published to
+        fps: Target frame rate
+        duration: Seconds to run (None runs until stop is set)
+        stop: Event ending the run early
+        report: Called with running statistics every report_interval seconds
+        report_interval: Seconds between reports
+
+    Returns:
+        Final statistics
+    """
+    scheduler = DeadlineScheduler(fps)
+    end_ns = scheduler.start_ns + int(duration * 1e9) if duration is not None else None
+    next_report = scheduler.start_ns + int(report_interval * 1e9)
+    stop = stop or threading.Event()
+
+    while not stop.is_set():
+        frame, time_code = scheduler.next()
+        if end_ns is not None and scheduler.deadline(frame) >= end_ns:
+            break
+        sequence = frame + 1
+        render(time_code, ring.begin_write(sequence))
+        published_ns = time.monotonic_ns()
+        ring.publish(sequence, time_code, published_ns)
+        wait_ns = scheduler.finish(frame, published_ns)
+
+        if report is not None and published_ns >= next_report:
+            report(scheduler.summary())
+            next_report += int(report_interval * 1e9)
+        if wait_ns:
+            stop.wait(wait_ns / 1e9)
+    return scheduler.summary()
+
+
+def describe_ring(ring: FrameRing) -> Dict[str, object]:
+    """Parameters a consumer needs to attach to the ring."""
+    return {
+        "name": ring.name,
+        "width": ring.width,
+        "height": ring.height,
+        "channels": ring.channels,
+        "slots": ring.slots,
+        "fps": ring.fps,
+    }
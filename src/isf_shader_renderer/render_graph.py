@@ -0,0 +1,431 @@
+"""Render-graph IR of multipass ISF shaders: pass DAG, target lifetimes and texture aliasing."""
+
+import ast
+import logging
+import math
+import re
+from dataclasses import dataclass, field
+from typing import Any, Dict, FrozenSet, List, Mapping, Optional, Sequence, Set, Tuple
+
+from .canonical import canonical_glsl
+from .program_cache import header_defaults
+from .specialize import split_isf_source
+
+logger = logging.getLogger(__name__)
+
+# Bytes per pixel of 8-bit RGBA and of FLOAT (32-bit float RGBA) targets
+RGBA8_BYTES = 4
+RGBA32F_BYTES = 16
+
+# Functions allowed in WIDTH/HEIGHT expressions
+_EXPRESSION_FUNCTIONS = {
+    "floor": math.floor,
+    "ceil": math.ceil,
+    "round": round,
+    "abs": abs,
+    "min": min,
+    "max": max,
+    "sqrt": math.sqrt,
+    "pow": math.pow,
+    "log2": math.log2,
+    "exp2": lambda x: 2.0 ** x,
+}
+_EXPRESSION_OPERATORS = {
+    ast.Add: lambda a, b: a + b,
+    ast.Sub: lambda a, b: a - b,
+    ast.Mult: lambda a, b: a * b,
+    ast.Div: lambda a, b: a / b,
+    ast.FloorDiv: lambda a, b: a // b,
+    ast.Mod: lambda a, b: a % b,
+    # In floats, so "9**9**9" overflows at once instead of building a huge integer
+    ast.Pow: lambda a, b: float(a) ** b,
+}
+_PASS_TEST = re.compile(r"\bPASSINDEX\b")
+_PASS_EQUALS = re.compile(r"^\s*\(*\s*(?:PASSINDEX\s*==\s*(\d+)|(\d+)\s*==\s*PASSINDEX)\s*\)*\s*$")
+_IF = re.compile(r"\s*\bif\s*\(")
+_ELSE = re.compile(r"\s*\belse\b")
+
+
+def evaluate_dimension(expression: Any, width: int, height: int, inputs: Optional[Mapping[str, Any]] = None) -> int:
+    """
+    Evaluate a pass WIDTH/HEIGHT expression such as "$WIDTH/2" or "floor($HEIGHT/$scale)".
+
+    $WIDTH and $HEIGHT are the render size and any other $name an input
+    value. Only arithmetic and a few math functions are evaluated; the
+    result is truncated to an integer of at least 1.
+
+    Raises:
+        ValueError: If the expression is malformed or names an unknown value
+    """
+    if isinstance(expression, (int, float)) and not isinstance(expression, bool):
+        return max(int(expression), 1)
+    values = {"WIDTH": width, "HEIGHT": height}
+    for name, value in (inputs or {}).items():
+        # Command-line inputs arrive as strings
+        try:
+            values[name] = float(value)
+        except (TypeError, ValueError):
+            continue
+    source = re.sub(r"\$(\w+)", r"_\1", str(expression))
+    try:
+        tree = ast.parse(source, mode="eval")
+    except SyntaxError as e:
+        raise ValueError(f"Invalid size expression {expression!r}: {e.msg}")
+
+    def visit(node: ast.AST) -> float:
+        if isinstance(node, ast.Expression):
+            return visit(node.body)
+        if isinstance(node, ast.Constant) and isinstance(node.value, (int, float)):
+            return node.value
+        if isinstance(node, ast.Name) and node.id.startswith("_") and node.id[1:] in values:
+            return values[node.id[1:]]
+        if isinstance(node, ast.BinOp) and type(node.op) in _EXPRESSION_OPERATORS:
+            return _EXPRESSION_OPERATORS[type(node.op)](visit(node.left), visit(node.right))
+        if isinstance(node, ast.UnaryOp) and isinstance(node.op, (ast.USub, ast.UAdd)):
+            operand = visit(node.operand)
+            return -operand if isinstance(node.op, ast.USub) else operand
+        if (
+            isinstance(node, ast.Call) and isinstance(node.func, ast.Name)
+            and node.func.id in _EXPRESSION_FUNCTIONS and not node.keywords
+        ):
+            return _EXPRESSION_FUNCTIONS[node.func.id](*(visit(arg) for arg in node.args))
+        raise ValueError(f"Unsupported term in size expression {expression!r}")
+
+    try:
+        return max(int(visit(tree)), 1)
+    except (ArithmeticError, TypeError) as e:
+        raise ValueError(f"Cannot evaluate size expression {expression!r}: {e}")
+
+
+def _matching(text: str, start: int, opening: str, closing: str) -> int:
+    """Index just past the bracket closing the one at start (or the end of text)."""
+    depth = 0
+    for i in range(start, len(text)):
+        if text[i] == opening:
+            depth += 1
+        elif text[i] == closing:
+            depth -= 1
+            if depth == 0:
+                return i + 1
+    return len(text)
+
+
+def _statement_end(text: str, start: int) -> int:
+    """Index just past the GLSL statement at start: a block, an if/else chain or a simple statement."""
+    while start < len(text) and text[start].isspace():
+        start += 1
+    if text.startswith("{", start):
+        return _matching(text, start, "{", "}")
+    branch = _IF.match(text, start)
+    if branch is not None:
+        end = _statement_end(text, _matching(text, branch.end() - 1, "(", ")"))
+        otherwise = _ELSE.match(text, end)
+        return _statement_end(text, otherwise.end()) if otherwise else end
+    semicolon = text.find(";", start)
+    return len(text) if semicolon == -1 else semicolon + 1
+
+
+def _passes_tested(text: str, branch: "re.Match") -> Tuple[Optional[Set[int]], int]:
+    """Passes an if condition selects when it only compares PASSINDEX for equality, and the condition's end."""
+    condition_end = _matching(text, branch.end() - 1, "(", ")")
+    tested: Optional[Set[int]] = set()
+    for term in text[branch.end():condition_end - 1].split("||"):
+        equals = _PASS_EQUALS.match(term)
+        if equals is None:
+            tested = None
+            break
+        tested.add(int(equals.group(1) or equals.group(2)))
+    return tested, condition_end
+
+
+def _pass_code(body: str, passes: FrozenSet[int]) -> List[Tuple[FrozenSet[int], str]]:
+    """
+    Split GLSL into (passes it runs in, code) pieces.
+
+    In a chain of `if (PASSINDEX == n)` / `else if` tests (a test may join
+    several with ||) each branch runs only in its passes and a final else
+    only in the passes none of them selected. Code under any other
+    condition counts for every pass it is nested in.
+    """
+    pieces: List[Tuple[FrozenSet[int], str]] = []
+    position = search = 0
+    while True:
+        branch = _IF.search(body, search)
+        if branch is None:
+            break
+        tested, condition_end = _passes_tested(body, branch)
+        if tested is None:
+            search = branch.end()
+            continue
+        pieces.append((passes, body[position:branch.start()]))
+        covered: Set[int] = set()
+        while True:
+            covered |= tested
+            end = _statement_end(body, condition_end)
+            pieces.extend(_pass_code(body[condition_end:end], passes & frozenset(tested)))
+            otherwise = _ELSE.match(body, end)
+            if otherwise is None:
+                break
+            following = _IF.match(body, otherwise.end())
+            if following is not None:
+                tested, condition_end = _passes_tested(body, following)
+                if tested is not None:
+                    continue
+            # A plain else, or an else-if on something else, runs where no test matched
+            end = _statement_end(body, otherwise.end())
+            pieces.extend(_pass_code(body[otherwise.end():end], passes - frozenset(covered)))
+            break
+        position = search = end
+    pieces.append((passes, body[position:]))
+    return pieces
+
+
+@dataclass
+class RenderPass:
+    """One entry of PASSES: the target it draws into (None for the output) and the targets it samples."""
+
+    index: int
+    target: Optional[str]
+    reads: Set[str] = field(default_factory=set)
+
+
+@dataclass
+class RenderTarget:
+    """A named pass target and the passes that write and read it within a frame."""
+
+    name: str
+    persistent: bool = False
+    float: bool = False
+    width: Any = None
+    height: Any = None
+    writers: List[int] = field(default_factory=list)
+    readers: List[int] = field(default_factory=list)
+
+    @property
+    def bytes_per_pixel(self) -> int:
+        return RGBA32F_BYTES if self.float else RGBA8_BYTES
+
+    @property
+    def carried(self) -> bool:
+        """Whether the target's contents must survive from one frame to the next."""
+        if self.persistent:
+            return True
+        # Read before (or while) it is first written: the previous frame's pixels are used
+        return bool(self.readers) and (not self.writers or min(self.readers) <= min(self.writers))
+
+    def lifetime(self, pass_count: int) -> Tuple[int, int]:
+        """First and last pass (inclusive) during which the target's contents are needed."""
+        if self.carried:
+            return 0, max(pass_count - 1, 0)
+        uses = self.writers + self.readers
+        return min(self.writers), max(uses)
+
+    def size(self, width: int, height: int, inputs: Optional[Mapping[str, Any]] = None) -> Tuple[int, int]:
+        """The target's size at a render size; an unreadable expression counts as the full size."""
+        sizes = []
+        for expression, full in ((self.width, width), (self.height, height)):
+            if expression is None:
+                sizes.append(full)
+                continue
+            try:
+                sizes.append(evaluate_dimension(expression, width, height, inputs))
+            except ValueError as e:
+                logger.warning(f"Target {self.name}: {e}; assuming {full}")
+                sizes.append(full)
+        return sizes[0], sizes[1]
+
+
+@dataclass
+class Texture:
+    """A physical texture of the allocation, shared by targets whose lifetimes do not overlap."""
+
+    width: int
+    height: int
+    float: bool
+    targets: List[str] = field(default_factory=list)
+
+    @property
+    def bytes(self) -> int:
+        return self.width * self.height * (RGBA32F_BYTES if self.float else RGBA8_BYTES)
+
+
+@dataclass
+class Allocation:
+    """Physical textures of a render graph at one render size."""
+
+    width: int
+    height: int
+    textures: List[Texture]
+    # Texture index of every target
+    assignment: Dict[str, int]
+    # Bytes the targets would take with a texture each
+    unaliased_bytes: int
+
+    @property
+    def target_bytes(self) -> int:
+        return sum(texture.bytes for texture in self.textures)
+
+    @property
+    def output_bytes(self) -> int:
+        """The 8-bit RGBA output the last pass draws into."""
+        return self.width * self.height * RGBA8_BYTES
+
+    @property
+    def total_bytes(self) -> int:
+        """Planned footprint of a frame: pass textures plus the output."""
+        return self.target_bytes + self.output_bytes
+
+    def aliases(self) -> List[List[str]]:
+        """Groups of targets sharing a texture."""
+        return [texture.targets for texture in self.textures if len(texture.targets) > 1]
+
+
+@dataclass
+class RenderGraph:
+    """
+    Pass DAG of an ISF shader, built from its PASSES metadata and GLSL body.
+
+    Passes run in declaration order. A pass reads a target when the body
+    names it in code that runs in that pass (see _pass_code), and depends on
+    the last earlier pass that wrote it; a read with no earlier writer sees
+    the previous frame, so the target is carried across frames like a
+    persistent one. Edges always point forward, so the order is a
+    topological order of the DAG.
+    """
+
+    passes: List[RenderPass]
+    targets: Dict[str, RenderTarget]
+
+    @classmethod
+    def from_shader(cls, shader_content: str) -> "RenderGraph":
+        """Build the graph of a shader; a shader without PASSES is a single output pass."""
+        metadata, _, body = split_isf_source(shader_content)
+        metadata = metadata or {}
+        definitions = [p if isinstance(p, dict) else {} for p in (metadata.get("PASSES") or [{}])]
+        legacy = metadata.get("PERSISTENT_BUFFERS") or []
+        legacy_sizes = legacy if isinstance(legacy, dict) else {}
+
+        passes: List[RenderPass] = []
+        targets: Dict[str, RenderTarget] = {}
+        for index, definition in enumerate(definitions):
+            name = definition.get("TARGET") or None
+            passes.append(RenderPass(index, name))
+            if name is None:
+                continue
+            target = targets.setdefault(name, RenderTarget(name))
+            sizes = legacy_sizes.get(name) if isinstance(legacy_sizes.get(name), dict) else {}
+            target.persistent |= bool(definition.get("PERSISTENT")) or name in legacy
+            target.float |= bool(definition.get("FLOAT") or sizes.get("FLOAT"))
+            target.width = definition.get("WIDTH", sizes.get("WIDTH", target.width))
+            target.height = definition.get("HEIGHT", sizes.get("HEIGHT", target.height))
+            target.writers.append(index)
+
+        if targets:
+            code = "\n".join(canonical_glsl(body)[0])
+            every_pass = frozenset(range(len(passes)))
+            names = re.compile(r"\b(" + "|".join(re.escape(name) for name in targets) + r")\b")
+            for runs_in, piece in _pass_code(code, every_pass):
+                referenced = set(names.findall(piece))
+                for index in runs_in:
+                    passes[index].reads |= referenced
+            for render_pass in passes:
+                for name in render_pass.reads:
+                    targets[name].readers.append(render_pass.index)
+        return cls(passes, targets)
+
+    def producer(self, pass_index: int, target: str) -> Optional[int]:
+        """The pass whose output of target pass_index reads, or None if it reads the previous frame."""
+        writers = [i for i in self.targets[target].writers if i < pass_index]
+        return max(writers) if writers else None
+
+    def edges(self) -> List[Tuple[int, int, str]]:
+        """Dependencies (producer pass, consumer pass, target) within a frame."""
+        edges = []
+        for render_pass in self.passes:
+            for name in sorted(render_pass.reads):
+                producer = self.producer(render_pass.index, name)
+                if producer is not None:
+                    edges.append((producer, render_pass.index, name))
+        return edges
+
+    def dead_passes(self) -> List[int]:
+        """Passes whose target nothing reads, in this frame or the next."""
+        return [
+            p.index for p in self.passes
+            if p.target is not None and not self.targets[p.target].readers and not self.targets[p.target].persistent
+        ]
+
+    def allocate(self, width: int, height: int, inputs: Optional[Mapping[str, Any]] = None) -> Allocation:
+        """
+        Assign the targets to physical textures at a render size.
+
+        Targets carried across frames keep a texture of their own. Every
+        other target takes over a texture of the same size and format whose
+        last target's lifetime ended in an earlier pass, so a chain of blur
+        passes reuses two or three textures instead of one per pass.
+
+        Args:
+            width: Render width
+            height: Render height
+            inputs: Input values for size expressions that name inputs
+
+        Returns:
+            The allocation
+        """
+        count = len(self.passes)
+        textures: List[Texture] = []
+        # Last pass each texture is needed in; None for carried targets, which are never shared
+        busy_until: List[Optional[int]] = []
+        assignment: Dict[str, int] = {}
+        unaliased = 0
+        ordered = sorted(self.targets.values(), key=lambda t: (t.lifetime(count), t.name))
+        for target in ordered:
+            target_width, target_height = target.size(width, height, inputs)
+            first, last = target.lifetime(count)
+            unaliased += target_width * target_height * target.bytes_per_pixel
+            slot = None
+            if not target.carried:
+                for index, texture in enumerate(textures):
+                    free_after = busy_until[index]
+                    if (
+                        free_after is not None and free_after < first
+                        and (texture.width, texture.height, texture.float) == (target_width, target_height, target.float)
+                    ):
+                        slot = index
+                        break
+            if slot is None:
+                textures.append(Texture(target_width, target_height, target.float))
+                busy_until.append(None)
+                slot = len(textures) - 1
+            textures[slot].targets.append(target.name)
+            busy_until[slot] = None if target.carried else last
+            assignment[target.name] = slot
+        return Allocation(width, height, textures, assignment, unaliased)
+
+    def describe(self) -> List[str]:
+        """One line per pass, e.g. 'pass 1: blurX -> reads source'."""
+        lines = []
+        for render_pass in self.passes:
+            target = render_pass.target or "output"
+            if render_pass.target and self.targets[render_pass.target].persistent:
+                target += " (persistent)"
+            reads = ", ".join(sorted(render_pass.reads)) or "nothing"
+            lines.append(f"pass {render_pass.index}: {target} <- reads {reads}")
+        return lines
+
+
+def shader_footprint(
+    shader_content: str,
+    width: int,
+    height: int,
+    inputs: Optional[Mapping[str, Any]] = None,
+) -> Allocation:
+    """
+    The planned pass-texture allocation of a shader at a render size.
+
+    Size expressions see the given input values, falling back to the
+    header DEFAULTs. Use total_bytes to decide whether a render fits.
+    """
+    values = dict(header_defaults(shader_content))
+    values.update(inputs or {})
+    return RenderGraph.from_shader(shader_content).allocate(width, height, values)
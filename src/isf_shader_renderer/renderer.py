@@ -1,19 +1,68 @@
 """ISF shader rendering functionality using pyvvisf."""
 
 import logging
+from collections import OrderedDict
+from concurrent.futures import ThreadPoolExecutor
+from contextlib import contextmanager
+from dataclasses import replace
 from pathlib import Path
-from typing import Any, Dict, Optional, Tuple
+from typing import Any, Dict, Iterator, Optional, Sequence, Tuple
 
+import numpy as np
 import pyvvisf
 from PIL import Image
 
+from .audio import AudioTrack, audio_inputs
+from .buffers import frame_pool, image_into
+from .canonical import canonical_hash
 from .config import ShaderConfig, ShaderRendererConfig
+from .frames import FrameStream
+from .program_cache import ProgramCache
+from .specialize import specialization_key, specialize_shader
+from .stats import compute_frame_stats
+from .textures import is_image_value, texture_cache
+from .timebase import times_key
+from .video import VideoFrameSource, video_input
+from .writer import FrameWriter, write_image_atomic
 
 # Force logger to print INFO-level logs to stdout
 logging.basicConfig(level=logging.INFO, format="%(levelname)s:%(name)s:%(message)s")
 
 logger = logging.getLogger(__name__)
 
+# Number of specialized programs kept compiled, evicted least recently used first
+SPECIALIZED_CACHE_SIZE = 8
+
+# Number of validation results remembered by canonical source hash
+VALIDATION_CACHE_SIZE = 64
+
+# Number of precomputed audio tracks kept, evicted least recently used first
+AUDIO_TRACK_CACHE_SIZE = 4
+
+# Number of open video sources (each with a prefetch thread) kept
+VIDEO_SOURCE_CACHE_SIZE = 2
+
+
+def _build_error_info(e: Exception) -> Dict[str, Any]:
+    """Collect structured error details for a failed render."""
+    import traceback
+    error_info = {
+        "type": type(e).__name__,
+        "message": str(e),
+    }
+    if hasattr(e, 'error_code'):
+        error_info["error_code"] = getattr(e, 'error_code')
+    if hasattr(e, 'details'):
+        error_info["details"] = getattr(e, 'details')
+    error_info["traceback"] = traceback.format_exc()
+    return error_info
+
+
+def _error_message(e: Exception) -> str:
+    """The message of a render error, from the details _build_error_info put in it if present."""
+    details = e.args[0] if e.args and isinstance(e.args[0], dict) else {"message": str(e)}
+    return str(details.get("message"))
+
 
 class ShaderRenderer:
     """Main renderer class for ISF shaders using VVISF."""
@@ -22,6 +71,16 @@ class ShaderRenderer:
         """Initialize the renderer with configuration."""
         self.config = config
         self._current_shader: Optional[str] = None
+        # Compiled programs shared by sources that differ only in header metadata
+        self._programs = ProgramCache()
+        # Specialized programs by (canonical hash, input tuple); None marks a failed specialization
+        self._specialized: "OrderedDict[Tuple[str, Tuple], Optional[RenderSession]]" = OrderedDict()
+        # Validation results by canonical hash, so reformatted resubmissions are not recompiled
+        self._validated: "OrderedDict[str, bool]" = OrderedDict()
+        # Audio textures by (file, audio inputs, time codes), precomputed once per sequence
+        self._audio_tracks: "OrderedDict[Tuple, AudioTrack]" = OrderedDict()
+        # Video sources by (file, time codes), each prefetching the planned frames
+        self._video_sources: "OrderedDict[Tuple, VideoFrameSource]" = OrderedDict()
 
     def render_frame(
         self,
@@ -29,56 +88,237 @@ class ShaderRenderer:
         time_code: float,
         output_path: Path,
         shader_config: Optional[ShaderConfig] = None,
-    ) -> None:
+        compute_stats: bool = False,
+        writer: Optional[FrameWriter] = None,
+        journal_key: Optional[str] = None,
+    ) -> Optional[Dict[str, Any]]:
         """
         Render a single frame of an ISF shader.
 
+        The file is written atomically (a crash never leaves a truncated
+        frame under output_path). With a writer, it is queued for the
+        writer's background thread instead of written before returning.
+
         Args:
             shader_content: The ISF shader source code
             time_code: Time offset for the shader (for animated shaders)
             output_path: Path to save the rendered image
             shader_config: Optional shader-specific configuration
+            compute_stats: Also compute pixel statistics on the readback buffer
+            writer: Optional write-behind queue for the file
+            journal_key: Frame key the writer records in its journal
+
+        Returns:
+            Frame statistics (see stats.compute_frame_stats) if compute_stats
+            is set, otherwise None
         """
         # Get render dimensions
         width, height = self._get_dimensions(shader_config)
 
         # Render using the new ISFRenderer class
         try:
-            with pyvvisf.ISFRenderer(shader_content) as renderer:
-                # Set shader inputs if provided
-                self._set_shader_inputs(renderer, shader_config, time_code, width, height)
+            session = self._specialized_session(shader_content, shader_config)
+            if session is not None:
+                image = self._render_image(
+                    session._renderer,
+                    replace(shader_config, inputs=session.shader_config.inputs),
+                    time_code,
+                    width,
+                    height,
+                    session.shader_content,
+                )
+                return self._save_frame(image, output_path, shader_config, compute_stats, writer, journal_key)
+
+            with self._program(shader_content) as renderer:
+                image = self._render_image(renderer, shader_config, time_code, width, height, shader_content)
+                return self._save_frame(image, output_path, shader_config, compute_stats, writer, journal_key)
+
+        except Exception as e:
+            logger.error(f"Failed to render frame: {e}")
+            raise RuntimeError(_build_error_info(e))
+
+    @contextmanager
+    def _program(self, shader_content: str) -> Iterator[Any]:
+        """Yield a compiled program, reusing one whose GLSL body matches."""
+        renderer, cached = self._programs.acquire(shader_content)
+        try:
+            yield renderer
+        finally:
+            if not cached:
+                renderer.__exit__(None, None, None)
+
+    def _save_frame(
+        self,
+        image: Image.Image,
+        output_path: Path,
+        shader_config: Optional[ShaderConfig],
+        compute_stats: bool,
+        writer: Optional[FrameWriter] = None,
+        journal_key: Optional[str] = None,
+    ) -> Optional[Dict[str, Any]]:
+        """Optionally compute statistics, then write the frame to disk or queue it."""
+        stats = None
+        if compute_stats:
+            with frame_pool().lease(*image.size) as pixels:
+                stats = compute_frame_stats(image_into(image, pixels))
+
+        if writer is not None:
+            writer.submit(image, output_path, self._get_quality(shader_config), journal_key)
+            return stats
+
+        # Encoded next to the target and renamed into place
+        write_image_atomic(image, output_path, self._get_quality(shader_config))
+
+        logger.info(f"Successfully rendered frame to {output_path}")
+        return stats
+
+    def _specialized_session(
+        self,
+        shader_content: str,
+        shader_config: Optional[ShaderConfig],
+    ) -> Optional["RenderSession"]:
+        """
+        Return a cached program with the config's fixed inputs baked in.
 
-                # Render the frame
-                buffer = renderer.render(width, height, time_offset=time_code)
+        Programs are shared by every config with the same shader and inputs,
+        so the session's own config only supplies the inputs left as
+        uniforms: callers render with their config and those inputs.
 
-                # Convert buffer to PIL Image and save
-                image = buffer.to_pil_image()
-                if image is None:
-                    raise RuntimeError(
-                        "Failed to render: image is None (buffer conversion failed)"
-                    )
+        Returns None when specialization is off, there is nothing to bake, or
+        the specialized source failed to compile (the caller then renders
+        with ordinary uniforms).
+        """
+        if shader_config is None or not shader_config.specialize or not shader_config.inputs:
+            return None
+        key = (
+            canonical_hash(shader_content),
+            specialization_key(shader_config.inputs),
+        )
+        if key in self._specialized:
+            self._specialized.move_to_end(key)
+            return self._specialized[key]
 
-                # Create output directory if needed
-                output_path.parent.mkdir(parents=True, exist_ok=True)
+        session = self._compile_specialized(shader_content, shader_config)
+        self._specialized[key] = session
+        if len(self._specialized) > SPECIALIZED_CACHE_SIZE:
+            _, evicted = self._specialized.popitem(last=False)
+            if evicted is not None:
+                evicted.close()
+        return session
 
-                # Save the image
-                image.save(output_path, quality=self._get_quality(shader_config))
+    def _compile_specialized(
+        self,
+        shader_content: str,
+        shader_config: ShaderConfig,
+    ) -> Optional["RenderSession"]:
+        """Compile the shader with the config's fixed inputs baked in; None if nothing was baked or it failed."""
+        source, remaining = specialize_shader(shader_content, shader_config.inputs)
+        if source == shader_content:
+            return None
+        try:
+            session = RenderSession(self, source, replace(shader_config, inputs=remaining or None))
+        except RuntimeError as e:
+            logger.warning(f"Specialization failed, falling back to uniforms: {e}")
+            return None
+        logger.info(
+            f"Compiled specialized program with {len(shader_config.inputs) - len(remaining)} constant input(s)"
+        )
+        return session
 
-                logger.info(f"Successfully rendered frame to {output_path}")
+    def render_array(
+        self,
+        shader_content: str,
+        time_code: float,
+        shader_config: Optional[ShaderConfig] = None,
+        out: Optional[np.ndarray] = None,
+    ) -> np.ndarray:
+        """
+        Render a single frame into memory instead of a file.
 
+        Args:
+            shader_content: The ISF shader source code
+            time_code: Time offset for the shader (for animated shaders)
+            shader_config: Optional shader-specific configuration
+            out: Optional (height, width, 4) uint8 buffer to fill (e.g. from
+                the frame pool); its size overrides the configured size
+
+        Returns:
+            The frame as a (height, width, 4) uint8 RGBA array
+        """
+        if out is not None:
+            height, width = out.shape[:2]
+        else:
+            width, height = self._get_dimensions(shader_config)
+        try:
+            session = self._specialized_session(shader_content, shader_config)
+            if session is not None:
+                image = self._render_image(
+                    session._renderer,
+                    replace(shader_config, inputs=session.shader_config.inputs),
+                    time_code,
+                    width,
+                    height,
+                    session.shader_content,
+                )
+            else:
+                with self._program(shader_content) as renderer:
+                    image = self._render_image(renderer, shader_config, time_code, width, height, shader_content)
+            return image_into(image, out) if out is not None else np.asarray(image)
         except Exception as e:
             logger.error(f"Failed to render frame: {e}")
-            error_info = {
-                "type": type(e).__name__,
-                "message": str(e),
-            }
-            if hasattr(e, 'error_code'):
-                error_info["error_code"] = getattr(e, 'error_code')
-            if hasattr(e, 'details'):
-                error_info["details"] = getattr(e, 'details')
-            import traceback
-            error_info["traceback"] = traceback.format_exc()
-            raise RuntimeError(error_info)
+            raise RuntimeError(_build_error_info(e))
+
+    def session(
+        self,
+        shader_content: str,
+        shader_config: Optional[ShaderConfig] = None,
+    ) -> "RenderSession":
+        """
+        Compile a shader once for rendering many frames.
+
+        Args:
+            shader_content: The ISF shader source code
+            shader_config: Optional shader-specific configuration
+
+        With shader_config.specialize, the fixed inputs are baked into the
+        program, as for single frames.
+
+        Returns:
+            A RenderSession; use it as a context manager or call close()
+        """
+        if shader_config is not None and shader_config.specialize and shader_config.inputs:
+            session = self._compile_specialized(shader_content, shader_config)
+            if session is not None:
+                return session
+        return RenderSession(self, shader_content, shader_config)
+
+    def _render_image(
+        self,
+        renderer,
+        shader_config: Optional[ShaderConfig],
+        time_code: float,
+        width: int,
+        height: int,
+        shader_content: Optional[str] = None,
+    ) -> Image.Image:
+        """Set inputs, render one frame and convert the buffer to a PIL image."""
+        # Set shader inputs if provided
+        self._set_shader_inputs(renderer, shader_config, time_code, width, height)
+        if shader_config is not None and shader_config.audio and shader_content is not None:
+            self._set_audio_inputs(renderer, shader_content, shader_config, time_code)
+        if shader_config is not None and shader_config.video and shader_content is not None:
+            self._set_video_input(renderer, shader_content, shader_config, time_code)
+
+        # Render the frame
+        buffer = renderer.render(width, height, time_offset=time_code)
+
+        # Convert buffer to PIL Image
+        image = buffer.to_pil_image()
+        if image is None:
+            raise RuntimeError(
+                "Failed to render: image is None (buffer conversion failed)"
+            )
+        return image
 
     def _set_shader_inputs(
         self,
@@ -88,14 +328,30 @@ class ShaderRenderer:
         width: int,
         height: int
     ) -> None:
-        """Set shader input values using the ISFRenderer instance from render_frame."""
+        """
+        Set shader input values using the ISFRenderer instance from render_frame.
+
+        Image inputs are loaded first and a missing, refused or undecodable
+        image raises ValueError (which the render methods turn into
+        RuntimeError); other values that cannot be set are logged and skipped.
+        """
+        images = {}
+        if shader_config and shader_config.inputs:
+            images = {
+                input_name: self._load_image_input(input_name, input_value)
+                for input_name, input_value in shader_config.inputs.items()
+                if is_image_value(input_value)
+            }
         try:
             # Set shader-specific inputs from config
             if shader_config and shader_config.inputs:
                 for input_name, input_value in shader_config.inputs.items():
                     try:
+                        # Image inputs (paths, bytes, data URLs) come from the shared texture cache
+                        if input_name in images:
+                            renderer.set_input(input_name, images[input_name])
                         # Handle different input types based on the new API's auto-coercion
-                        if isinstance(input_value, str):
+                        elif isinstance(input_value, str):
                             # Try to parse string values appropriately
                             if input_value.lower() in ("true", "1", "yes", "on"):
                                 renderer.set_input(input_name, True)
@@ -140,6 +396,92 @@ class ShaderRenderer:
         except Exception as e:
             logger.error(f"Failed to set shader inputs: {e}")
 
+    def _load_image_input(self, input_name: str, input_value: Any) -> Image.Image:
+        """
+        Decode an image input through the shared texture cache.
+
+        File paths are only accepted if the config allows them: MCP and HTTP
+        clients must send data: URLs or bytes instead of naming server files.
+
+        Raises:
+            ValueError: If the image is a refused path, missing or undecodable
+        """
+        if not self.config.allow_image_paths and isinstance(input_value, (str, Path)) and not str(input_value).startswith("data:"):
+            raise ValueError(f"Image input '{input_name}' must be a base64 data: URL, not a file path")
+        try:
+            return Image.fromarray(texture_cache().load(input_value), "RGBA")
+        except Exception as e:
+            raise ValueError(f"Failed to load image input '{input_name}': {e}") from e
+
+    def _set_audio_inputs(
+        self,
+        renderer,
+        shader_content: str,
+        shader_config: ShaderConfig,
+        time_code: float,
+    ) -> None:
+        """Feed the audio/audioFFT inputs the textures of the configured WAV file at time_code."""
+        specs = audio_inputs(shader_content)
+        if not specs:
+            return
+        path = Path(shader_config.audio).expanduser()
+        try:
+            stat = path.stat()
+            key = (str(path.resolve()), stat.st_mtime_ns, tuple(specs), times_key(shader_config.times))
+            track = self._audio_tracks.get(key)
+            if track is None:
+                # Precompute every frame of the sequence in one pass on first use
+                track = AudioTrack(path, specs, shader_config.times)
+                logger.info(
+                    f"Precomputed audio textures for {len(track.times)} time code(s) from {path} "
+                    f"({track.duration:.1f}s, {track.rate} Hz)"
+                )
+                self._audio_tracks[key] = track
+                if len(self._audio_tracks) > AUDIO_TRACK_CACHE_SIZE:
+                    self._audio_tracks.popitem(last=False)
+            else:
+                self._audio_tracks.move_to_end(key)
+        except (OSError, ValueError) as e:
+            raise ValueError(f"Cannot load audio file '{path}': {e}")
+
+        for input_name, texture in track.inputs_at(time_code).items():
+            try:
+                renderer.set_input(input_name, texture)
+            except Exception as e:
+                logger.warning(f"Failed to set audio input '{input_name}': {e}")
+
+    def _set_video_input(
+        self,
+        renderer,
+        shader_content: str,
+        shader_config: ShaderConfig,
+        time_code: float,
+    ) -> None:
+        """Upload the configured video's frame at time_code as the shader's image input."""
+        input_name = video_input(shader_content)
+        if input_name is None:
+            return
+        path = Path(shader_config.video).expanduser()
+        try:
+            stat = path.stat()
+            key = (str(path.resolve()), stat.st_mtime_ns, times_key(shader_config.times))
+            source = self._video_sources.get(key)
+            if source is None:
+                # Frames of the whole sequence are decoded ahead on a prefetch thread
+                source = VideoFrameSource(path, shader_config.times)
+                width, height = source.size
+                logger.info(f"Streaming {width}x{height} video from {path} at {source.fps:g} fps")
+                self._video_sources[key] = source
+                if len(self._video_sources) > VIDEO_SOURCE_CACHE_SIZE:
+                    _, evicted = self._video_sources.popitem(last=False)
+                    evicted.close()
+            else:
+                self._video_sources.move_to_end(key)
+            frame = source.frame_at(time_code)
+        except (OSError, ValueError) as e:
+            raise ValueError(f"Cannot read video file '{path}': {e}")
+        renderer.set_input(input_name, Image.fromarray(frame, "RGBA"))
+
     def _get_dimensions(self, shader_config: Optional[ShaderConfig]) -> Tuple[int, int]:
         """Get render dimensions from config."""
         if shader_config:
@@ -160,12 +502,27 @@ class ShaderRenderer:
         """
         Validate ISF shader content.
 
+        Results are cached by canonical source hash, so a resubmission that
+        only differs in comments or formatting is answered without compiling.
+
         Args:
             shader_content: The ISF shader source code
 
         Returns:
             True if the shader is valid, False otherwise
         """
+        key = canonical_hash(shader_content)
+        if key in self._validated:
+            self._validated.move_to_end(key)
+            return self._validated[key]
+        valid = self._validate_uncached(shader_content)
+        self._validated[key] = valid
+        if len(self._validated) > VALIDATION_CACHE_SIZE:
+            self._validated.popitem(last=False)
+        return valid
+
+    def _validate_uncached(self, shader_content: str) -> bool:
+        """Compile and test-render a shader to validate it."""
         try:
             # Use ISFRenderer to validate the shader and GLSL compilation
             with pyvvisf.ISFRenderer(shader_content) as renderer:
@@ -187,16 +544,6 @@ class ShaderRenderer:
                 return True
         except Exception as e:
             logger.error(f"Shader validation failed: {e}")
-            error_info = {
-                "type": type(e).__name__,
-                "message": str(e),
-            }
-            if hasattr(e, 'error_code'):
-                error_info["error_code"] = getattr(e, 'error_code')
-            if hasattr(e, 'details'):
-                error_info["details"] = getattr(e, 'details')
-            import traceback
-            error_info["traceback"] = traceback.format_exc()
             return False
 
     def get_shader_info(self, shader_content: str) -> Dict[str, Any]:
@@ -270,26 +617,180 @@ class ShaderRenderer:
                 except Exception as ex:
                     logger.warning(f"Failed to parse ISF JSON block: {ex}")
             logger.warning(f"Failed to extract shader info: {e}")
-            error_info = {
-                "type": type(e).__name__,
-                "message": str(e),
-            }
-            if hasattr(e, 'error_code'):
-                error_info["error_code"] = getattr(e, 'error_code')
-            if hasattr(e, 'details'):
-                error_info["details"] = getattr(e, 'details')
-            import traceback
-            error_info["traceback"] = traceback.format_exc()
             return {
                 "type": "ISF",
                 "size": len(shader_content),
                 "lines": len(shader_content.splitlines()),
                 "description": None,
                 "credit": None,
-                "error": error_info,
+                "error": _build_error_info(e),
             }
 
     def cleanup(self) -> None:
         """Clean up resources."""
         # Note: ISFRenderer handles its own cleanup via context manager
+        self._programs.clear()
+        for session in self._specialized.values():
+            if session is not None:
+                session.close()
+        self._specialized.clear()
+        self._validated.clear()
+        self._audio_tracks.clear()
+        for source in self._video_sources.values():
+            source.close()
+        self._video_sources.clear()
         logger.info("Cleanup completed.")
+
+
+class RenderSession:
+    """A compiled shader kept alive for rendering a sequence of frames."""
+
+    def __init__(
+        self,
+        owner: ShaderRenderer,
+        shader_content: str,
+        shader_config: Optional[ShaderConfig] = None,
+    ):
+        """Compile the shader; raises RuntimeError with error details on failure."""
+        self._owner = owner
+        self.shader_content = shader_content
+        self.shader_config = shader_config
+        self._renderer = None
+        self._executor: Optional[ThreadPoolExecutor] = None
+        try:
+            self._renderer = pyvvisf.ISFRenderer(shader_content)
+            self._renderer.__enter__()
+        except Exception as e:
+            logger.error(f"Failed to compile shader: {e}")
+            raise RuntimeError(_build_error_info(e))
+
+    def render_image(
+        self,
+        time_code: float,
+        width: Optional[int] = None,
+        height: Optional[int] = None,
+    ) -> Image.Image:
+        """
+        Render one frame of the session's shader.
+
+        Args:
+            time_code: Time offset for the shader
+            width: Override for the configured width
+            height: Override for the configured height
+
+        Returns:
+            The rendered frame as a PIL image
+        """
+        default_width, default_height = self._owner._get_dimensions(self.shader_config)
+        try:
+            return self._owner._render_image(
+                self._renderer,
+                self.shader_config,
+                time_code,
+                width or default_width,
+                height or default_height,
+                self.shader_content,
+            )
+        except Exception as e:
+            logger.error(f"Failed to render frame: {e}")
+            raise RuntimeError(_build_error_info(e))
+
+    def render_array(
+        self,
+        time_code: float,
+        width: Optional[int] = None,
+        height: Optional[int] = None,
+        out: Optional[np.ndarray] = None,
+    ) -> np.ndarray:
+        """
+        Render one frame and return it as a (height, width, 4) uint8 array.
+
+        With out, the frame is copied into that buffer (whose size wins over
+        width and height) instead of a newly allocated array.
+        """
+        if out is not None:
+            return self.render_into(time_code, out)
+        return np.asarray(self.render_image(time_code, width, height))
+
+    def render_into(self, time_code: float, out: np.ndarray) -> np.ndarray:
+        """
+        Render one frame into a preallocated (height, width, 4) uint8 buffer.
+
+        The frame size is taken from the buffer, so a caller that renders
+        into the same buffers for hours allocates nothing of its own per frame.
+        """
+        height, width = out.shape[:2]
+        return image_into(self.render_image(time_code, width, height), out)
+
+    def save_frame(
+        self,
+        time_code: float,
+        output_path: Path,
+        compute_stats: bool = False,
+    ) -> Optional[Dict[str, Any]]:
+        """
+        Render one frame at the configured size and write it to a file.
+
+        Args:
+            time_code: Time offset for the shader
+            output_path: Path to save the rendered image
+            compute_stats: Also compute pixel statistics on the readback buffer
+
+        Returns:
+            Frame statistics if compute_stats is set, otherwise None
+        """
+        image = self.render_image(time_code)
+        try:
+            return self._owner._save_frame(image, Path(output_path), self.shader_config, compute_stats)
+        except Exception as e:
+            logger.error(f"Failed to save frame: {e}")
+            raise RuntimeError(_build_error_info(e))
+
+    @property
+    def executor(self) -> ThreadPoolExecutor:
+        """The session's render thread, started on first use by async frame iteration."""
+        if self._executor is None:
+            self._executor = ThreadPoolExecutor(max_workers=1, thread_name_prefix="render-session")
+        return self._executor
+
+    def frames(
+        self,
+        time_codes: Sequence[float],
+        width: Optional[int] = None,
+        height: Optional[int] = None,
+    ) -> FrameStream:
+        """
+        Render frames lazily as they are consumed.
+
+        Use `for frame in session.frames(times)` to render on the calling
+        thread, or `async for` to render on the session's render thread one
+        frame ahead. Each Frame carries a read-only pixel view, its render
+        and conversion times and a content hash; the view is reused after
+        the next frame is requested (Frame.copy() keeps it). Do not call
+        other session methods while an async iteration is running.
+
+        Args:
+            time_codes: Time codes to render, in order
+            width: Override for the configured width
+            height: Override for the configured height
+
+        Returns:
+            A FrameStream, iterable synchronously and asynchronously
+        """
+        default_width, default_height = self._owner._get_dimensions(self.shader_config)
+        return FrameStream(self, time_codes, width or default_width, height or default_height)
+
+    def close(self) -> None:
+        """Release the compiled shader and the render thread."""
+        if self._executor is not None:
+            self._executor.shutdown(wait=True)
+            self._executor = None
+        if self._renderer is not None:
+            self._renderer.__exit__(None, None, None)
+            self._renderer = None
+
+    def __enter__(self) -> "RenderSession":
+        return self
+
+    def __exit__(self, exc_type, exc, tb) -> None:
+        self.close()
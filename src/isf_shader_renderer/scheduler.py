@@ -0,0 +1,266 @@
+"""Placement of render workers and llvmpipe rasterizer threads on the host's CPUs."""
+
+import io
+import logging
+import multiprocessing
+import os
+import time
+from concurrent.futures import ProcessPoolExecutor
+from dataclasses import dataclass, replace
+from pathlib import Path
+from typing import Dict, List, Optional, Sequence, Tuple
+
+from .config import ShaderConfig, ShaderRendererConfig
+from .pixels import image_format, output_image
+
+logger = logging.getLogger(__name__)
+
+# Environment variable llvmpipe reads for its rasterizer thread count when a context is created
+LP_NUM_THREADS = "LP_NUM_THREADS"
+# Largest rasterizer thread count llvmpipe accepts
+LP_MAX_THREADS = 32
+# Edge of llvmpipe's square rasterizer tiles, the unit its threads share out
+LP_TILE_SIZE = 64
+# Tiles per frame a rasterizer thread needs to outweigh its synchronisation and
+# the single-threaded work (setup, readback, encoding) each worker does per frame
+TILES_PER_THREAD = 64
+# Seconds each layout renders during calibration, after compiling and a first frame
+CALIBRATION_SECONDS = 1.0
+
+
+@dataclass(frozen=True)
+class CpuTopology:
+    """The CPUs this process may run on, grouped by physical core."""
+
+    # CPU ids of each physical core (hyperthread siblings together), in package and core order
+    cores: Tuple[Tuple[int, ...], ...]
+
+    @property
+    def cpus(self) -> Tuple[int, ...]:
+        return tuple(cpu for core in self.cores for cpu in core)
+
+    @classmethod
+    def detect(cls) -> "CpuTopology":
+        """
+        Read the topology of the allowed CPUs.
+
+        Siblings are grouped from /sys on Linux; elsewhere, or where it cannot
+        be read, every CPU counts as its own core.
+        """
+        try:
+            allowed = sorted(os.sched_getaffinity(0))
+        except AttributeError:
+            allowed = list(range(os.cpu_count() or 1))
+        groups: Dict[Tuple[int, int], List[int]] = {}
+        for cpu in allowed:
+            topology = Path(f"/sys/devices/system/cpu/cpu{cpu}/topology")
+            try:
+                package = int((topology / "physical_package_id").read_text())
+                core = int((topology / "core_id").read_text())
+            except (OSError, ValueError):
+                package, core = 0, -1 - cpu
+            groups.setdefault((package, core), []).append(cpu)
+        ordered = sorted(groups.items(), key=lambda item: (item[0][0], min(item[1])))
+        return cls(tuple(tuple(cpus) for _, cpus in ordered))
+
+
+@dataclass(frozen=True)
+class WorkerLayout:
+    """How many workers render, with how many rasterizer threads each, on which CPUs."""
+
+    workers: int
+    threads: int
+    # CPUs each worker is pinned to; empty where affinity is not set
+    cpu_sets: Tuple[Tuple[int, ...], ...] = ()
+
+    def describe(self) -> str:
+        return f"{self.workers} workers x {self.threads} threads"
+
+
+def rasterizer_threads(width: int, height: int) -> int:
+    """Rasterizer threads a frame of this size keeps busy (see TILES_PER_THREAD), a power of two."""
+    tiles = -(-width // LP_TILE_SIZE) * -(-height // LP_TILE_SIZE)
+    threads = max(1, min(tiles // TILES_PER_THREAD, LP_MAX_THREADS))
+    return 1 << (threads.bit_length() - 1)
+
+
+def _environment_threads() -> Optional[int]:
+    try:
+        return max(int(os.environ[LP_NUM_THREADS]), 1)
+    except (KeyError, ValueError):
+        return None
+
+
+def _cpu_sets(topology: CpuTopology, workers: int) -> Tuple[Tuple[int, ...], ...]:
+    """Split the CPUs into one contiguous set per worker, keeping physical cores whole where possible."""
+    units: Sequence[Tuple[int, ...]] = topology.cores
+    if workers > len(units):
+        units = [(cpu,) for cpu in topology.cpus]
+    if workers > len(units) or workers <= 1:
+        return ()
+    sets = []
+    for index in range(workers):
+        begin, end = index * len(units) // workers, (index + 1) * len(units) // workers
+        sets.append(tuple(cpu for unit in units[begin:end] for cpu in unit))
+    return tuple(sets)
+
+
+def plan_layout(
+    topology: CpuTopology,
+    width: int,
+    height: int,
+    jobs: Optional[int] = None,
+    threads: Optional[int] = None,
+) -> WorkerLayout:
+    """
+    Balance workers against rasterizer threads for a frame size.
+
+    llvmpipe starts one rasterizer thread per CPU in every context by
+    default, so N workers on N CPUs run N x N threads. Given threads,
+    as many workers run as fill the CPUs. Given jobs, each worker gets
+    its share of the CPUs, but no more threads than its frame size
+    keeps busy (see rasterizer_threads), so CPUs may be left idle. With
+    neither given, each worker gets the threads its frame size keeps
+    busy and the CPUs are shared out among as many workers. An
+    LP_NUM_THREADS already in the environment counts as a given thread
+    count. Workers are pinned to disjoint sets of whole cores when they
+    fit.
+
+    Args:
+        topology: CPUs to place the workers on
+        width: Frame width
+        height: Frame height
+        jobs: Worker count, if fixed
+        threads: Rasterizer threads per worker, if fixed
+
+    Returns:
+        The layout
+    """
+    cpus = max(len(topology.cpus), 1)
+    if threads is None:
+        threads = _environment_threads()
+    if jobs is None and threads is None:
+        threads = min(rasterizer_threads(width, height), cpus)
+    if jobs is None:
+        jobs = max(cpus // threads, 1)
+    elif threads is None:
+        threads = max(min(cpus // jobs, rasterizer_threads(width, height)), 1)
+    threads = min(threads, LP_MAX_THREADS)
+    return WorkerLayout(jobs, threads, _cpu_sets(topology, jobs))
+
+
+def candidate_layouts(topology: CpuTopology, width: int, height: int, max_workers: Optional[int] = None) -> List[WorkerLayout]:
+    """Layouts worth calibrating: each power-of-two thread count up to what the frame keeps busy, filling the CPUs."""
+    cpus = max(len(topology.cpus), 1)
+    limit = min(rasterizer_threads(width, height), cpus)
+    layouts = {}
+    threads = 1
+    while threads <= limit:
+        workers = min(max(cpus // threads, 1), max_workers or cpus)
+        layouts[(workers, threads)] = WorkerLayout(workers, threads, _cpu_sets(topology, workers))
+        threads *= 2
+    return list(layouts.values())
+
+
+def configure_process(threads: int, cpus: Sequence[int] = ()) -> None:
+    """
+    Set this process's rasterizer thread count and CPU affinity.
+
+    Takes effect for contexts created afterwards, so it is called before
+    the first render: in the CLI before rendering starts, and in workers
+    by their pool's initializer.
+    """
+    os.environ[LP_NUM_THREADS] = str(threads)
+    if cpus and hasattr(os, "sched_setaffinity"):
+        try:
+            os.sched_setaffinity(0, cpus)
+        except OSError as e:
+            logger.warning(f"Could not pin worker to CPUs {list(cpus)}: {e}")
+
+
+def _init_worker(threads: int, cpu_sets: "multiprocessing.Queue") -> None:
+    # Each worker takes the next CPU set as it starts
+    cpus = cpu_sets.get() if cpu_sets is not None else ()
+    configure_process(threads, cpus)
+
+
+def worker_pool(layout: WorkerLayout) -> ProcessPoolExecutor:
+    """A pool of spawned workers, each configured for the layout before it renders."""
+    # Spawned workers start from a clean interpreter without inherited GL state
+    context = multiprocessing.get_context("spawn")
+    cpu_sets = None
+    if layout.cpu_sets:
+        cpu_sets = context.Queue()
+        for cpus in layout.cpu_sets:
+            cpu_sets.put(cpus)
+    return ProcessPoolExecutor(
+        max_workers=layout.workers,
+        mp_context=context,
+        initializer=_init_worker,
+        initargs=(layout.threads, cpu_sets),
+    )
+
+
+def _calibration_frames(shader_content: str, config: ShaderConfig, seconds: float) -> Tuple[int, float]:
+    """Render and encode frames for about `seconds`; runs in a worker. Returns (frames, elapsed)."""
+    from .renderer import ShaderRenderer
+
+    renderer = ShaderRenderer(ShaderRendererConfig())
+    format = image_format(config.output) or "PNG"
+    times = config.times
+    try:
+        with renderer.session(shader_content, config) as session:
+            session.render_image(times[0])
+            frames = 0
+            started = time.perf_counter()
+            while time.perf_counter() - started < seconds:
+                image = session.render_image(times[frames % len(times)])
+                with output_image(image, format) as savable:
+                    savable.save(io.BytesIO(), format=format, quality=config.quality or 95)
+                frames += 1
+            return frames, time.perf_counter() - started
+    finally:
+        renderer.cleanup()
+
+
+def calibrate(
+    shader_content: str,
+    shader_config: ShaderConfig,
+    topology: Optional[CpuTopology] = None,
+    max_workers: Optional[int] = None,
+    seconds: float = CALIBRATION_SECONDS,
+) -> Tuple[WorkerLayout, Dict[WorkerLayout, float]]:
+    """
+    Time each candidate layout on the job itself and pick the fastest.
+
+    Every layout of candidate_layouts runs its workers side by side for
+    about `seconds`, each rendering and encoding frames of the job in
+    memory at its real size, and is scored by the frames per second of all
+    its workers together. Nothing is written.
+
+    Args:
+        shader_content: The ISF shader source code
+        shader_config: The job, with width and height resolved
+        topology: CPUs to calibrate on (default: detected)
+        max_workers: Upper bound on the worker count
+        seconds: Timed rendering per layout
+
+    Returns:
+        (fastest layout, frames per second of every layout tried)
+
+    Raises:
+        RuntimeError: If the shader fails to compile or render
+    """
+    topology = topology or CpuTopology.detect()
+    config = replace(shader_config, times=[float(t) for t in list(shader_config.times[:64])] or [0.0])
+    results: Dict[WorkerLayout, float] = {}
+    for layout in candidate_layouts(topology, config.width, config.height, max_workers):
+        with worker_pool(layout) as pool:
+            futures = [
+                pool.submit(_calibration_frames, shader_content, config, seconds)
+                for _ in range(layout.workers)
+            ]
+            results[layout] = sum(frames / elapsed for frames, elapsed in (f.result() for f in futures) if elapsed > 0)
+        logger.info(f"Calibration: {layout.describe()} renders {results[layout]:.1f} frames/s")
+    best = max(results, key=lambda layout: results[layout])
+    return best, results
@@ -0,0 +1,485 @@
+"""Frame-sharded rendering of one long sequence across worker processes."""
+
+import hashlib
+import json
+import logging
+import os
+import re
+import tempfile
+import time
+from concurrent.futures import Future
+from dataclasses import dataclass, field, replace
+from pathlib import Path
+from typing import Any, Callable, Dict, Iterator, List, Optional, Tuple
+
+import numpy as np
+
+from .buffers import frame_pool
+from .canonical import canonical_glsl, canonical_hash, canonical_json
+from .config import Defaults, ShaderConfig, ShaderRendererConfig
+from .renderer import ShaderRenderer, _error_message
+from .scheduler import CpuTopology, WorkerLayout, plan_layout, worker_pool
+from .specialize import split_isf_source
+from .timebase import frame_number, times_key
+
+logger = logging.getLogger(__name__)
+
+# Shards per worker: more shards than workers even out frames of uneven cost
+# and bound the work a crash loses
+SHARDS_PER_WORKER = 4
+# Shards are not split below this many frames, since each compiles the shader
+MIN_SHARD_FRAMES = 16
+# Frames per shard when streaming, which bounds the spooled frames on disk
+STREAM_SHARD_FRAMES = 64
+# Shards queued per worker ahead of the in-order consumer when streaming
+STREAM_SHARDS_AHEAD = 2
+# Poll interval of the in-order reader while a worker is still writing a shard
+SPOOL_POLL_SECONDS = 0.005
+JOURNAL_VERSION = 1
+
+# Built-in uniforms whose value depends on the frames rendered before
+_ORDER_DEPENDENT = re.compile(r"\b(FRAMEINDEX|TIMEDELTA)\b")
+
+
+def stateful_reason(shader_content: str) -> Optional[str]:
+    """
+    Why a shader's frames cannot be rendered independently, if they cannot.
+
+    Persistent buffers carry pixels from one frame to the next, and
+    FRAMEINDEX/TIMEDELTA count frames of the render that produced them, so
+    such shaders only match a serial render when every frame is rendered
+    in order by one program.
+
+    Args:
+        shader_content: The ISF shader source code
+
+    Returns:
+        A reason, or None if frames are independent of each other
+    """
+    metadata, _, body = split_isf_source(shader_content)
+    if metadata is not None:
+        passes = metadata.get("PASSES") or []
+        if metadata.get("PERSISTENT_BUFFERS") or any(
+            isinstance(p, dict) and p.get("PERSISTENT") for p in passes
+        ):
+            return "it has persistent buffers that carry state from frame to frame"
+    match = _ORDER_DEPENDENT.search("\n".join(canonical_glsl(body)[0]))
+    if match:
+        return f"it reads {match.group(1)}, which depends on the frames rendered before"
+    return None
+
+
+@dataclass(frozen=True)
+class Shard:
+    """Frames at positions begin .. end-1 of a sequence."""
+
+    index: int
+    begin: int
+    end: int
+
+    def __len__(self) -> int:
+        return self.end - self.begin
+
+
+def plan_shards(frame_count: int, shards: int) -> List[Shard]:
+    """
+    Split a sequence into contiguous shards of near-equal length.
+
+    Args:
+        frame_count: Frames in the sequence
+        shards: Requested number of shards (fewer are used for short
+            sequences, so no shard is shorter than MIN_SHARD_FRAMES)
+
+    Returns:
+        Shards in frame order, covering every frame once
+    """
+    shards = max(1, min(shards, frame_count // MIN_SHARD_FRAMES))
+    bounds = [i * frame_count // shards for i in range(shards + 1)]
+    return [Shard(i, bounds[i], bounds[i + 1]) for i in range(shards) if bounds[i + 1] > bounds[i]]
+
+
+@dataclass
+class ShardJob:
+    """One shard, rendered by a worker with its own renderer."""
+
+    shader_content: str
+    # Configuration with times narrowed to the shard and the size resolved
+    shader_config: ShaderConfig
+    # Frame number of the shard's first frame (names its output files)
+    first_number: int
+    # Raw RGBA spool file for streaming; None writes the configured outputs
+    spool: Optional[str] = None
+
+
+@dataclass
+class ShardResult:
+    """Outcome of one shard."""
+
+    frames: int
+    # (frame number, time code, message) of frames that failed to render
+    failed: List[Tuple[int, float, str]] = field(default_factory=list)
+
+
+def render_shard(job: ShardJob) -> ShardResult:
+    """
+    Render every frame of a shard in order with one compiled program.
+
+    Runs in a worker process. Frames go to the configured output files, or
+    as raw RGBA to the spool file, where a failed frame is written as
+    transparent black so later frames keep their offsets.
+
+    Args:
+        job: The shard to render
+
+    Returns:
+        Frame count and failures of the shard
+    """
+    config = job.shader_config
+    renderer = ShaderRenderer(ShaderRendererConfig())
+    result = ShardResult(len(config.times))
+    try:
+        session = renderer._specialized_session(job.shader_content, config)
+        if session is None:
+            session = renderer.session(job.shader_content, config)
+        width, height = config.width, config.height
+        with frame_pool().lease(width, height) as pixels:
+            spool = open(job.spool, "wb", buffering=0) if job.spool else None
+            try:
+                for i, time_code in enumerate(config.times):
+                    number = job.first_number + i
+                    try:
+                        if spool is not None:
+                            session.render_into(time_code, pixels)
+                        else:
+                            session.save_frame(time_code, Path(config.output % number))
+                    except RuntimeError as e:
+                        result.failed.append((number, time_code, _error_message(e)))
+                        pixels.fill(0)
+                    if spool is not None:
+                        spool.write(pixels.data)
+            finally:
+                if spool is not None:
+                    spool.close()
+        session.close()
+    finally:
+        renderer.cleanup()
+    return result
+
+
+@dataclass
+class ShardedRender:
+    """Outcome of a sharded render to files."""
+
+    frames: int
+    shards: int
+    rendered_shards: int
+    # Shards completed by an earlier run and skipped
+    resumed_shards: int
+    failed: List[Tuple[int, float, str]] = field(default_factory=list)
+    # Why the sequence was rendered as a single shard, if it was
+    serialized: Optional[str] = None
+    # Workers and rasterizer threads used, if the shards went to workers
+    layout: Optional[WorkerLayout] = None
+
+
+class ShardJournal:
+    """
+    Completed shards of a file render, kept next to the outputs.
+
+    The journal records the shard plan and which shards finished, under a
+    key of the shader, inputs, size, output template and time codes, so a
+    rerun of the same render skips the finished shards (after checking
+    their files still exist) while any change starts over. It is rewritten
+    atomically after every shard.
+    """
+
+    def __init__(self, path: Path, key: str):
+        self.path = Path(path)
+        self.key = key
+        self.plan: List[Shard] = []
+        self.done: set = set()
+
+    @classmethod
+    def for_render(cls, shader_content: str, config: ShaderConfig) -> "ShardJournal":
+        """The journal of a render, named after its key in the output directory."""
+        identity = {
+            "shader": canonical_hash(shader_content),
+            "inputs": config.inputs or {},
+            "audio": config.audio,
+            "video": config.video,
+            "size": [config.width, config.height],
+            "quality": config.quality,
+            "output": config.output,
+            "times": hashlib.sha256(repr(times_key(config.times)).encode("utf-8")).hexdigest(),
+        }
+        key = hashlib.sha256(canonical_json(identity).encode("utf-8")).hexdigest()
+        return cls(Path(config.output).parent / f".isf-shards-{key[:16]}.json", key)
+
+    def load(self) -> bool:
+        """Read a journal with a matching key; returns False if there is none."""
+        try:
+            with open(self.path, "r", encoding="utf-8") as f:
+                data = json.load(f)
+        except (OSError, ValueError):
+            return False
+        if data.get("version") != JOURNAL_VERSION or data.get("key") != self.key:
+            return False
+        self.plan = [Shard(i, begin, end) for i, (begin, end) in enumerate(data["plan"])]
+        self.done = set(data["done"])
+        return True
+
+    def save(self) -> None:
+        """Write the journal atomically."""
+        data = {
+            "version": JOURNAL_VERSION,
+            "key": self.key,
+            "plan": [[shard.begin, shard.end] for shard in self.plan],
+            "done": sorted(self.done),
+        }
+        self.path.parent.mkdir(parents=True, exist_ok=True)
+        temporary = self.path.with_name(self.path.name + ".tmp")
+        with open(temporary, "w", encoding="utf-8") as f:
+            json.dump(data, f)
+        os.replace(temporary, self.path)
+
+
+def _resolved(config: ShaderConfig, defaults: Optional[Defaults]) -> ShaderConfig:
+    """The configuration with size and quality filled in from the defaults."""
+    defaults = defaults or Defaults()
+    return replace(
+        config,
+        width=config.get_width(defaults),
+        height=config.get_height(defaults),
+        quality=config.get_quality(defaults),
+    )
+
+
+def _shard_job(shader_content: str, config: ShaderConfig, shard: Shard, spool: Optional[str] = None) -> ShardJob:
+    return ShardJob(
+        shader_content,
+        replace(config, times=config.times[shard.begin:shard.end]),
+        frame_number(config.times, shard.begin),
+        spool,
+    )
+
+
+def _layout(config: ShaderConfig, jobs: int, threads: Optional[int]) -> WorkerLayout:
+    return plan_layout(CpuTopology.detect(), config.width, config.height, jobs=jobs, threads=threads)
+
+
+def render_sharded(
+    shader_content: str,
+    shader_config: ShaderConfig,
+    jobs: int = 1,
+    defaults: Optional[Defaults] = None,
+    resume: bool = True,
+    refuse_stateful: bool = False,
+    progress: Optional[Callable[[int], None]] = None,
+    threads: Optional[int] = None,
+) -> ShardedRender:
+    """
+    Render one sequence to files, split into contiguous shards across workers.
+
+    Each worker compiles the shader once per shard and writes its frames
+    straight to their files (named by frame number), so no frame passes
+    through the parent. Stateful shaders (see stateful_reason) are rendered
+    as a single shard in order, as is a sequence whose output template has
+    no frame number.
+
+    Args:
+        shader_content: The ISF shader source code
+        shader_config: Configuration; output is a %-template for the frame number
+        jobs: Number of worker processes (1 renders in this process)
+        defaults: Size and quality for fields the configuration leaves unset
+        resume: Skip shards finished by an earlier identical run
+        refuse_stateful: Raise instead of serializing a stateful shader
+        progress: Called with the number of frames finished after each shard
+        threads: llvmpipe rasterizer threads per worker (default: balanced
+            against jobs and the frame size, see plan_layout)
+
+    Returns:
+        Shard and frame counts and the frames that failed
+
+    Raises:
+        ValueError: If the shader is stateful and refuse_stateful is set
+    """
+    config = _resolved(shader_config, defaults)
+    frame_count = len(config.times)
+    serialized = stateful_reason(shader_content)
+    if serialized and refuse_stateful:
+        raise ValueError(f"Cannot shard the render because {serialized}")
+    if serialized is None and "%" not in config.output and frame_count > 1:
+        serialized = "every frame is written to the same file"
+
+    journal = ShardJournal.for_render(shader_content, config)
+    if not (resume and journal.load()):
+        shards = 1 if serialized else max(jobs, 1) * SHARDS_PER_WORKER
+        journal.plan = plan_shards(frame_count, shards)
+        journal.done = set()
+    resumed = 0
+    for index in sorted(journal.done):
+        shard = journal.plan[index]
+        numbers = range(frame_number(config.times, shard.begin), frame_number(config.times, shard.begin) + len(shard))
+        if all(os.path.exists(config.output % n) for n in numbers):
+            resumed += 1
+            if progress:
+                progress(len(shard))
+        else:
+            journal.done.discard(index)
+    pending = [shard for shard in journal.plan if shard.index not in journal.done]
+    if resumed:
+        logger.info(f"Resuming: {resumed} of {len(journal.plan)} shards already rendered")
+
+    result = ShardedRender(frame_count, len(journal.plan), 0, resumed, serialized=serialized)
+
+    def finish(shard: Shard, shard_result: ShardResult) -> None:
+        result.rendered_shards += 1
+        result.failed.extend(shard_result.failed)
+        if not shard_result.failed:
+            journal.done.add(shard.index)
+            journal.save()
+        if progress:
+            progress(len(shard))
+
+    journal.save()
+    if jobs <= 1 or len(pending) <= 1:
+        for shard in pending:
+            finish(shard, render_shard(_shard_job(shader_content, config, shard)))
+    else:
+        result.layout = _layout(config, jobs, threads)
+        with worker_pool(result.layout) as executor:
+            futures: Dict[Future, Shard] = {
+                executor.submit(render_shard, _shard_job(shader_content, config, shard)): shard
+                for shard in pending
+            }
+            for future, shard in futures.items():
+                finish(shard, future.result())
+    result.failed.sort()
+    return result
+
+
+def iter_sharded(
+    shader_content: str,
+    shader_config: ShaderConfig,
+    jobs: int = 1,
+    defaults: Optional[Defaults] = None,
+    refuse_stateful: bool = False,
+    spool_dir: Optional[Path] = None,
+    threads: Optional[int] = None,
+) -> Iterator[Tuple[int, float, np.ndarray]]:
+    """
+    Render one sequence across workers and yield its frames in order.
+
+    Workers render short shards into raw RGBA spool files; the caller's
+    thread reads each shard's frames as soon as they are written, in frame
+    order, and deletes the file once it is consumed. Only a few shards per
+    worker are queued ahead of the consumer, so the spool stays small on a
+    long sequence. Stateful shaders (see stateful_reason) are rendered in
+    this process in order instead.
+
+    Args:
+        shader_content: The ISF shader source code
+        shader_config: Configuration (output is ignored)
+        jobs: Number of worker processes (1 renders in this process)
+        defaults: Size for fields the configuration leaves unset
+        refuse_stateful: Raise instead of serializing a stateful shader
+        spool_dir: Directory for spool files (default: a temporary directory)
+        threads: llvmpipe rasterizer threads per worker (default: balanced
+            against jobs and the frame size, see plan_layout)
+
+    Yields:
+        (frame number, time code, pixels) where pixels is a read-only
+        (height, width, 4) uint8 view reused for the next frame
+
+    Raises:
+        ValueError: If the shader is stateful and refuse_stateful is set
+        RuntimeError: If the shader fails to compile
+    """
+    config = _resolved(shader_config, defaults)
+    serialized = stateful_reason(shader_content)
+    if serialized and refuse_stateful:
+        raise ValueError(f"Cannot shard the render because {serialized}")
+    if serialized or jobs <= 1:
+        yield from _iter_serial(shader_content, config)
+        return
+
+    shards = plan_shards(len(config.times), -(-len(config.times) // STREAM_SHARD_FRAMES))
+    with tempfile.TemporaryDirectory(prefix="isf-shards-", dir=spool_dir) as directory, \
+            frame_pool().lease(config.width, config.height) as pixels, \
+            worker_pool(_layout(config, jobs, threads)) as executor:
+        frame_bytes = pixels.nbytes
+        futures: Dict[int, Future] = {}
+        try:
+            for shard in shards:
+                # Keep the window of queued shards full
+                for ahead in shards[shard.index:shard.index + jobs * STREAM_SHARDS_AHEAD]:
+                    if ahead.index not in futures:
+                        spool = os.path.join(directory, f"{ahead.index:08d}.rgba")
+                        futures[ahead.index] = executor.submit(
+                            render_shard, _shard_job(shader_content, config, ahead, spool)
+                        )
+                future = futures.pop(shard.index)
+                spool = os.path.join(directory, f"{shard.index:08d}.rgba")
+                yield from _read_spool(spool, future, shard, config, pixels, frame_bytes)
+                os.unlink(spool)
+        finally:
+            for future in futures.values():
+                future.cancel()
+
+
+def _iter_serial(shader_content: str, config: ShaderConfig) -> Iterator[Tuple[int, float, np.ndarray]]:
+    """Render every frame in this process with one program, in order."""
+    renderer = ShaderRenderer(ShaderRendererConfig())
+    try:
+        with renderer.session(shader_content, config) as session, \
+                frame_pool().lease(config.width, config.height) as pixels:
+            view = pixels.view()
+            view.flags.writeable = False
+            for i, time_code in enumerate(config.times):
+                session.render_into(time_code, pixels)
+                yield frame_number(config.times, i), time_code, view
+    finally:
+        renderer.cleanup()
+
+
+def _read_spool(
+    spool: str,
+    future: Future,
+    shard: Shard,
+    config: ShaderConfig,
+    pixels: np.ndarray,
+    frame_bytes: int,
+) -> Iterator[Tuple[int, float, np.ndarray]]:
+    """Yield a shard's frames from its spool file as the worker writes them."""
+    view = pixels.view()
+    view.flags.writeable = False
+    target = memoryview(pixels.reshape(-1))
+    handle = None
+    try:
+        for i in range(len(shard)):
+            while True:
+                if handle is None and os.path.exists(spool):
+                    handle = open(spool, "rb", buffering=0)
+                if handle is not None and os.fstat(handle.fileno()).st_size >= (i + 1) * frame_bytes:
+                    break
+                if future.done():
+                    # Raises the worker's error; a finished shard has all its frames
+                    future.result()
+                    if handle is None:
+                        handle = open(spool, "rb", buffering=0)
+                    break
+                time.sleep(SPOOL_POLL_SECONDS)
+            read = 0
+            while read < frame_bytes:
+                count = handle.readinto(target[read:])
+                if not count:
+                    raise RuntimeError(f"Shard {shard.index} ended after {i} of {len(shard)} frames")
+                read += count
+            position = shard.begin + i
+            yield frame_number(config.times, position), config.times[position], view
+        failed = future.result().failed
+        if failed:
+            logger.warning(f"{len(failed)} frame(s) of shard {shard.index} failed and were streamed blank")
+    finally:
+        if handle is not None:
+            handle.close()
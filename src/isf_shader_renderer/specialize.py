@@ -0,0 +1,171 @@
+"""Specialization of fixed ISF inputs into compile-time constants."""
+
+import hashlib
+import json
+import re
+from typing import Any, Dict, List, Optional, Tuple
+
+# ISF input types that can be baked into the program, with their GLSL type
+SPECIALIZABLE_TYPES = {
+    "float": "float",
+    "bool": "bool",
+    "event": "bool",
+    "long": "int",
+    "point2D": "vec2",
+    "color": "vec4",
+}
+
+_TRUE_STRINGS = ("true", "1", "yes", "on")
+_FALSE_STRINGS = ("false", "0", "no", "off")
+
+
+def split_isf_source(shader_content: str) -> Tuple[Optional[Dict[str, Any]], str, str]:
+    """
+    Split an ISF shader into its JSON header and GLSL body.
+
+    Args:
+        shader_content: The ISF shader source code
+
+    Returns:
+        (metadata, header_text, body). metadata is None and header_text is
+        empty when the shader has no parseable JSON header comment.
+    """
+    stripped = shader_content.lstrip()
+    if not stripped.startswith("/*"):
+        return None, "", shader_content
+    start = shader_content.index("/*")
+    end = shader_content.find("*/", start + 2)
+    if end == -1:
+        return None, "", shader_content
+    try:
+        metadata = json.loads(shader_content[start + 2:end])
+    except json.JSONDecodeError:
+        return None, "", shader_content
+    if not isinstance(metadata, dict):
+        return None, "", shader_content
+    return metadata, shader_content[:end + 2], shader_content[end + 2:]
+
+
+def _parse_numbers(value: Any) -> List[float]:
+    """Turn a tuple/list or a "a,b" / "a b" string into floats."""
+    if isinstance(value, str):
+        return [float(part) for part in value.replace(" ", ",").split(",") if part]
+    if isinstance(value, (list, tuple)):
+        return [float(part) for part in value]
+    return [float(value)]
+
+
+def _float_literal(value: float) -> str:
+    """Format a float as a GLSL literal (always with a decimal point)."""
+    text = repr(float(value))
+    if text in ("inf", "-inf", "nan"):
+        raise ValueError(f"Cannot bake non-finite value {text}")
+    return text if ("." in text or "e" in text) else text + ".0"
+
+
+def glsl_constant(input_type: str, value: Any) -> Tuple[str, str]:
+    """
+    Convert an input value to a GLSL type and literal.
+
+    Values are accepted in the same forms as renderer inputs: Python
+    primitives, tuples, or CLI strings such as "true", "2" or "0.5,0.5".
+
+    Args:
+        input_type: ISF input TYPE
+        value: Input value
+
+    Returns:
+        (glsl_type, literal)
+    """
+    glsl_type = SPECIALIZABLE_TYPES[input_type]
+    if glsl_type == "bool":
+        if isinstance(value, str):
+            lowered = value.strip().lower()
+            if lowered not in _TRUE_STRINGS + _FALSE_STRINGS:
+                raise ValueError(f"Invalid boolean value: {value!r}")
+            flag = lowered in _TRUE_STRINGS
+        else:
+            flag = bool(value)
+        return glsl_type, "true" if flag else "false"
+    numbers = _parse_numbers(value)
+    if glsl_type == "int":
+        if len(numbers) != 1 or numbers[0] != int(numbers[0]):
+            raise ValueError(f"Invalid long value: {value!r}")
+        return glsl_type, str(int(numbers[0]))
+    if glsl_type == "float":
+        if len(numbers) != 1:
+            raise ValueError(f"Invalid float value: {value!r}")
+        return glsl_type, _float_literal(numbers[0])
+    size = 2 if glsl_type == "vec2" else 4
+    if glsl_type == "vec4" and len(numbers) == 3:
+        numbers.append(1.0)
+    if len(numbers) != size:
+        raise ValueError(f"Expected {size} components for {input_type}, got {value!r}")
+    return glsl_type, f"{glsl_type}({', '.join(_float_literal(n) for n in numbers)})"
+
+
+def specialize_shader(shader_content: str, inputs: Dict[str, Any]) -> Tuple[str, Dict[str, Any]]:
+    """
+    Bake fixed input values into the shader as constants.
+
+    Each specialized input is removed from the JSON header (so no uniform
+    is declared for it) and re-declared as a ``const`` at the top of the
+    GLSL body, which lets the GLSL compiler fold it and drop dead branches.
+    Inputs of other types (images, audio), inputs referenced by PASSES size
+    expressions, and values that cannot be converted stay uniforms.
+
+    Args:
+        shader_content: The ISF shader source code
+        inputs: Fixed input values by name
+
+    Returns:
+        (specialized_source, remaining_inputs) where remaining_inputs must
+        still be set as uniforms. The source is unchanged if nothing could
+        be specialized.
+    """
+    metadata, _, body = split_isf_source(shader_content)
+    if metadata is None or not inputs:
+        return shader_content, dict(inputs)
+
+    pass_expressions = json.dumps(metadata.get("PASSES", []))
+    declarations = []
+    baked = set()
+    for definition in metadata.get("INPUTS", []):
+        name = definition.get("NAME")
+        input_type = definition.get("TYPE")
+        if name not in inputs or input_type not in SPECIALIZABLE_TYPES:
+            continue
+        if re.search(r"\$" + re.escape(name) + r"\b", pass_expressions):
+            continue
+        try:
+            glsl_type, literal = glsl_constant(input_type, inputs[name])
+        except (TypeError, ValueError):
+            continue
+        declarations.append(f"const {glsl_type} {name} = {literal};")
+        baked.add(name)
+
+    if not baked:
+        return shader_content, dict(inputs)
+
+    specialized = dict(metadata)
+    specialized["INPUTS"] = [d for d in metadata.get("INPUTS", []) if d.get("NAME") not in baked]
+    header = "/*" + json.dumps(specialized, indent=4) + "*/\n"
+
+    # Constants go after any #version line, which must stay first in the body
+    lines = body.split("\n")
+    insert_at = next((i + 1 for i, line in enumerate(lines) if line.strip().startswith("#version")), 0)
+    lines[insert_at:insert_at] = ["// Specialized inputs"] + declarations
+    remaining = {name: value for name, value in inputs.items() if name not in baked}
+    return header + "\n".join(lines), remaining
+
+
+def _key_value(value: Any) -> str:
+    """Serialize an input value for a key; image bytes are hashed, not embedded."""
+    if isinstance(value, (bytes, bytearray, memoryview)):
+        return "sha256:" + hashlib.sha256(bytes(value)).hexdigest()
+    return json.dumps(value, sort_keys=True, default=str)
+
+
+def specialization_key(inputs: Dict[str, Any]) -> Tuple[Tuple[str, str], ...]:
+    """Hashable key for an input tuple (order-independent)."""
+    return tuple(sorted((name, _key_value(value)) for name, value in inputs.items()))
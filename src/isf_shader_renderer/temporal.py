@@ -0,0 +1,315 @@
+"""Temporal analysis of animated shaders from low-resolution probe sequences."""
+
+from dataclasses import asdict, dataclass, field
+from typing import Any, Dict, Iterable, List, Optional, Sequence, Tuple
+
+import numpy as np
+
+from .buffers import frame_pool
+from .config import ShaderConfig
+from .fingerprint import difference_hash, downsample, format_hash, to_luminance
+from .renderer import ShaderRenderer
+
+# Probe frames are rendered small and reduced to a coarse luminance grid
+DEFAULT_PROBE_SIZE = (64, 36)
+DEFAULT_SAMPLES = 128
+FEATURE_SIZE = (32, 18)
+
+# Mean absolute luminance change (0..1) below which two probes count as identical
+STATIC_THRESHOLD = 0.002
+
+# A lag is a loop period when frames that far apart differ by at most this
+# fraction of the largest difference seen at any lag
+LOOP_RATIO = 0.2
+
+
+@dataclass
+class SequenceAnalysis:
+    """Result of analyzing a probe sequence."""
+
+    times: List[float]
+    frame_hashes: List[str]
+    motion_energy: List[float]
+    max_motion: float = 0.0
+    max_motion_time: Optional[float] = None
+    static_segments: List[Tuple[float, float]] = field(default_factory=list)
+    is_static: bool = False
+    loop_period: Optional[float] = None
+    loop_error: Optional[float] = None
+    suggested_time_codes: List[float] = field(default_factory=list)
+
+    def to_dict(self) -> Dict[str, Any]:
+        """Convert to a JSON-serializable dictionary."""
+        data = asdict(self)
+        data["static_segments"] = [list(segment) for segment in self.static_segments]
+        return data
+
+    def summary(self) -> str:
+        """Describe the animation in one or two sentences."""
+        if self.is_static:
+            return "Shader output is static over the probed time range."
+        parts = []
+        if self.loop_period is not None:
+            parts.append(f"Animation loops every {self.loop_period:.2f}s")
+        else:
+            parts.append("No loop period detected in the probed time range")
+        if self.max_motion_time is not None:
+            parts.append(f"maximum motion around t={self.max_motion_time:.2f}s")
+        if self.static_segments:
+            parts.append(f"{len(self.static_segments)} static segment(s)")
+        return ", ".join(parts) + "."
+
+
+def probe_times(start_time: float, end_time: float, samples: int) -> List[float]:
+    """
+    Generate evenly spaced probe time codes, inclusive of both ends.
+
+    Args:
+        start_time: First time code in seconds
+        end_time: Last time code in seconds
+        samples: Number of time codes (at least 2)
+
+    Returns:
+        List of time codes
+    """
+    if samples < 2:
+        raise ValueError("At least 2 probe samples are required")
+    if end_time <= start_time:
+        raise ValueError("end_time must be greater than start_time")
+    step = (end_time - start_time) / (samples - 1)
+    return [start_time + i * step for i in range(samples)]
+
+
+def frame_features(pixels: np.ndarray) -> np.ndarray:
+    """Reduce a frame to the coarse luminance grid used for comparisons."""
+    luma = to_luminance(pixels)
+    height, width = luma.shape
+    size = (min(FEATURE_SIZE[0], width), min(FEATURE_SIZE[1], height))
+    return downsample(luma, size).ravel()
+
+
+def analyze_frames(
+    frames: Iterable[np.ndarray],
+    times: Sequence[float],
+    suggestions: int = 4,
+) -> SequenceAnalysis:
+    """
+    Analyze a sequence of probe frames.
+
+    Frames are reduced to features as they arrive, so a generator of frames is
+    consumed without keeping the full sequence in memory.
+
+    Args:
+        frames: Probe frames in time order
+        times: Time code of each frame (evenly spaced)
+        suggestions: Number of informative time codes to suggest
+
+    Returns:
+        SequenceAnalysis for the sequence
+    """
+    features = []
+    hashes = []
+    for pixels in frames:
+        features.append(frame_features(pixels))
+        hashes.append(format_hash(difference_hash(pixels)))
+    if len(features) != len(times):
+        raise ValueError("Number of frames does not match number of time codes")
+    if len(features) < 2:
+        raise ValueError("At least 2 frames are required for temporal analysis")
+
+    times = [float(t) for t in times]
+    stacked = np.stack(features)
+    energy = np.abs(np.diff(stacked, axis=0)).mean(axis=1)
+
+    analysis = SequenceAnalysis(
+        times=times,
+        frame_hashes=hashes,
+        motion_energy=[round(float(e), 6) for e in energy],
+    )
+    if float(energy.max()) < STATIC_THRESHOLD:
+        analysis.is_static = True
+        analysis.static_segments = [(times[0], times[-1])]
+        analysis.suggested_time_codes = [times[0]]
+        return analysis
+
+    peak = int(np.argmax(energy))
+    analysis.max_motion = round(float(energy[peak]), 6)
+    analysis.max_motion_time = round((times[peak] + times[peak + 1]) / 2.0, 6)
+    analysis.static_segments = _static_segments(energy, times)
+
+    period_lag, loop_error = _detect_loop_lag(stacked)
+    if period_lag is not None:
+        step = (times[-1] - times[0]) / (len(times) - 1)
+        analysis.loop_period = round(period_lag * step, 4)
+        analysis.loop_error = round(loop_error, 6)
+
+    analysis.suggested_time_codes = _suggest_time_codes(analysis, suggestions)
+    return analysis
+
+
+def _static_segments(energy: np.ndarray, times: Sequence[float]) -> List[Tuple[float, float]]:
+    """Find runs of at least two consecutive motionless intervals."""
+    still = np.concatenate([[False], energy < STATIC_THRESHOLD, [False]])
+    edges = np.flatnonzero(np.diff(still.astype(np.int8)))
+    segments = []
+    for begin, end in zip(edges[::2], edges[1::2]):
+        if end - begin >= 2:
+            segments.append((times[begin], times[end]))
+    return segments
+
+
+def _detect_loop_lag(features: np.ndarray) -> Tuple[Optional[float], float]:
+    """
+    Find the shortest lag (in probe steps) at which the sequence repeats.
+
+    Returns:
+        (fractional lag, mean difference at that lag), or (None, 0.0)
+    """
+    count = len(features)
+    max_lag = count // 2
+    if max_lag < 3:
+        return None, 0.0
+    distances = np.array(
+        [np.abs(features[lag:] - features[:-lag]).mean() for lag in range(1, max_lag + 1)]
+    )
+    limit = LOOP_RATIO * float(distances.max())
+    for index in range(1, max_lag - 1):
+        value = distances[index]
+        if value > limit or value > distances[index - 1] or value > distances[index + 1]:
+            continue
+        # The sequence must actually diverge before it comes back
+        if float(distances[:index].max()) < 2.0 * value:
+            continue
+        # Parabolic interpolation of the minimum between probe samples
+        before, after = distances[index - 1], distances[index + 1]
+        curvature = before - 2.0 * value + after
+        offset = 0.5 * (before - after) / curvature if curvature > 0 else 0.0
+        return index + 1 + float(np.clip(offset, -0.5, 0.5)), float(value)
+    return None, 0.0
+
+
+def _suggest_time_codes(analysis: SequenceAnalysis, count: int) -> List[float]:
+    """Pick evenly spaced moving time codes, always including peak motion."""
+    times = analysis.times
+    window_end = times[-1]
+    if analysis.loop_period is not None:
+        window_end = times[0] + analysis.loop_period
+    candidates = [
+        t for t in times
+        if t < window_end + 1e-9
+        and not any(begin < t <= end for begin, end in analysis.static_segments)
+    ] or [times[0]]
+    if count >= len(candidates):
+        chosen = list(candidates)
+    else:
+        picks = np.linspace(0, len(candidates) - 1, count).round().astype(int)
+        chosen = [candidates[i] for i in picks]
+    peak = analysis.max_motion_time
+    if peak is not None and analysis.loop_period is not None:
+        # The same motion recurs in every period; fold it into the first one
+        peak = times[0] + (peak - times[0]) % analysis.loop_period
+    if peak is not None and peak < window_end and chosen:
+        nearest = min(range(len(chosen)), key=lambda i: abs(chosen[i] - peak))
+        chosen[nearest] = peak
+    return sorted(round(t, 6) for t in set(chosen))
+
+
+def select_distinct_frames(features: np.ndarray, count: int) -> List[int]:
+    """
+    Pick up to count mutually distinct frames by farthest-point sampling.
+
+    The first pick is the frame farthest from the mean frame; each further pick
+    maximizes its distance to the closest frame already chosen. Selection stops
+    early once every remaining frame is a near-duplicate of a chosen one, so a
+    static shader yields a single frame.
+
+    Args:
+        features: (frames, features) array from frame_features
+        count: Maximum number of frames to pick
+
+    Returns:
+        Sorted indices of the chosen frames
+    """
+    if len(features) == 0 or count < 1:
+        return []
+    first = int(np.argmax(np.abs(features - features.mean(axis=0)).mean(axis=1)))
+    chosen = [first]
+    nearest = np.abs(features - features[first]).mean(axis=1)
+    while len(chosen) < count:
+        candidate = int(np.argmax(nearest))
+        if float(nearest[candidate]) < STATIC_THRESHOLD:
+            break
+        chosen.append(candidate)
+        np.minimum(nearest, np.abs(features - features[candidate]).mean(axis=1), out=nearest)
+    return sorted(chosen)
+
+
+def select_keyframes(
+    renderer: ShaderRenderer,
+    shader_content: str,
+    count: int,
+    start_time: float = 0.0,
+    end_time: float = 10.0,
+    samples: int = 64,
+    probe_size: Tuple[int, int] = DEFAULT_PROBE_SIZE,
+    shader_config: Optional[ShaderConfig] = None,
+) -> List[float]:
+    """
+    Choose the count most visually distinct time codes in a time range.
+
+    Args:
+        renderer: Renderer used to compile and render the probe frames
+        shader_content: The ISF shader source code
+        count: Number of keyframes wanted
+        start_time: Start of the time range in seconds
+        end_time: End of the time range in seconds
+        samples: Number of low-resolution probe frames
+        probe_size: Probe (width, height)
+        shader_config: Optional shader configuration (inputs)
+
+    Returns:
+        Sorted keyframe time codes (fewer than count if the shader has fewer
+        distinct looks in the range)
+    """
+    times = probe_times(start_time, end_time, max(samples, count, 2))
+    width, height = probe_size
+    with renderer.session(shader_content, shader_config) as session, frame_pool().lease(width, height) as pixels:
+        features = np.stack([frame_features(session.render_array(t, out=pixels)) for t in times])
+    return [round(times[i], 6) for i in select_distinct_frames(features, count)]
+
+
+def analyze_sequence(
+    renderer: ShaderRenderer,
+    shader_content: str,
+    start_time: float = 0.0,
+    end_time: float = 20.0,
+    samples: int = DEFAULT_SAMPLES,
+    probe_size: Tuple[int, int] = DEFAULT_PROBE_SIZE,
+    shader_config: Optional[ShaderConfig] = None,
+    suggestions: int = 4,
+) -> SequenceAnalysis:
+    """
+    Render a low-resolution probe sequence and analyze its motion.
+
+    The shader is compiled once and every probe is rendered at probe_size,
+    so the cost is a small fraction of rendering the same times at full size.
+
+    Args:
+        renderer: Renderer used to compile and render the shader
+        shader_content: The ISF shader source code
+        start_time: First probe time in seconds
+        end_time: Last probe time in seconds
+        samples: Number of probe frames
+        probe_size: Probe (width, height)
+        shader_config: Optional shader configuration (inputs)
+        suggestions: Number of informative time codes to suggest
+
+    Returns:
+        SequenceAnalysis for the probe sequence
+    """
+    times = probe_times(start_time, end_time, samples)
+    width, height = probe_size
+    with renderer.session(shader_content, shader_config) as session, frame_pool().lease(width, height) as pixels:
+        # Each probe is reduced to features before the next overwrites the buffer
+        frames = (session.render_array(t, out=pixels) for t in times)
+        return analyze_frames(frames, times, suggestions)
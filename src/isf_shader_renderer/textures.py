@@ -0,0 +1,224 @@
+"""Decoded texture cache for ISF image inputs."""
+
+import base64
+import hashlib
+import logging
+import os
+import tempfile
+import threading
+from collections import OrderedDict
+from io import BytesIO
+from pathlib import Path
+from typing import Any, Dict, Optional, Tuple, Union
+
+import numpy as np
+from PIL import Image
+
+logger = logging.getLogger(__name__)
+
+# Environment variable overriding where decoded textures are stored
+TEXTURE_CACHE_ENV = "ISF_TEXTURE_CACHE"
+
+# Decoded textures kept mapped in this process, evicted least recently used first
+TEXTURE_CACHE_SIZE = 32
+
+# File digests remembered by (path, mtime, size), evicted least recently used first
+PATH_DIGEST_CACHE_SIZE = 1024
+
+# Bytes of decoded textures kept in the cache directory; least recently used files are removed beyond it
+TEXTURE_DISK_CACHE_BYTES = 2 << 30
+
+# String input values with these suffixes are treated as image files
+IMAGE_SUFFIXES = (".png", ".jpg", ".jpeg", ".bmp", ".gif", ".tif", ".tiff", ".webp", ".tga")
+
+ImageSource = Union[str, Path, bytes, bytearray, memoryview]
+
+
+def default_cache_dir() -> Path:
+    """Return the directory shared by all processes for decoded textures."""
+    configured = os.environ.get(TEXTURE_CACHE_ENV)
+    if configured:
+        return Path(configured)
+    return Path(tempfile.gettempdir()) / "isf-shader-renderer" / "textures"
+
+
+def is_image_value(value: Any) -> bool:
+    """Whether an input value refers to an image (bytes, data URL or image path)."""
+    if isinstance(value, (bytes, bytearray, memoryview, Path)):
+        return True
+    if isinstance(value, str):
+        return value.startswith("data:image/") or value.lower().endswith(IMAGE_SUFFIXES)
+    return False
+
+
+def decode_image(data: bytes) -> np.ndarray:
+    """Decode an encoded image (PNG, JPEG, ...) to an RGBA uint8 array."""
+    with Image.open(BytesIO(data)) as image:
+        return np.ascontiguousarray(np.asarray(image.convert("RGBA")))
+
+
+class TextureCache:
+    """
+    Content-addressed cache of decoded RGBA textures.
+
+    Textures are keyed by the SHA-256 of their encoded bytes, so the same
+    image supplied as a path, raw bytes or a data URL is decoded once. Each
+    decoded texture is written to the cache directory as a .npy file and
+    memory-mapped read-only: worker processes map the same file (and share
+    the page cache) instead of each decoding a 4K texture again. Files used
+    least recently are removed once the directory holds more than
+    max_disk_bytes.
+
+    A cache may be shared by threads (a session's render thread and its
+    caller); lookups and stores are serialised by a lock.
+    """
+
+    def __init__(
+        self,
+        cache_dir: Optional[Path] = None,
+        max_size: int = TEXTURE_CACHE_SIZE,
+        max_disk_bytes: int = TEXTURE_DISK_CACHE_BYTES,
+    ):
+        self.cache_dir = Path(cache_dir) if cache_dir is not None else default_cache_dir()
+        self.max_size = max_size
+        self.max_disk_bytes = max_disk_bytes
+        self._textures: "OrderedDict[str, np.ndarray]" = OrderedDict()
+        # (path, mtime_ns, size) -> digest, so unchanged files are not re-read every frame
+        self._path_digests: "OrderedDict[Tuple[str, int, int], str]" = OrderedDict()
+        self._lock = threading.Lock()
+        self.decodes = 0
+        self.hits = 0
+
+    def __len__(self) -> int:
+        return len(self._textures)
+
+    def load(self, source: ImageSource) -> np.ndarray:
+        """
+        Return the decoded texture of an image.
+
+        Args:
+            source: Image file path, encoded bytes, or a base64 data: URL
+
+        Returns:
+            Read-only (height, width, 4) uint8 array
+        """
+        with self._lock:
+            return self._load(source)
+
+    def _load(self, source: ImageSource) -> np.ndarray:
+        data: Optional[bytes] = None
+        if isinstance(source, (bytes, bytearray, memoryview)):
+            data = bytes(source)
+            digest = hashlib.sha256(data).hexdigest()
+        elif isinstance(source, str) and source.startswith("data:"):
+            data = base64.b64decode(source.split(",", 1)[1])
+            digest = hashlib.sha256(data).hexdigest()
+        else:
+            path = Path(source).expanduser()
+            stat = path.stat()
+            path_key = (str(path.resolve()), stat.st_mtime_ns, stat.st_size)
+            digest = self._path_digests.get(path_key)
+            if digest is None:
+                data = path.read_bytes()
+                digest = hashlib.sha256(data).hexdigest()
+                self._path_digests[path_key] = digest
+                while len(self._path_digests) > PATH_DIGEST_CACHE_SIZE:
+                    self._path_digests.popitem(last=False)
+            else:
+                self._path_digests.move_to_end(path_key)
+
+        texture = self._textures.get(digest)
+        if texture is not None:
+            self._textures.move_to_end(digest)
+            self.hits += 1
+            return texture
+
+        texture = self._load_shared(digest)
+        if texture is None:
+            if data is None:
+                data = Path(source).expanduser().read_bytes()
+            texture = decode_image(data)
+            self.decodes += 1
+            texture = self._store_shared(digest, texture)
+        texture.flags.writeable = False
+        self._textures[digest] = texture
+        while len(self._textures) > self.max_size:
+            self._textures.popitem(last=False)
+        return texture
+
+    def _load_shared(self, digest: str) -> Optional[np.ndarray]:
+        """Map a texture decoded by this or another process, if present."""
+        path = self.cache_dir / f"{digest}.npy"
+        try:
+            texture = np.load(path, mmap_mode="r")
+        except (OSError, ValueError):
+            return None
+        try:
+            # The modification time orders files for pruning
+            os.utime(path)
+        except OSError:
+            pass
+        return texture
+
+    def _store_shared(self, digest: str, texture: np.ndarray) -> np.ndarray:
+        """Write a decoded texture atomically and return its mapping."""
+        try:
+            self.cache_dir.mkdir(parents=True, exist_ok=True)
+            fd, tmp_path = tempfile.mkstemp(dir=self.cache_dir, prefix=".texture-", suffix=".npy")
+            try:
+                with os.fdopen(fd, "wb") as f:
+                    np.save(f, texture)
+                os.replace(tmp_path, self.cache_dir / f"{digest}.npy")
+            except Exception:
+                os.unlink(tmp_path)
+                raise
+        except OSError as e:
+            # Without a writable cache directory the texture is only cached in memory
+            logger.warning(f"Could not store decoded texture in {self.cache_dir}: {e}")
+            return texture
+        self._prune_shared(keep=f"{digest}.npy")
+        return np.load(self.cache_dir / f"{digest}.npy", mmap_mode="r")
+
+    def _prune_shared(self, keep: str) -> None:
+        """Remove the least recently used files beyond max_disk_bytes; mappings already open stay valid."""
+        files = []
+        for path in self.cache_dir.glob("*.npy"):
+            try:
+                stat = path.stat()
+            except OSError:
+                continue
+            files.append((stat.st_mtime_ns, stat.st_size, path))
+        total = sum(size for _, size, _ in files)
+        for _, size, path in sorted(files):
+            if total <= self.max_disk_bytes:
+                break
+            if path.name == keep:
+                continue
+            try:
+                path.unlink()
+                total -= size
+            except OSError:
+                pass
+
+    def stats(self) -> Dict[str, int]:
+        """Return cache counters."""
+        return {"size": len(self._textures), "hits": self.hits, "decodes": self.decodes}
+
+    def clear(self) -> None:
+        """Drop the in-process mappings (files in the cache directory are kept)."""
+        with self._lock:
+            self._textures.clear()
+            self._path_digests.clear()
+
+
+_shared_cache: Optional[TextureCache] = None
+_shared_cache_lock = threading.Lock()
+
+
+def texture_cache() -> TextureCache:
+    """Return the process-wide texture cache shared by every renderer."""
+    global _shared_cache
+    with _shared_cache_lock:
+        if _shared_cache is None:
+            _shared_cache = TextureCache()
+        return _shared_cache
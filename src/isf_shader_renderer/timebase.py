@@ -0,0 +1,215 @@
+"""Lazily evaluated time code sequences on an exact rational timebase."""
+
+import math
+from fractions import Fraction
+from typing import Any, Dict, Hashable, Iterator, Optional, Sequence, Union, overload
+
+# A rate or time given as a number or a string such as "30000/1001" or "29.97"
+Rational = Union[int, float, str, Fraction]
+
+
+def parse_rational(value: Rational) -> Fraction:
+    """
+    Convert a number or a "num/den" string to an exact fraction.
+
+    Floats are read as the decimal they print as, so 0.1 is 1/10 rather
+    than the nearest binary double.
+
+    Raises:
+        ValueError: If the value is not a finite number or fraction
+    """
+    if isinstance(value, Fraction):
+        return value
+    if isinstance(value, bool):
+        raise ValueError(f"Invalid rational value: {value!r}")
+    if isinstance(value, int):
+        return Fraction(value)
+    if isinstance(value, float):
+        if not math.isfinite(value):
+            raise ValueError(f"Invalid rational value: {value!r}")
+        return Fraction(repr(value))
+    try:
+        return Fraction(str(value).strip())
+    except (ValueError, ZeroDivisionError):
+        raise ValueError(f"Invalid rational value: {value!r}")
+
+
+def parse_rate(value: Rational) -> Fraction:
+    """
+    Parse a frame rate such as 30, 29.97 or "30000/1001".
+
+    Raises:
+        ValueError: If the rate is not a positive number or fraction
+    """
+    rate = parse_rational(value)
+    if rate <= 0:
+        raise ValueError("fps must be positive")
+    return rate
+
+
+def _plain(value: Fraction) -> Union[int, float, str]:
+    """A fraction as an int, an exact float, or a "num/den" string."""
+    if value.denominator == 1:
+        return value.numerator
+    as_float = float(value)
+    return as_float if Fraction(repr(as_float)) == value else f"{value.numerator}/{value.denominator}"
+
+
+class TimeRange(Sequence[float]):
+    """
+    Frames first .. first+count-1 of a timebase with TIME = start + frame / fps.
+
+    start and fps are exact fractions (fps may be NTSC 30000/1001), and
+    each time code is computed from its frame number in integer arithmetic
+    and rounded to a float once, so frame k has the same TIME no matter
+    how the range was sliced or which worker renders it. A million-frame
+    job costs a few numbers instead of a million floats; slicing with step
+    1 stays lazy.
+    """
+
+    __slots__ = ("start", "fps", "count", "first", "_num", "_step", "_den")
+
+    def __init__(
+        self,
+        start: Rational = 0,
+        end: Optional[Rational] = None,
+        fps: Rational = 30,
+        count: Optional[int] = None,
+        first: int = 0,
+    ):
+        """
+        Args:
+            start: Time of frame 0 in seconds
+            end: End of the timebase in seconds (exclusive); ignored if count is given
+            fps: Frames per second, e.g. 30, 29.97 or "30000/1001"
+            count: Number of frames
+            first: Frame number of the first element
+        """
+        self.start = parse_rational(start)
+        self.fps = parse_rate(fps)
+        if first < 0:
+            raise ValueError("First frame must not be negative")
+        if count is None:
+            if end is None:
+                raise ValueError("A time range needs an end or a frame count")
+            # Frames whose time is before end, counted exactly
+            count = max(math.ceil((parse_rational(end) - self.start) * self.fps) - first, 0)
+        if count < 0:
+            raise ValueError("Frame count must not be negative")
+        self.count = int(count)
+        self.first = int(first)
+        # TIME(frame) = (_num + frame * _step) / _den with start = a/b, fps = n/d:
+        # a/b + frame*d/n = (a*n + frame*d*b) / (b*n); int / int rounds correctly
+        a, b = self.start.numerator, self.start.denominator
+        n, d = self.fps.numerator, self.fps.denominator
+        self._num, self._step, self._den = a * n, d * b, b * n
+
+    @property
+    def end(self) -> float:
+        """Exclusive end time of the range."""
+        return self.time_of(self.first + self.count)
+
+    @property
+    def frame_numbers(self) -> range:
+        """Frame numbers of the elements, in order."""
+        return range(self.first, self.first + self.count)
+
+    def time_of(self, frame: int) -> float:
+        """TIME of a frame number of this timebase (not an element index)."""
+        return (self._num + frame * self._step) / self._den
+
+    def exact_time_of(self, frame: int) -> Fraction:
+        """TIME of a frame number as an exact fraction."""
+        return self.start + frame / self.fps
+
+    def __len__(self) -> int:
+        return self.count
+
+    @overload
+    def __getitem__(self, index: int) -> float: ...
+
+    @overload
+    def __getitem__(self, index: slice) -> Sequence[float]: ...
+
+    def __getitem__(self, index: Union[int, slice]) -> Union[float, Sequence[float]]:
+        if isinstance(index, slice):
+            begin, stop, step = index.indices(self.count)
+            if step != 1:
+                return [self[i] for i in range(begin, stop, step)]
+            return TimeRange(self.start, fps=self.fps, count=max(stop - begin, 0), first=self.first + begin)
+        if index < 0:
+            index += self.count
+        if not 0 <= index < self.count:
+            raise IndexError("TimeRange index out of range")
+        return self.time_of(self.first + index)
+
+    def __iter__(self) -> Iterator[float]:
+        num, step, den = self._num, self._step, self._den
+        for frame in range(self.first, self.first + self.count):
+            yield (num + frame * step) / den
+
+    def __eq__(self, other: Any) -> bool:
+        if isinstance(other, TimeRange):
+            return self.key == other.key
+        if isinstance(other, (list, tuple)):
+            return len(other) == self.count and all(a == b for a, b in zip(self, other))
+        return NotImplemented
+
+    def __hash__(self) -> int:
+        return hash(self.key)
+
+    def __repr__(self) -> str:
+        return f"TimeRange(start={self.start}, fps={self.fps}, count={self.count}, first={self.first})"
+
+    @property
+    def key(self) -> Hashable:
+        """Hashable identity of the range."""
+        return ("range", self.start, self.fps, self.first, self.count)
+
+    def to_dict(self) -> Dict[str, Any]:
+        """Manifest form of the range, exact for rational rates."""
+        data = {"start": _plain(self.start), "fps": _plain(self.fps), "count": self.count}
+        if self.first:
+            data["first"] = self.first
+        return data
+
+
+def frame_number(times: Sequence[float], index: int) -> int:
+    """
+    Frame number of the index-th time code.
+
+    For a TimeRange this is its frame number on the timebase, so output
+    files of a slice keep the numbers they have in the whole sequence;
+    for a list it is the index.
+    """
+    if isinstance(times, TimeRange):
+        return times.first + index
+    return index
+
+
+def times_key(times: Sequence[float]) -> Hashable:
+    """Hashable key of a time code sequence, without expanding lazy ranges."""
+    if isinstance(times, TimeRange):
+        return times.key
+    return tuple(times)
+
+
+def parse_times(value: Union[Sequence[float], Dict[str, Any]]) -> Sequence[float]:
+    """
+    Turn a manifest `times` value into a sequence.
+
+    Args:
+        value: A list of time codes, or a range {start, fps, first, end | count}
+
+    Returns:
+        The list as given, or a lazy TimeRange
+    """
+    if isinstance(value, dict):
+        return TimeRange(
+            start=value.get("start", 0),
+            end=value.get("end"),
+            fps=value["fps"],
+            count=value.get("count"),
+            first=value.get("first", 0),
+        )
+    return list(value)
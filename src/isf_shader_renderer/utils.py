@@ -2,42 +2,46 @@
 
 import re
 from pathlib import Path
-from typing import List, Optional, Tuple
+from typing import Optional, Sequence, Tuple
 
+from .timebase import Rational, TimeRange, parse_rational
 
-def parse_time_range(time_range: str) -> List[float]:
+
+def parse_time_range(time_range: str) -> Sequence[float]:
     """
-    Parse a time range string into a list of time codes.
+    Parse a time range string into a sequence of time codes.
 
     Supports formats like:
     - "0,1,2,3" -> [0.0, 1.0, 2.0, 3.0]
-    - "0:3:0.5" -> [0.0, 0.5, 1.0, 1.5, 2.0, 2.5, 3.0]
-    - "0-3:0.5" -> [0.0, 0.5, 1.0, 1.5, 2.0, 2.5, 3.0]
+    - "0:3:0.5" -> [0.0, 0.5, 1.0, 1.5, 2.0, 2.5]
+    - "0-3:0.5" -> [0.0, 0.5, 1.0, 1.5, 2.0, 2.5]
+    - "0:10:1001/30000" -> one time code per NTSC frame
+
+    The end is exclusive, as everywhere else: ranges are returned as a
+    lazy TimeRange(start, end, fps=1/step), so "0:10:0.1" has 100 time
+    codes computed exactly from the frame number.
 
     Args:
         time_range: String representation of time range
 
     Returns:
-        List of time codes
+        Sequence of time codes
     """
     # Handle comma-separated values
     if ',' in time_range:
         return [float(t.strip()) for t in time_range.split(',')]
 
     # Handle range with step
-    range_pattern = r'^(\d+(?:\.\d+)?)\s*[-:]\s*(\d+(?:\.\d+)?)\s*:\s*(\d+(?:\.\d+)?)$'
-    match = re.match(range_pattern, time_range)
+    number = r'\d+(?:\.\d+)?'
+    range_pattern = rf'^({number})\s*[-:]\s*({number})\s*:\s*({number}(?:\s*/\s*{number})?)$'
+    match = re.match(range_pattern, time_range.strip())
     if match:
-        start = float(match.group(1))
-        end = float(match.group(2))
-        step = float(match.group(3))
-
-        times = []
-        current = start
-        while current <= end:
-            times.append(current)
-            current += step
-        return times
+        start = parse_rational(match.group(1))
+        end = parse_rational(match.group(2))
+        step = parse_rational(match.group(3).replace(" ", ""))
+        if step <= 0:
+            raise ValueError(f"Invalid time range format: {time_range} (step must be positive)")
+        return TimeRange(start, end, fps=1 / step)
 
     # Single value
     try:
@@ -196,36 +200,37 @@ def get_file_extension(format_name: str) -> str:
     return format_map.get(format_name.lower(), '.png')
 
 
-def calculate_frame_count(start_time: float, end_time: float, fps: float) -> int:
+def calculate_frame_count(start_time: Rational, end_time: Rational, fps: Rational) -> int:
     """
     Calculate the number of frames for a time range.
 
+    Same as len(TimeRange(start_time, end_time, fps)): frames whose time
+    is before end_time, counted in exact rational arithmetic.
+
     Args:
         start_time: Start time in seconds
-        end_time: End time in seconds
-        fps: Frames per second
+        end_time: End time in seconds (exclusive)
+        fps: Frames per second, e.g. 30 or "30000/1001"
 
     Returns:
         Number of frames
     """
-    duration = end_time - start_time
-    return int(duration * fps) + 1
+    return len(TimeRange(start_time, end_time, fps))
 
 
-def generate_time_codes(start_time: float, end_time: float, fps: float) -> List[float]:
+def generate_time_codes(start_time: Rational, end_time: Rational, fps: Rational) -> Sequence[float]:
     """
-    Generate a list of time codes for a time range.
+    Generate the time codes of a time range.
 
     Args:
         start_time: Start time in seconds
-        end_time: End time in seconds
-        fps: Frames per second
+        end_time: End time in seconds (exclusive)
+        fps: Frames per second, e.g. 30 or "30000/1001"
 
     Returns:
-        List of time codes
+        A lazy TimeRange with one time code per frame
     """
-    frame_count = calculate_frame_count(start_time, end_time, fps)
-    return [start_time + (i / fps) for i in range(frame_count)]
+    return TimeRange(start_time, end_time, fps)
 
 
 def format_error_for_ai(error: Exception, context: str = "") -> str:
@@ -0,0 +1,251 @@
+"""Y4M video files as per-frame image inputs, decoded ahead on a prefetch thread."""
+
+import math
+import queue
+import threading
+from pathlib import Path
+from typing import Dict, Optional, Sequence, Tuple
+
+import numpy as np
+
+from .specialize import split_isf_source
+
+# Decoded frames buffered ahead of the renderer
+PREFETCH_FRAMES = 4
+
+# Image input fed by --video when the shader declares several
+DEFAULT_VIDEO_INPUT = "inputImage"
+
+_Y4M_MAGIC = b"YUV4MPEG2 "
+_FRAME_MARKER = b"FRAME"
+
+
+def _chroma_shape(colorspace: str, width: int, height: int) -> Optional[Tuple[int, int]]:
+    """(height, width) of each chroma plane, or None for monochrome video."""
+    if colorspace.startswith("mono"):
+        return None
+    if colorspace.startswith("420"):
+        return (height + 1) // 2, (width + 1) // 2
+    if colorspace.startswith("422"):
+        return height, (width + 1) // 2
+    if colorspace.startswith("444"):
+        return height, width
+    raise ValueError(f"Unsupported Y4M colorspace: C{colorspace}")
+
+
+class Y4MReader:
+    """
+    Random-access reader for YUV4MPEG2 (.y4m) files.
+
+    Frames have a fixed size, so frame i is found by offset without scanning.
+    Conversion to RGBA writes into caller-provided buffers, so a ring of
+    buffers can be reused for a whole sequence.
+    """
+
+    def __init__(self, path: Path):
+        self.path = Path(path)
+        self._file = open(self.path, "rb")
+        header = self._file.readline(4096)
+        if not header.startswith(_Y4M_MAGIC) or not header.endswith(b"\n"):
+            self._file.close()
+            raise ValueError(f"Not a Y4M file: {self.path}")
+        self.header_size = len(header)
+
+        params: Dict[str, str] = {}
+        for token in header[len(_Y4M_MAGIC):].decode("ascii").split():
+            key, value = token[0], token[1:]
+            if key == "X":
+                name, _, setting = value.partition("=")
+                params["X" + name] = setting
+            else:
+                params[key] = value
+        self.width = int(params["W"])
+        self.height = int(params["H"])
+        rate_num, _, rate_den = params.get("F", "25:1").partition(":")
+        self.fps = int(rate_num) / int(rate_den or 1)
+        self.colorspace = params.get("C", "420jpeg")
+        self.full_range = params.get("XCOLORRANGE", "LIMITED").upper() == "FULL"
+
+        self._chroma = _chroma_shape(self.colorspace, self.width, self.height)
+        chroma_size = 0 if self._chroma is None else 2 * self._chroma[0] * self._chroma[1]
+        self.frame_size = self.width * self.height + chroma_size
+        stride = len(_FRAME_MARKER) + 1 + self.frame_size
+        self.frame_count = (self.path.stat().st_size - self.header_size) // stride
+        self._stride = stride
+        self._raw = np.empty(self.frame_size, dtype=np.uint8)
+
+    def frame_index(self, time_code: float) -> int:
+        """Frame shown at a time code; the last frame holds past the end."""
+        index = int(math.floor(time_code * self.fps + 1e-6))
+        return min(max(index, 0), max(self.frame_count - 1, 0))
+
+    def read_rgba(self, index: int, out: Optional[np.ndarray] = None) -> np.ndarray:
+        """
+        Decode one frame to RGBA.
+
+        Args:
+            index: Frame number
+            out: (height, width, 4) uint8 buffer to fill; allocated if omitted
+
+        Returns:
+            The filled buffer
+        """
+        if out is None:
+            out = np.empty((self.height, self.width, 4), dtype=np.uint8)
+        self._file.seek(self.header_size + index * self._stride)
+        marker = self._file.read(len(_FRAME_MARKER) + 1)
+        if marker != _FRAME_MARKER + b"\n":
+            raise ValueError(f"Frame {index} of {self.path} is missing or carries frame parameters")
+        if self._file.readinto(self._raw) != self.frame_size:
+            raise ValueError(f"Frame {index} of {self.path} is truncated")
+
+        plane = self.width * self.height
+        luma = self._raw[:plane].reshape(self.height, self.width).astype(np.float32)
+        if self._chroma is None:
+            grey = (luma - 16.0) * (255.0 / 219.0) if not self.full_range else luma
+            out[..., :3] = np.clip(grey + 0.5, 0, 255)[..., None]
+        else:
+            chroma_h, chroma_w = self._chroma
+            size = chroma_h * chroma_w
+            planes = []
+            for start in (plane, plane + size):
+                chroma = self._raw[start:start + size].reshape(chroma_h, chroma_w)
+                # Nearest-neighbour upsampling of subsampled chroma
+                chroma = chroma.repeat(self.height // chroma_h + (self.height % chroma_h > 0), axis=0)
+                chroma = chroma.repeat(self.width // chroma_w + (self.width % chroma_w > 0), axis=1)
+                planes.append(chroma[:self.height, :self.width].astype(np.float32) - 128.0)
+            u, v = planes
+            yuv_to_rgb(luma, u, v, out, self.full_range)
+        out[..., 3] = 255
+        return out
+
+    def close(self) -> None:
+        """Close the file."""
+        self._file.close()
+
+
+def yuv_to_rgb(luma: np.ndarray, u: np.ndarray, v: np.ndarray, out: np.ndarray, full_range: bool) -> None:
+    """BT.601 YUV (chroma centred on 0) to the RGB channels of an RGBA buffer."""
+    # The +0.5 rounds to nearest when the buffer assignment truncates
+    if full_range:
+        y, ku, kv = luma + 0.5, 1.0, 1.0
+    else:
+        y, ku, kv = (luma - 16.0) * (255.0 / 219.0) + 0.5, 255.0 / 224.0, 255.0 / 224.0
+    u = u * ku
+    v = v * kv
+    out[..., 0] = np.clip(y + 1.402 * v, 0, 255)
+    out[..., 1] = np.clip(y - 0.344136 * u - 0.714136 * v, 0, 255)
+    out[..., 2] = np.clip(y + 1.772 * u, 0, 255)
+
+
+def video_input(shader_content: str) -> Optional[str]:
+    """Name of the image input a video drives: inputImage, else the first image input."""
+    metadata, _, _ = split_isf_source(shader_content)
+    if metadata is None:
+        return None
+    names = [d.get("NAME") for d in metadata.get("INPUTS", []) if d.get("TYPE") == "image" and d.get("NAME")]
+    if DEFAULT_VIDEO_INPUT in names:
+        return DEFAULT_VIDEO_INPUT
+    return names[0] if names else None
+
+
+class VideoFrameSource:
+    """
+    Frames of a video for a planned sequence of time codes.
+
+    A background thread decodes the frames of the planned time codes, in
+    order, into a small ring of preallocated RGBA buffers, so decoding frame
+    N+1 overlaps uploading and rendering frame N. A buffer handed out by
+    frame_at stays valid until the next call; time codes outside the plan
+    are decoded synchronously. Planned time codes that are never requested
+    (frames skipped on resume, or that failed) are passed over once a later
+    time code is requested, without being decoded if not reached yet.
+    """
+
+    def __init__(self, path: Path, time_codes: Sequence[float], ring_size: int = PREFETCH_FRAMES):
+        self.path = Path(path)
+        self._reader = Y4MReader(self.path)
+        # The prefetch thread seeks its own file handle
+        self._prefetch_reader = Y4MReader(self.path)
+        # Kept as given (a lazy TimeRange stays lazy); frame numbers are computed as decoding reaches them
+        self._times = time_codes
+        shape = (self._reader.height, self._reader.width, 4)
+        self._buffers = [np.empty(shape, dtype=np.uint8) for _ in range(max(ring_size, 1))]
+        self._free: "queue.Queue[int]" = queue.Queue()
+        for slot in range(len(self._buffers)):
+            self._free.put(slot)
+        # (slot, error) per planned time code; slot None for a time code skipped undecoded
+        self._ready: "queue.Queue[Tuple[Optional[int], Optional[Exception]]]" = queue.Queue()
+        self._position = 0
+        # Planned time codes before this one are no longer wanted
+        self._skip_before = float("-inf")
+        self._held: Optional[int] = None
+        self._stop = threading.Event()
+        self._thread = threading.Thread(target=self._prefetch, name="video-prefetch", daemon=True)
+        self._thread.start()
+
+    @property
+    def size(self) -> Tuple[int, int]:
+        """(width, height) of the video."""
+        return self._reader.width, self._reader.height
+
+    @property
+    def fps(self) -> float:
+        """Frame rate of the video."""
+        return self._reader.fps
+
+    def _prefetch(self) -> None:
+        for time_code in self._times:
+            if round(float(time_code), 9) < self._skip_before:
+                self._ready.put((None, None))
+                continue
+            index = self._prefetch_reader.frame_index(time_code)
+            slot = None
+            while slot is None:
+                if self._stop.is_set():
+                    return
+                try:
+                    slot = self._free.get(timeout=0.1)
+                except queue.Empty:
+                    pass
+            try:
+                self._prefetch_reader.read_rgba(index, out=self._buffers[slot])
+                self._ready.put((slot, None))
+            except Exception as e:
+                self._ready.put((slot, e))
+
+    def frame_at(self, time_code: float) -> np.ndarray:
+        """
+        Return the RGBA frame shown at a time code.
+
+        Returns:
+            (height, width, 4) uint8 array, valid until the next call
+        """
+        if self._held is not None:
+            self._free.put(self._held)
+            self._held = None
+        wanted = round(float(time_code), 9)
+        if self._position < len(self._times) and round(float(self._times[self._position]), 9) < wanted:
+            self._skip_before = wanted
+            while self._position < len(self._times) and round(float(self._times[self._position]), 9) < wanted:
+                slot, _ = self._ready.get()
+                self._position += 1
+                if slot is not None:
+                    self._free.put(slot)
+        if self._position < len(self._times) and \
+                round(float(self._times[self._position]), 9) == wanted:
+            slot, error = self._ready.get()
+            self._position += 1
+            if error is not None:
+                self._free.put(slot)
+                raise error
+            self._held = slot
+            return self._buffers[slot]
+        return self._reader.read_rgba(self._reader.frame_index(time_code))
+
+    def close(self) -> None:
+        """Stop the prefetch thread and close the file."""
+        self._stop.set()
+        self._thread.join(timeout=1.0)
+        self._reader.close()
+        self._prefetch_reader.close()
@@ -0,0 +1,320 @@
+"""Crash-safe frame output: atomic writes, a write-behind queue and a progress journal."""
+
+import hashlib
+import json
+import logging
+import os
+import queue
+import threading
+from contextlib import contextmanager
+from pathlib import Path
+from typing import Any, Dict, Iterator, List, Optional, Sequence, Tuple, Union
+
+from PIL import Image
+
+from .canonical import canonical_hash, canonical_json
+from .config import Defaults, ShaderConfig
+from .pixels import image_format, output_image
+
+logger = logging.getLogger(__name__)
+
+# Frames queued for the writer thread before the renderer waits for it
+WRITE_QUEUE_FRAMES = 8
+# Frames made durable together, with one directory and journal sync per batch
+WRITE_BATCH_FRAMES = 16
+# Queue item asking the writer thread to commit the frames written so far
+_COMMIT = object()
+
+
+def _fsync_path(path: Path) -> None:
+    """Persist a file's data, or a directory's entries (a no-op where it cannot be opened)."""
+    try:
+        fd = os.open(path, os.O_RDONLY)
+    except OSError:
+        return
+    try:
+        os.fsync(fd)
+    except OSError:
+        pass
+    finally:
+        os.close(fd)
+
+
+def write_image_atomic(
+    image: Image.Image,
+    path: Union[str, Path],
+    quality: int = 95,
+    fsync: bool = False,
+) -> os.stat_result:
+    """
+    Save an image so the path holds either the old file or the complete new one.
+
+    The image is encoded into a temporary file next to the target and
+    renamed over it, so a crash mid-write leaves a stray temporary file
+    rather than a truncated frame under the final name.
+
+    Args:
+        image: Frame to save (RGBA frames bound for JPEG lose alpha)
+        path: Final path; its extension selects the format
+        quality: Encoder quality
+        fsync: Flush the file to disk before the rename (the rename itself
+            is durable once the directory is synced)
+
+    Returns:
+        The stat of the written file
+    """
+    path = Path(path)
+    format = image_format(path)
+    if format is None:
+        raise ValueError(f"unknown file extension: {path.suffix}")
+    path.parent.mkdir(parents=True, exist_ok=True)
+    temporary = path.with_name(f".{path.name}.{os.getpid()}.{threading.get_ident()}.tmp")
+    try:
+        # os.open applies the umask, so the frame gets the usual permissions
+        with os.fdopen(os.open(temporary, os.O_WRONLY | os.O_CREAT | os.O_TRUNC, 0o666), "wb") as handle:
+            with output_image(image, format) as savable:
+                savable.save(handle, format=format, quality=quality)
+            if fsync:
+                handle.flush()
+                os.fsync(handle.fileno())
+        os.replace(temporary, path)
+    except BaseException:
+        try:
+            os.unlink(temporary)
+        except OSError:
+            pass
+        raise
+    return os.stat(path)
+
+
+def job_key(shader_content: str, shader_config: Optional[ShaderConfig], defaults: Optional[Defaults] = None) -> str:
+    """
+    Key of everything that determines a job's frames except the time code.
+
+    Combined with a time code by frame_key; a frame recorded under another
+    shader, input set, size or quality is not treated as done.
+    """
+    defaults = defaults or Defaults()
+    identity: Dict[str, Any] = {"shader": canonical_hash(shader_content)}
+    if shader_config is not None:
+        identity.update(
+            inputs=shader_config.inputs or {},
+            audio=shader_config.audio,
+            video=shader_config.video,
+            specialize=shader_config.specialize,
+            size=[shader_config.get_width(defaults), shader_config.get_height(defaults)],
+            quality=shader_config.get_quality(defaults),
+        )
+    else:
+        identity.update(size=[defaults.width, defaults.height], quality=defaults.quality)
+    return hashlib.blake2b(canonical_json(identity).encode("utf-8"), digest_size=8).hexdigest()
+
+
+def frame_key(job: str, time_code: float) -> str:
+    """Key of one frame of a job."""
+    return f"{job}@{time_code!r}"
+
+
+class ProgressJournal:
+    """
+    Frames a batch run has completed, one NDJSON line per frame.
+
+    Each line holds the output path, the frame key, and the size and
+    modification time of the file as written, and is appended only after
+    the frame is on disk. A resumed run skips a frame when its path is
+    recorded under the same key and the file still has that size and
+    time, which a truncated, replaced or deleted file does not. A line
+    cut short by a crash is ignored.
+    """
+
+    def __init__(self, path: Union[str, Path], resume: bool = False):
+        """
+        Args:
+            path: Journal file
+            resume: Read the frames recorded by an earlier run and append to
+                them; otherwise start an empty journal
+        """
+        self.path = Path(path)
+        self._done: Dict[str, Tuple[str, int, int]] = {}
+        if resume:
+            self._load()
+        self.path.parent.mkdir(parents=True, exist_ok=True)
+        self._handle = open(self.path, "a" if resume else "w", encoding="utf-8")
+        self._lock = threading.Lock()
+
+    def _load(self) -> None:
+        try:
+            with open(self.path, "r", encoding="utf-8") as f:
+                for line in f:
+                    try:
+                        entry = json.loads(line)
+                        self._done[entry["o"]] = (entry["k"], entry["s"], entry["m"])
+                    except (ValueError, KeyError, TypeError):
+                        continue
+        except FileNotFoundError:
+            pass
+
+    def __len__(self) -> int:
+        return len(self._done)
+
+    def is_done(self, output_path: Union[str, Path], key: str) -> bool:
+        """Whether a frame was completed with this key and its file is intact."""
+        entry = self._done.get(str(output_path))
+        if entry is None or entry[0] != key:
+            return False
+        try:
+            stat = os.stat(output_path)
+        except OSError:
+            return False
+        return stat.st_size == entry[1] and stat.st_mtime_ns == entry[2]
+
+    def record(self, frames: Sequence[Tuple[str, str, os.stat_result]], fsync: bool = False) -> None:
+        """Append completed (output path, key, stat) frames."""
+        if not frames:
+            return
+        lines = []
+        for output, key, stat in frames:
+            self._done[output] = (key, stat.st_size, stat.st_mtime_ns)
+            lines.append(json.dumps({"o": output, "k": key, "s": stat.st_size, "m": stat.st_mtime_ns}) + "\n")
+        with self._lock:
+            self._handle.write("".join(lines))
+            self._handle.flush()
+            if fsync:
+                os.fsync(self._handle.fileno())
+
+    def close(self) -> None:
+        """Close the journal file."""
+        self._handle.close()
+
+
+class FrameWriter:
+    """
+    Write-behind queue that saves frames on a background thread.
+
+    The render loop hands each finished image to submit() and moves on to
+    the next frame while this thread encodes and writes the previous ones,
+    so PNG compression and disk I/O overlap rendering. Every frame is
+    written atomically and committed in batches of batch_frames (and on
+    flush and close): with fsync, the files of a batch and their
+    directories are synced, then the batch is recorded in the journal.
+    Without fsync, frames survive a crash of this process but not
+    necessarily a power loss. The queue is bounded, so a slow disk throttles
+    rendering instead of piling up frames in memory. Errors do not stop the
+    queue; they are collected in failed.
+    """
+
+    def __init__(
+        self,
+        journal: Optional[ProgressJournal] = None,
+        fsync: bool = False,
+        queue_frames: int = WRITE_QUEUE_FRAMES,
+        batch_frames: int = WRITE_BATCH_FRAMES,
+    ):
+        self.journal = journal
+        self.fsync = fsync
+        self.batch_frames = batch_frames
+        self.written = 0
+        # (output path, journal key, stat) of frames written since the last commit
+        self._pending: List[Tuple[str, Optional[str], os.stat_result]] = []
+        # (output path, error message) of frames that could not be written
+        self.failed: List[Tuple[str, str]] = []
+        self._queue: "queue.Queue[Optional[Tuple[Image.Image, Path, int, Optional[str]]]]" = queue.Queue(queue_frames)
+        self._thread = threading.Thread(target=self._run, name="frame-writer", daemon=True)
+        self._thread.start()
+
+    def submit(self, image: Image.Image, output_path: Union[str, Path], quality: int = 95, key: Optional[str] = None) -> None:
+        """
+        Queue a frame for writing; blocks while the queue is full.
+
+        Args:
+            image: The frame (no longer modified by the caller)
+            output_path: Final path of the frame
+            quality: Encoder quality
+            key: Frame key recorded in the journal once the frame is durable
+        """
+        self._queue.put((image, Path(output_path), quality, key))
+
+    def _run(self) -> None:
+        while True:
+            item = self._queue.get()
+            try:
+                if item is None or item is _COMMIT:
+                    self._commit()
+                    if item is None:
+                        return
+                    continue
+                self._write(*item)
+                if len(self._pending) >= self.batch_frames:
+                    self._commit()
+            finally:
+                self._queue.task_done()
+
+    def _write(self, image: Image.Image, path: Path, quality: int, key: Optional[str]) -> None:
+        try:
+            stat = write_image_atomic(image, path, quality)
+        except Exception as e:
+            logger.error(f"Failed to write frame {path}: {e}")
+            self.failed.append((str(path), str(e)))
+            return
+        self._pending.append((str(path), key, stat))
+        self.written += 1
+        logger.info(f"Successfully rendered frame to {path}")
+
+    def _commit(self) -> None:
+        """Make the frames written since the last commit durable (with fsync) and journal them."""
+        if not self._pending:
+            return
+        if self.fsync:
+            for path, _, _ in self._pending:
+                _fsync_path(Path(path))
+            for directory in {Path(path).parent for path, _, _ in self._pending}:
+                _fsync_path(directory)
+        if self.journal is not None:
+            self.journal.record([entry for entry in self._pending if entry[1] is not None], fsync=self.fsync)
+        self._pending = []
+
+    def flush(self) -> None:
+        """Wait until every queued frame is written (or has failed) and journaled."""
+        if self._thread.is_alive():
+            self._queue.put(_COMMIT)
+            self._queue.join()
+
+    def close(self) -> None:
+        """Write every queued frame and stop the thread."""
+        if self._thread.is_alive():
+            self._queue.put(None)
+            self._thread.join()
+
+    def __enter__(self) -> "FrameWriter":
+        return self
+
+    def __exit__(self, exc_type, exc, tb) -> None:
+        self.close()
+
+
+@contextmanager
+def frame_output(
+    journal_path: Optional[Union[str, Path]] = None,
+    resume: bool = False,
+) -> Iterator[Tuple[FrameWriter, Optional[ProgressJournal]]]:
+    """
+    A frame writer, with a progress journal if a path is given, closed on exit.
+
+    With a journal, frames are synced to disk in batches before they are
+    recorded, so a journal survives a power loss as well as a crash.
+
+    Args:
+        journal_path: Journal file of the run
+        resume: Keep the frames an earlier run recorded in the journal
+
+    Yields:
+        (writer, journal or None)
+    """
+    journal = ProgressJournal(journal_path, resume=resume) if journal_path is not None else None
+    writer = FrameWriter(journal, fsync=journal is not None)
+    try:
+        yield writer, journal
+    finally:
+        writer.close()
+        if journal is not None:
+            journal.close()
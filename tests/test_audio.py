@@ -0,0 +1,131 @@
+"""Tests for audio and audioFFT input textures."""
+
+import wave
+from unittest.mock import Mock
+
+import numpy as np
+import pytest
+from PIL import Image
+
+from isf_shader_renderer.audio import (
+    AudioTrack, audio_inputs, fft_textures, load_wav, waveform_textures
+)
+from isf_shader_renderer.config import ShaderConfig, ShaderRendererConfig
+from isf_shader_renderer.renderer import ShaderRenderer
+
+RATE = 8000
+
+SHADER = """/*{
+    "INPUTS": [
+        {"NAME": "waveform", "TYPE": "audio", "MAX": 128},
+        {"NAME": "spectrum", "TYPE": "audioFFT"},
+        {"NAME": "uGain", "TYPE": "float", "DEFAULT": 1.0}
+    ]
+}*/
+void main() {
+    gl_FragColor = IMG_NORM_PIXEL(spectrum, isf_FragNormCoord) * uGain;
+}"""
+
+
+def write_wav(path, samples: np.ndarray, sample_width: int = 2) -> None:
+    """Write (frames, channels) float samples as PCM."""
+    scale = float(2 ** (8 * sample_width - 1) - 1)
+    ints = np.round(samples * scale).astype("<i4")
+    raw = np.ascontiguousarray(ints).view(np.uint8).reshape(ints.shape + (4,))[..., :sample_width]
+    with wave.open(str(path), "wb") as f:
+        f.setnchannels(samples.shape[1])
+        f.setsampwidth(sample_width)
+        f.setframerate(RATE)
+        f.writeframes(raw.tobytes())
+
+
+@pytest.fixture
+def tone(tmp_path):
+    """Two seconds of a 1 kHz tone on the left channel, silence on the right."""
+    t = np.arange(2 * RATE) / RATE
+    samples = np.stack([0.5 * np.sin(2 * np.pi * 1000 * t), np.zeros_like(t)], axis=1)
+    path = tmp_path / "tone.wav"
+    write_wav(path, samples)
+    return path, samples
+
+
+class TestWavDecoding:
+    """Test WAV parsing."""
+
+    def test_16_and_24_bit_pcm(self, tmp_path, tone):
+        """Test that PCM samples decode to floats in [-1, 1]."""
+        path, expected = tone
+        samples, rate = load_wav(path)
+        assert rate == RATE and samples.shape == expected.shape
+        np.testing.assert_allclose(samples, expected, atol=1e-4)
+
+        path24 = tmp_path / "tone24.wav"
+        write_wav(path24, expected, sample_width=3)
+        np.testing.assert_allclose(load_wav(path24)[0], expected, atol=1e-6)
+
+    def test_not_a_wav(self, tmp_path):
+        """Test that other files are rejected."""
+        path = tmp_path / "noise.wav"
+        path.write_bytes(b"not audio at all")
+        with pytest.raises(ValueError):
+            load_wav(path)
+
+
+class TestAudioTextures:
+    """Test the vectorized waveform and FFT passes."""
+
+    def test_fft_peaks_at_the_tone(self, tone):
+        """Test that the spectrum peaks at the tone's bin on the tone channel only."""
+        _, samples = tone
+        spectra = fft_textures(samples, RATE, [0.5, 1.0, 1.5], 256)
+        assert spectra.shape == (3, 2, 256)
+        # 512-sample blocks at 8 kHz give 15.6 Hz bins; 1 kHz is bin 64
+        assert np.all(np.argmax(spectra[:, 0], axis=1) == 64)
+        assert spectra[:, 1].max() == 0.0
+
+    def test_waveform_is_zero_padded_before_the_start(self, tone):
+        """Test that windows reaching before t=0 read silence (0.5)."""
+        _, samples = tone
+        rows = waveform_textures(samples, RATE, [0.0, 1.0], 64)
+        assert np.all(rows[0] == 0.5)
+        assert rows[1, 0].min() < 0.5 < rows[1, 0].max()
+
+    def test_track_precomputes_requested_times(self, tone):
+        """Test that precomputed and on-demand lookups agree."""
+        path, _ = tone
+        specs = audio_inputs(SHADER)
+        assert specs == [("waveform", "audio", 128), ("spectrum", "audioFFT", 256)]
+
+        track = AudioTrack(path, specs, [0.25, 0.5])
+        precomputed = track.inputs_at(0.5)
+        on_demand = AudioTrack(path, specs, []).inputs_at(0.5)
+        assert precomputed["spectrum"].size == (256, 2)
+        assert precomputed["waveform"].size == (128, 2)
+        assert np.array_equal(np.asarray(precomputed["spectrum"]), np.asarray(on_demand["spectrum"]))
+
+
+class TestAudioRendering:
+    """Test that the renderer feeds audio inputs per frame."""
+
+    def test_audio_inputs_are_set_per_time_code(self, tone):
+        """Test that each time code gets its own textures from one precomputed track."""
+        path, _ = tone
+        renderer = ShaderRenderer(ShaderRendererConfig())
+        config = ShaderConfig(input="test.fs", output="", times=[0.5, 1.0], audio=str(path))
+        isf_renderer = Mock()
+
+        for time_code in config.times:
+            renderer._set_audio_inputs(isf_renderer, SHADER, config, time_code)
+
+        names = [call.args[0] for call in isf_renderer.set_input.call_args_list]
+        assert names == ["waveform", "spectrum", "waveform", "spectrum"]
+        assert all(isinstance(call.args[1], Image.Image) for call in isf_renderer.set_input.call_args_list)
+        assert len(renderer._audio_tracks) == 1
+
+    def test_missing_audio_file_fails_the_render(self, tmp_path):
+        """Test that a missing WAV file is reported as a render error."""
+        renderer = ShaderRenderer(ShaderRendererConfig())
+        config = ShaderConfig(input="test.fs", output="", times=[0.0], width=8, height=8,
+                              audio=str(tmp_path / "missing.wav"))
+        with pytest.raises(RuntimeError, match="Cannot load audio file"):
+            renderer.render_array(SHADER, 0.0, config)
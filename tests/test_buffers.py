@@ -0,0 +1,165 @@
+"""Tests for pooled frame buffers."""
+
+import gc
+import tracemalloc
+from io import BytesIO
+
+import numpy as np
+import pytest
+from PIL import Image
+
+from isf_shader_renderer.buffers import (
+    FRAME_ALIGNMENT,
+    FramePool,
+    aligned_empty,
+    encode_image,
+    image_into,
+)
+from isf_shader_renderer.config import ShaderConfig, ShaderRendererConfig
+from isf_shader_renderer.renderer import RenderSession, ShaderRenderer
+
+
+class TestAlignedBuffers:
+    """Test buffer allocation and zero-copy image conversion."""
+
+    def test_buffers_are_aligned_and_contiguous(self):
+        """Test that buffers start on the alignment boundary."""
+        for shape in [(3, 5, 4), (1, 1, 4), (17, 33, 4)]:
+            buffer = aligned_empty(shape)
+            assert buffer.shape == shape
+            assert buffer.ctypes.data % FRAME_ALIGNMENT == 0
+            assert buffer.flags.c_contiguous
+
+    def test_image_into_writes_the_buffer_in_place(self):
+        """Test that image_into fills the caller's buffer and returns it."""
+        out = aligned_empty((4, 6, 4))
+        image = Image.new("RGBA", (6, 4), (10, 20, 30, 40))
+        result = image_into(image, out)
+        assert result is out
+        assert (out == [10, 20, 30, 40]).all()
+
+    def test_image_into_converts_other_modes(self):
+        """Test that RGB frames gain an opaque alpha channel."""
+        out = aligned_empty((2, 2, 4))
+        image_into(Image.new("RGB", (2, 2), (1, 2, 3)), out)
+        assert (out == [1, 2, 3, 255]).all()
+
+    def test_image_into_rejects_mismatched_sizes(self):
+        """Test that a buffer of the wrong size is refused."""
+        with pytest.raises(ValueError):
+            image_into(Image.new("RGBA", (3, 3)), aligned_empty((2, 2, 4)))
+
+
+class TestFramePool:
+    """Test buffer reuse and the pool bounds."""
+
+    def test_released_buffers_are_reused(self):
+        """Test that acquiring the same shape again returns the same memory."""
+        pool = FramePool()
+        first = pool.acquire(8, 4)
+        pool.release(first)
+        second = pool.acquire(8, 4)
+        assert second is first
+        assert pool.stats()["allocations"] == 1
+        assert pool.stats()["reuses"] == 1
+
+    def test_shapes_are_pooled_separately(self):
+        """Test that a buffer is only handed out for its own shape."""
+        pool = FramePool()
+        with pool.lease(8, 4) as small:
+            pass
+        with pool.lease(16, 8) as large:
+            assert large is not small
+            assert large.shape == (8, 16, 4)
+
+    def test_pool_is_bounded(self):
+        """Test that idle buffers per shape and pooled shapes are capped."""
+        pool = FramePool(buffers_per_shape=2, max_shapes=3)
+        buffers = [pool.acquire(4, 4) for _ in range(5)]
+        for buffer in buffers:
+            pool.release(buffer)
+        assert pool.stats()["idle"] == 2
+        for size in range(5, 10):
+            with pool.lease(size, size):
+                pass
+        assert pool.stats()["shapes"] == 3
+
+
+class TestEncoding:
+    """Test the reused encode buffer."""
+
+    def test_encoded_frames_do_not_leak_previous_output(self):
+        """Test that a smaller frame after a larger one is not padded with stale bytes."""
+        noise = Image.fromarray(np.random.default_rng(0).integers(0, 256, (64, 64, 3), dtype=np.uint8))
+        large = encode_image(noise, "PNG")
+        small = encode_image(Image.new("RGB", (2, 2)), "PNG")
+        assert len(small) < len(large)
+        with Image.open(BytesIO(small)) as decoded:
+            assert decoded.size == (2, 2)
+
+
+class FakeProgram:
+    """Compiled-program stand-in that returns one fixed frame (and records nothing per call)."""
+
+    def __init__(self, frame):
+        self.frame = frame
+
+    def set_input(self, name, value):
+        pass
+
+    def render(self, width, height, time_offset=0.0):
+        return self
+
+    def to_pil_image(self):
+        return self.frame
+
+
+def _session(width, height):
+    """A RenderSession around a fake program."""
+    session = RenderSession.__new__(RenderSession)
+    session._owner = ShaderRenderer(ShaderRendererConfig())
+    session._renderer = FakeProgram(Image.new("RGBA", (width, height), (50, 100, 150, 255)))
+    session.shader_content = "void main() {}"
+    session.shader_config = ShaderConfig(input="x", output="y", times=[0.0], width=width, height=height)
+    return session
+
+
+class TestSteadyStateMemory:
+    """Test that rendering into pooled buffers keeps memory flat."""
+
+    def test_render_array_fills_the_given_buffer(self):
+        """Test that a session renders into the caller's buffer."""
+        session = _session(8, 4)
+        pool = FramePool()
+        with pool.lease(8, 4) as pixels:
+            result = session.render_array(0.0, out=pixels)
+            assert result is pixels
+            assert (pixels == [50, 100, 150, 255]).all()
+
+    def test_soak_allocates_nothing_per_frame(self):
+        """Test that thousands of pooled renders do not grow traced memory."""
+        session = _session(256, 256)
+        pool = FramePool()
+
+        def render(frames):
+            for i in range(frames):
+                with pool.lease(256, 256) as pixels:
+                    session.render_array(i / 30.0, out=pixels)
+
+        render(100)
+        gc.collect()
+        tracemalloc.start()
+        try:
+            render(100)
+            gc.collect()
+            baseline, _ = tracemalloc.get_traced_memory()
+            tracemalloc.reset_peak()
+            render(3000)
+            gc.collect()
+            current, peak = tracemalloc.get_traced_memory()
+        finally:
+            tracemalloc.stop()
+        # np.asarray on each frame would allocate 256 KB per render
+        assert peak - baseline < 64 * 1024
+        assert current - baseline < 16 * 1024
+        assert pool.stats()["allocations"] == 1
@@ -0,0 +1,63 @@
+"""Tests for shader source canonicalization."""
+
+from isf_shader_renderer.canonical import canonical_glsl, canonical_hash, canonical_json, canonicalize
+from isf_shader_renderer.program_cache import program_key
+
+SHADER = """/*{
+    "DESCRIPTION": "Canonical test",
+    "INPUTS": [{"NAME": "uGain", "TYPE": "float", "DEFAULT": 1}]
+}*/
+#define SCALE 2.0
+void main() {
+    // tint the output
+    vec4 color = vec4(0.5, 0.25, 1.0, 1.0);
+    gl_FragColor = color * uGain * SCALE;
+}"""
+
+REFORMATTED = """/*{"INPUTS": [{"TYPE": "float", "DEFAULT": 1.0, "NAME": "uGain"}],
+"DESCRIPTION": "Canonical test"}*/
+
+#define   SCALE 2.
+void main()
+{
+    /* tint
+       the output */
+    vec4 color=vec4(.5,0.250,1.0f,1.);
+    gl_FragColor = color*uGain*SCALE;   // done
+}
+"""
+
+
+class TestCanonicalize:
+    """Test which source differences canonicalization removes."""
+
+    def test_trivial_differences_share_a_hash(self):
+        """Test comments, whitespace, float spelling, brace style and key order."""
+        assert canonicalize(SHADER).text == canonicalize(REFORMATTED).text
+        assert canonical_hash(SHADER) == canonical_hash(REFORMATTED)
+        assert program_key(SHADER) == program_key(REFORMATTED)
+
+    def test_semantic_differences_change_the_hash(self):
+        """Test that code, operator and macro changes are kept apart."""
+        assert canonical_hash(SHADER) != canonical_hash(SHADER.replace("0.25", "0.26"))
+        assert canonical_glsl("a = b + +c;")[0] != canonical_glsl("a = b ++c;")[0]
+        assert canonical_glsl("#define F (x)")[0] != canonical_glsl("#define F(x)")[0]
+
+    def test_operators_keep_their_lexing(self):
+        """Test that minimal spacing never merges tokens."""
+        lines, _ = canonical_glsl("x = a - -b;\ny = a / *p;\nz = -1.0;")
+        assert lines == ["x=a- -b;", "y=a/ *p;", "z=-1.0;"]
+
+    def test_line_map_points_at_the_source(self):
+        """Test that canonical lines map back to the lines they came from."""
+        canonical = canonicalize(REFORMATTED)
+        lines = canonical.text.split("\n")
+        assert lines[0].startswith('/*{"DESCRIPTION"')
+        assert canonical.original_line(1) == 1
+        assert canonical.original_line(lines.index("#define SCALE 2.0") + 1) == 4
+        color_line = next(i for i, line in enumerate(lines) if line.startswith("vec4 color"))
+        assert canonical.original_line(color_line + 1) == 9
+
+    def test_json_numbers_are_normalized(self):
+        """Test that 1 and 1.0 serialize alike while booleans stay booleans."""
+        assert canonical_json({"b": 1, "a": [True, 2.0]}) == '{"a":[true,2.0],"b":1.0}'
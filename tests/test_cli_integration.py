@@ -141,6 +141,44 @@ void main() { gl_FragColor = vec4(TIME/2.0, 0.5, 0.5, 1.0); }'''
             assert image.mode in ('RGBA', 'RGB')
 
 
+def test_cli_frame_sequence():
+    """Test a rational-rate frame sequence starting part way into the timebase."""
+    shader_code = '''/*{
+    "DESCRIPTION": "Sequence test shader",
+    "INPUTS": []
+}*/
+void main() { gl_FragColor = vec4(fract(TIME), 0.5, 0.5, 1.0); }'''
+    with tempfile.NamedTemporaryFile(suffix='.fs', delete=False, mode='w') as shader_file:
+        shader_file.write(shader_code)
+        shader_path = Path(shader_file.name)
+
+    with tempfile.TemporaryDirectory() as tmpdir:
+        output_pattern = Path(tmpdir) / "seq_%06d.png"
+        try:
+            subprocess.run([
+                sys.executable, '-m', 'isf_shader_renderer.cli',
+                str(shader_path),
+                '--output', str(output_pattern),
+                '--width', '16', '--height', '16',
+                '--fps', '30000/1001', '--frames', '3', '--first-frame', '10',
+            ], capture_output=True, text=True, check=True)
+        except subprocess.CalledProcessError as e:
+            print('STDOUT:', e.stdout)
+            print('STDERR:', e.stderr)
+            raise
+        # Files are numbered by frame number on the timebase, not by position
+        assert sorted(p.name for p in Path(tmpdir).glob("seq_*.png")) == [f"seq_{i:06d}.png" for i in (10, 11, 12)]
+
+        result = subprocess.run([
+            sys.executable, '-m', 'isf_shader_renderer.cli',
+            str(shader_path),
+            '--output', str(output_pattern),
+            '--time', '1', '--frames', '3',
+        ], capture_output=True, text=True)
+        assert result.returncode != 0
+    shader_path.unlink(missing_ok=True)
+
+
 def test_cli_error_handling_invalid_shader():
     """Test CLI error handling for invalid shader."""
     # Write an invalid shader (missing main)
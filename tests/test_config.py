@@ -1,6 +1,8 @@
 """Tests for configuration management."""
 
+import json
 import tempfile
+import time
 from pathlib import Path
 
 import pytest
@@ -9,11 +11,13 @@ import yaml
 from isf_shader_renderer.config import (
     ShaderRendererConfig,
     Defaults,
+    Manifest,
     ShaderConfig,
     create_default_config,
     load_config,
     save_config,
 )
+from isf_shader_renderer.timebase import TimeRange
 
 
 class TestDefaults:
@@ -192,4 +196,105 @@ class TestConfigFileOperations:
             assert loaded_config.shaders[0].output == "output/example_%04d.png"
             assert loaded_config.shaders[0].times == [0.0, 0.5, 1.0, 1.5, 2.0]
         finally:
-            config_path.unlink() 
\ No newline at end of file
+            config_path.unlink() 
+
+class TestTimeRanges:
+    """Test range syntax for times in configuration files."""
+
+    def test_yaml_range_is_lazy(self, tmp_path):
+        """Test that a range entry loads as a TimeRange without expanding it."""
+        config_path = tmp_path / "config.yaml"
+        config_path.write_text(yaml.dump({
+            "shaders": [{"input": "a.fs", "output": "a_%06d.png", "times": {"start": 1.0, "end": 1001.0, "fps": 1000}}],
+        }))
+        times = load_config(config_path).shaders[0].times
+        assert isinstance(times, TimeRange)
+        assert len(times) == 1_000_000
+        assert times[0] == 1.0 and times[-1] == pytest.approx(1000.999)
+
+    def test_range_round_trips_through_save(self, tmp_path):
+        """Test that save_config writes a range back in range form."""
+        config = ShaderRendererConfig(shaders=[ShaderConfig("a.fs", "a.png", TimeRange(0.0, fps=24, count=48))])
+        config_path = tmp_path / "config.yaml"
+        save_config(config, config_path)
+        assert yaml.safe_load(config_path.read_text())["shaders"][0]["times"] == {"start": 0.0, "fps": 24.0, "count": 48}
+        assert load_config(config_path).shaders[0].times == TimeRange(0.0, fps=24, count=48)
+
+    def test_rational_rate_in_yaml(self, tmp_path):
+        """Test an NTSC rate given as a fraction string."""
+        config_path = tmp_path / "config.yaml"
+        config_path.write_text(yaml.dump({
+            "shaders": [{"input": "a.fs", "output": "a_%06d.png", "times": {"fps": "30000/1001", "end": 60, "first": 900}}],
+        }))
+        times = load_config(config_path).shaders[0].times
+        assert len(times) == 1799 - 900
+        assert times.frame_numbers[0] == 900
+        assert times[0] == 900 * 1001 / 30000
+
+    def test_range_forms_exclude_end(self, tmp_path):
+        """Test that a range string and a {start, end, fps} range both stop before end."""
+        config_path = tmp_path / "config.yaml"
+        config_path.write_text(yaml.dump({"shaders": [
+            {"input": "a.fs", "output": "a_%d.png", "times": "0:10:0.1"},
+            {"input": "b.fs", "output": "b_%d.png", "times": {"start": 0, "end": 10, "fps": 10}},
+        ]}))
+        string_form, dict_form = (shader.times for shader in load_config(config_path).shaders)
+        assert string_form == dict_form == TimeRange(0, 10, fps=10)
+        assert len(string_form) == 100 and string_form[-1] == 9.9
+
+    def test_range_string_in_manifest(self, tmp_path):
+        """Test that NDJSON jobs take the same range strings."""
+        path = tmp_path / "jobs.ndjson"
+        path.write_text(json.dumps({"input": "a.fs", "output": "a_%d.png", "times": "1:2:0.25"}) + "\n")
+        assert next(iter(load_config(path).shaders)).times == [1.0, 1.25, 1.5, 1.75]
+
+    @pytest.mark.parametrize("times", ["0:1", "1,2", "soon", {"start": 0, "end": 1}, {"fps": 30}, {"fps": 30, "end": 1, "count": 5}, {"fps": 0, "count": 5}, {"fps": "30/0", "count": 5}, {"fps": 30, "count": 5, "first": -1}])
+    def test_invalid_ranges_are_rejected(self, tmp_path, times):
+        """Test that a range needs fps and exactly one of end/count."""
+        config_path = tmp_path / "config.yaml"
+        config_path.write_text(yaml.dump({"shaders": [{"input": "a.fs", "output": "a.png", "times": times}]}))
+        with pytest.raises(ValueError, match="Invalid configuration format"):
+            load_config(config_path)
+
+
+class TestManifest:
+    """Test streaming NDJSON job manifests."""
+
+    def test_jobs_stream_with_defaults(self, tmp_path):
+        """Test the defaults line and lazily parsed jobs."""
+        path = tmp_path / "jobs.ndjson"
+        path.write_text(
+            json.dumps({"defaults": {"width": 320, "height": 180}}) + "\n"
+            + json.dumps({"input": "a.fs", "output": "a.png", "times": [0.0, 0.5]}) + "\n"
+            + "\n# comment\n"
+            + json.dumps({"input": "b.fs", "output": "b_%d.png", "times": {"fps": 30, "count": 90}}) + "\n"
+        )
+        config = load_config(path)
+        assert isinstance(config.shaders, Manifest)
+        assert (config.defaults.width, config.defaults.height) == (320, 180)
+        jobs = list(config.shaders)
+        assert [job.input for job in jobs] == ["a.fs", "b.fs"]
+        assert jobs[0].times == [0.0, 0.5]
+        assert len(jobs[1].times) == 90
+
+    def test_invalid_line_is_reported_when_reached(self, tmp_path):
+        """Test that jobs before a bad line are yielded and the error names the line."""
+        path = tmp_path / "jobs.ndjson"
+        path.write_text(
+            json.dumps({"input": "a.fs", "output": "a.png", "times": [0.0]}) + "\n"
+            + json.dumps({"input": "b.fs", "times": [0.0]}) + "\n"
+        )
+        jobs = iter(load_config(path).shaders)
+        assert next(jobs).input == "a.fs"
+        with pytest.raises(ValueError, match="line 2"):
+            next(jobs)
+
+    def test_large_manifest_starts_immediately(self, tmp_path):
+        """Test that the first job of a long manifest is available without reading the rest."""
+        path = tmp_path / "jobs.jsonl"
+        line = json.dumps({"input": "a.fs", "output": "a.png", "times": {"fps": 60, "count": 100000}}) + "\n"
+        path.write_text(line * 20000)
+        start = time.perf_counter()
+        first = next(iter(load_config(path).shaders))
+        assert time.perf_counter() - start < 0.5
+        assert len(first.times) == 100000
@@ -0,0 +1,84 @@
+"""Tests for frame comparison."""
+
+import math
+
+import numpy as np
+import pytest
+
+from isf_shader_renderer.diff import (
+    changed_regions, compare_frames, diff_heatmap, difference_magnitude, psnr, ssim
+)
+
+
+def _noise_frame(seed: int = 0, size=(96, 128)) -> np.ndarray:
+    """Build a reproducible RGBA noise frame."""
+    rng = np.random.default_rng(seed)
+    frame = rng.integers(0, 256, size + (4,), dtype=np.uint8)
+    frame[..., 3] = 255
+    return frame
+
+
+class TestMetrics:
+    """Test PSNR, SSIM and difference magnitude."""
+
+    def test_identical_frames(self):
+        """Test that identical frames report no difference."""
+        frame = _noise_frame()
+        result = compare_frames(frame, frame.copy())
+
+        assert result["identical"] is True
+        assert result["psnr"] is None
+        assert result["ssim"] == pytest.approx(1.0)
+        assert result["changed_fraction"] == 0.0
+        assert result["regions"] == []
+
+    def test_psnr_known_value(self):
+        """Test PSNR for a uniform offset of 16 levels."""
+        a = np.full((8, 8, 3), 100, dtype=np.uint8)
+        b = np.full((8, 8, 3), 116, dtype=np.uint8)
+        assert psnr(a, b) == pytest.approx(10 * math.log10(255 ** 2 / 256), abs=1e-6)
+
+    def test_magnitude_is_symmetric(self):
+        """Test that the difference does not depend on argument order."""
+        a, b = _noise_frame(1), _noise_frame(2)
+        assert np.array_equal(difference_magnitude(a, b), difference_magnitude(b, a))
+
+    def test_ssim_drops_for_different_content(self):
+        """Test that unrelated frames have low structural similarity."""
+        assert ssim(_noise_frame(1), _noise_frame(2)) < 0.2
+
+    def test_size_mismatch(self):
+        """Test that frames must have the same size."""
+        with pytest.raises(ValueError, match="Frame sizes differ"):
+            difference_magnitude(np.zeros((4, 4, 4), np.uint8), np.zeros((4, 5, 4), np.uint8))
+
+
+class TestChangedRegions:
+    """Test bounding boxes of changed areas."""
+
+    def test_two_separate_regions(self):
+        """Test that separate changes produce separate boxes, largest first."""
+        a = np.zeros((128, 128, 4), dtype=np.uint8)
+        b = a.copy()
+        b[10:20, 10:20, 0] = 255
+        b[64:128, 80:128, 1] = 255
+
+        result = compare_frames(a, b)
+
+        assert [(r["x"], r["y"], r["width"], r["height"]) for r in result["regions"]] == [
+            (80, 64, 48, 64),
+            (0, 0, 32, 32),
+        ]
+        assert result["changed_fraction"] == pytest.approx((100 + 64 * 48) / 128 ** 2, abs=1e-4)
+
+    def test_max_regions(self):
+        """Test that the number of regions is capped."""
+        mask = np.zeros((64, 64), dtype=bool)
+        mask[::32, ::32] = True
+        assert len(changed_regions(mask, tile=8, max_regions=2)) == 2
+
+    def test_heatmap_colors(self):
+        """Test that the heatmap is black for no change and white for a full change."""
+        heat = diff_heatmap(np.array([[0, 255]], dtype=np.uint8))
+        assert heat[0, 0].tolist() == [0, 0, 0]
+        assert heat[0, 1].tolist() == [255, 255, 255]
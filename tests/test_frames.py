@@ -0,0 +1,145 @@
+"""Tests for the sync and async frame iterators of a render session."""
+
+import asyncio
+import threading
+
+import numpy as np
+import pytest
+from PIL import Image
+
+from isf_shader_renderer.config import ShaderConfig, ShaderRendererConfig
+from isf_shader_renderer.frames import Frame
+from isf_shader_renderer.renderer import RenderSession, ShaderRenderer
+from isf_shader_renderer.timebase import TimeRange
+
+
+class FakeProgram:
+    """Compiled-program stand-in whose frame brightness encodes the time code."""
+
+    def __init__(self):
+        self.threads = set()
+        self.rendered = []
+
+    def set_input(self, name, value):
+        pass
+
+    def render(self, width, height, time_offset=0.0):
+        self.threads.add(threading.current_thread().name)
+        self.rendered.append(time_offset)
+        self._image = Image.new("RGBA", (width, height), (int(time_offset * 10), 0, 0, 255))
+        return self
+
+    def to_pil_image(self):
+        return self._image
+
+    def __exit__(self, *args):
+        pass
+
+
+@pytest.fixture
+def session():
+    """A RenderSession around a fake program."""
+    session = RenderSession.__new__(RenderSession)
+    session._owner = ShaderRenderer(ShaderRendererConfig())
+    session._renderer = FakeProgram()
+    session._executor = None
+    session.shader_content = "void main() {}"
+    session.shader_config = ShaderConfig(input="x", output="y", times=[0.0], width=8, height=4)
+    yield session
+    session.close()
+
+
+class TestSyncFrames:
+    """Test the generator form."""
+
+    def test_frames_in_order_with_metadata(self, session):
+        """Test frame order, size, timings and pixel content."""
+        frames = [(f.index, f.time, f.width, f.height, int(f.pixels[0, 0, 0])) for f in session.frames([0.0, 1.0, 2.5])]
+        assert frames == [(0, 0.0, 8, 4, 0), (1, 1.0, 8, 4, 10), (2, 2.5, 8, 4, 25)]
+
+    def test_time_range_frames_carry_frame_numbers(self, session):
+        """Test that a range slice yields timebase frame numbers and stays lazy."""
+        stream = session.frames(TimeRange(0, fps=10, count=10**9)[20:23])
+        assert isinstance(stream.time_codes, TimeRange)
+        assert [(f.index, f.time) for f in stream] == [(20, 2.0), (21, 2.1), (22, 2.2)]
+
+    def test_frames_are_rendered_lazily(self, session):
+        """Test that nothing is rendered before the consumer asks."""
+        stream = session.frames([0.0, 1.0, 2.0])
+        assert session._renderer.rendered == []
+        next(iter(stream))
+        assert session._renderer.rendered == [0.0]
+
+    def test_pixels_are_read_only_and_copy_keeps_them(self, session):
+        """Test that views are protected and copies survive buffer reuse."""
+        iterator = iter(session.frames([1.0, 2.0], width=2, height=2))
+        first = next(iterator)
+        with pytest.raises(ValueError):
+            first.pixels[0, 0, 0] = 1
+        kept = first.copy()
+        next(iterator)
+        assert kept.pixels[0, 0, 0] == 10
+
+    def test_image_survives_buffer_reuse(self, session):
+        """Test that to_image() keeps the frame's pixels once the next frame is rendered."""
+        iterator = iter(session.frames([1.0, 2.0], width=2, height=2))
+        image = next(iterator).to_image()
+        next(iterator)
+        assert image.getpixel((0, 0))[0] == 10
+
+    def test_hash_identifies_content(self, session):
+        """Test that equal frames hash equally and different frames do not."""
+        hashes = [f.hash for f in session.frames([1.0, 1.0, 2.0])]
+        assert hashes[0] == hashes[1] != hashes[2]
+        assert len(hashes[0]) == 32
+
+
+class TestAsyncFrames:
+    """Test the async iterator form."""
+
+    def test_async_frames_render_on_the_session_thread(self, session):
+        """Test order, content and that renders leave the event loop thread."""
+        async def collect():
+            return [(f.index, int(f.pixels[0, 0, 0])) async for f in session.frames([0.0, 1.0, 2.0, 3.0])]
+
+        assert asyncio.run(collect()) == [(0, 0), (1, 10), (2, 20), (3, 30)]
+        assert all(name.startswith("render-session") for name in session._renderer.threads)
+
+    def test_held_frame_stays_valid_while_the_next_renders(self, session):
+        """Test that the render-ahead never overwrites the frame the consumer holds."""
+        async def check():
+            async for frame in session.frames([float(t) for t in range(6)]):
+                await asyncio.sleep(0.01)
+                assert frame.pixels[0, 0, 0] == frame.time * 10
+
+        asyncio.run(check())
+
+    def test_early_exit_waits_for_in_flight_renders(self, session):
+        """Test that breaking out of the loop drains pending renders."""
+        async def first_only():
+            stream = session.frames([0.0, 1.0, 2.0])
+            iterator = stream.__aiter__()
+            frame = await iterator.__anext__()
+            await iterator.aclose()
+            return frame.index
+
+        assert asyncio.run(first_only()) == 0
+        assert session._renderer.rendered == [0.0, 1.0]
+
+    def test_errors_propagate(self, session):
+        """Test that a failed render surfaces as the session's RuntimeError."""
+        session._renderer.render = lambda *args, **kwargs: (_ for _ in ()).throw(ValueError("boom"))
+
+        async def consume():
+            async for _ in session.frames([0.0]):
+                pass
+
+        with pytest.raises(RuntimeError):
+            asyncio.run(consume())
+
+
+def test_frame_to_image():
+    """Test conversion of a frame to a PIL image."""
+    pixels = np.zeros((2, 3, 4), dtype=np.uint8)
+    image = Frame(0, 0.0, pixels, 1.0, 0.1).to_image()
+    assert image.size == (3, 2) and image.mode == "RGBA"
@@ -0,0 +1,114 @@
+"""Tests for the golden-image regression store."""
+
+import numpy as np
+import pytest
+
+from isf_shader_renderer.fingerprint import format_hash, hamming_distance, hamming_distances, perceptual_hash
+from isf_shader_renderer.golden import (
+    GoldenEntry, GoldenStore, find_shaders, reference_key, run_regression
+)
+
+
+def _pattern(seed: int, size=(72, 128)) -> np.ndarray:
+    """Build a smooth random RGBA pattern."""
+    rng = np.random.default_rng(seed)
+    coarse = rng.random((9, 16)).astype(np.float32)
+    luma = np.kron(coarse, np.ones((size[0] // 9, size[1] // 16), dtype=np.float32))
+    levels = (luma * 255).astype(np.uint8)
+    return np.stack([levels, levels, levels, np.full_like(levels, 255)], axis=2)
+
+
+def _entry(key: str, phash: int) -> GoldenEntry:
+    return GoldenEntry(
+        key=key, shader=f"{key}.fs", time_code=0.0, width=128, height=72,
+        source_sha256="0" * 64, phash=format_hash(phash), dhash=format_hash(0), image=f"images/{key}.png",
+    )
+
+
+class TestPerceptualHash:
+    """Test the DCT perceptual hash."""
+
+    def test_stable_under_small_noise(self):
+        """Test that slight noise barely moves the hash."""
+        frame = _pattern(0)
+        rng = np.random.default_rng(1)
+        noisy = np.clip(frame.astype(np.int16) + rng.integers(-3, 4, frame.shape), 0, 255).astype(np.uint8)
+        assert hamming_distance(perceptual_hash(frame), perceptual_hash(noisy)) <= 4
+
+    def test_different_images_differ(self):
+        """Test that unrelated images are far apart."""
+        assert hamming_distance(perceptual_hash(_pattern(0)), perceptual_hash(_pattern(2))) > 16
+
+    def test_vectorized_distances(self):
+        """Test that array distances match the scalar version."""
+        values = [0, 0xFFFFFFFFFFFFFFFF, 0x0F0F0F0F0F0F0F0F]
+        distances = hamming_distances(np.array(values, dtype=np.uint64), 0xFF)
+        assert distances.tolist() == [hamming_distance(v, 0xFF) for v in values]
+
+
+@pytest.mark.regression
+class TestGoldenStore:
+    """Test the reference store and corpus checks."""
+
+    def test_key_is_order_independent(self):
+        """Test that input order does not change the key."""
+        assert reference_key("a.fs", 1.0, 64, 64, {"x": 1, "y": 2}) == reference_key("a.fs", 1.0, 64, 64, {"y": 2, "x": 1})
+        assert reference_key("a.fs", 1.0, 64, 64) != reference_key("a.fs", 2.0, 64, 64)
+
+    def test_save_and_reload(self, tmp_path):
+        """Test that entries and images survive a round trip."""
+        store = GoldenStore(tmp_path)
+        store.put(_entry("k1", 0x1234), pixels=_pattern(0))
+        store.save()
+
+        reloaded = GoldenStore(tmp_path)
+        assert len(reloaded) == 1
+        assert reloaded.get("k1").phash == format_hash(0x1234)
+        assert (tmp_path / "images" / "k1.png").exists()
+
+    def test_find_similar(self, tmp_path):
+        """Test near-duplicate lookup by pHash distance."""
+        store = GoldenStore(tmp_path)
+        store.put(_entry("near", 0b1011))
+        store.put(_entry("far", 0xFFFF0000FFFF0000))
+        store.put(_entry("same", 0b1010))
+
+        matches = store.find_similar(0b1010, max_distance=2)
+
+        assert [(entry.key, distance) for entry, distance in matches] == [("same", 0), ("near", 1)]
+
+    def test_update_then_check(self, tmp_path):
+        """Test that a recorded corpus checks clean and new shaders are reported missing."""
+        corpus = tmp_path / "corpus"
+        corpus.mkdir()
+        (corpus / "red.fs").write_text('/*{ "DESCRIPTION": "Red" }*/\nvoid main() { gl_FragColor = vec4(1.0, 0.0, 0.0, 1.0); }')
+        store = GoldenStore(tmp_path / "store")
+
+        recorded = run_regression(store, find_shaders(corpus), [0.0, 1.0], size=(64, 36), update=True)
+        assert [r.status for r in recorded] == ["updated", "updated"]
+        assert len(GoldenStore(tmp_path / "store")) == 2
+
+        (corpus / "green.fs").write_text('/*{ "DESCRIPTION": "Green" }*/\nvoid main() { gl_FragColor = vec4(0.0, 1.0, 0.0, 1.0); }')
+        checked = run_regression(GoldenStore(tmp_path / "store"), find_shaders(corpus), [0.0, 1.0], size=(64, 36))
+        statuses = {(r.shader, r.status) for r in checked}
+        assert statuses == {("red.fs", "ok"), ("green.fs", "missing")}
+
+    def test_inputs_keep_references_apart(self, tmp_path):
+        """Test that suites differing only in inputs record and check separate references."""
+        assert reference_key("a.fs", 0.0, 64, 36, {"uGain": "1"}) != reference_key("a.fs", 0.0, 64, 36, {"uGain": "2"})
+        assert reference_key("a.fs", 0.0, 64, 36, {}) == reference_key("a.fs", 0.0, 64, 36)
+
+        corpus = tmp_path / "corpus"
+        corpus.mkdir()
+        (corpus / "gain.fs").write_text(
+            '/*{"INPUTS": [{"NAME": "uGain", "TYPE": "float", "DEFAULT": 1.0}]}*/\n'
+            'void main() { gl_FragColor = vec4(uGain, 0.0, 0.0, 1.0); }'
+        )
+        store = GoldenStore(tmp_path / "store")
+        run_regression(store, find_shaders(corpus), [0.0], size=(64, 36), update=True, inputs={"uGain": "1"})
+        run_regression(store, find_shaders(corpus), [0.0], size=(64, 36), update=True, inputs={"uGain": "0.5"})
+
+        reloaded = GoldenStore(tmp_path / "store")
+        assert sorted(entry.inputs["uGain"] for entry in reloaded.entries()) == ["0.5", "1"]
+        checked = run_regression(reloaded, find_shaders(corpus), [0.0], size=(64, 36), inputs={"uGain": "2"})
+        assert [r.status for r in checked] == ["missing"]
@@ -10,6 +10,7 @@ from isf_shader_renderer.mcp.models import (
     GetShaderInfoRequest, GetShaderInfoResponse
 )
 from isf_shader_renderer.mcp.handlers import ISFShaderHandlers
+from isf_shader_renderer.mcp.streaming import Base64File
 from isf_shader_renderer.mcp.utils import (
     validate_shader_content, extract_shader_metadata, sanitize_filename,
     create_temp_file, encode_image_to_base64, decode_base64_to_image
@@ -49,6 +50,22 @@ class TestMCPModels:
         assert request.quality == 95
         assert request.verbose is False
     
+    def test_render_request_keyframes(self):
+        """Test keyframe mode replaces explicit time codes."""
+        request = RenderRequest(
+            shader_content="/* ISF shader */ void main() { gl_FragColor = vec4(1.0); }",
+            keyframes=4,
+            end_time=5.0
+        )
+        
+        assert request.time_codes == []
+        assert request.frame_count == 4
+        
+        with pytest.raises(ValueError):
+            RenderRequest(shader_content="void main() {}")
+        with pytest.raises(ValueError):
+            RenderRequest(shader_content="void main() {}", time_codes=[0.0], keyframes=2)
+    
     def test_validate_request(self):
         """Test validate request."""
         request = ValidateRequest(
@@ -57,6 +74,15 @@ class TestMCPModels:
         
         assert request.shader_content == "/* ISF shader */ void main() { gl_FragColor = vec4(1.0); }"
     
+    def test_render_response_frames(self):
+        """Test that rendered frames may be base64 strings or lazily encoded files."""
+        frame = Base64File("frame.jpg")
+        response = RenderResponse(success=True, message="ok", rendered_frames=["aGk=", frame])
+        
+        assert response.model_dump()["rendered_frames"][1] is frame
+        with pytest.raises(ValueError):
+            RenderResponse(success=True, message="ok", rendered_frames=[{"path": "frame.jpg"}])
+    
     def test_get_shader_info_request(self):
         """Test get shader info request."""
         request = GetShaderInfoRequest(
@@ -223,6 +249,53 @@ void main() {
         assert "shader_info" in result
         assert result["metadata"]["frame_count"] == 2
     
+    @pytest.mark.asyncio
+    async def test_render_shader_with_stats(self, handlers):
+        """Test that per-frame statistics flag a blank render."""
+        shader_content = """/*{
+    "DESCRIPTION": "Black shader"
+}*/
+void main() {
+    gl_FragColor = vec4(0.0, 0.0, 0.0, 1.0);
+}"""
+        
+        result = await handlers.call_tool("render_shader", {
+            "shader_content": shader_content,
+            "time_codes": [0.0],
+            "width": 64,
+            "height": 64,
+            "include_stats": True
+        })
+        
+        assert result["success"] is True
+        stats = result["metadata"]["rendered_files"][0]["stats"]
+        assert stats["width"] == 64
+        assert "luminance_histogram" in stats
+        assert "edge_density" in stats
+    
+    @pytest.mark.asyncio
+    async def test_diff_shaders_identical(self, handlers):
+        """Test that comparing a shader with itself reports no change."""
+        shader_content = """/*{
+    "DESCRIPTION": "Solid shader"
+}*/
+void main() {
+    gl_FragColor = vec4(0.2, 0.4, 0.6, 1.0);
+}"""
+        
+        result = await handlers.call_tool("diff_shaders", {
+            "shader_content": shader_content,
+            "shader_content_b": shader_content,
+            "time_codes": [0.0, 1.0],
+            "width": 64,
+            "height": 64
+        })
+        
+        assert result["success"] is True
+        assert len(result["comparisons"]) == 2
+        assert all(c["identical"] for c in result["comparisons"])
+        assert len(result["heatmaps"]) == 2
+    
     @pytest.mark.asyncio
     async def test_render_shader_invalid(self, handlers):
         """Test shader rendering with invalid shader."""
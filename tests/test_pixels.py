@@ -0,0 +1,129 @@
+"""Tests for the pixel conversion kernels."""
+
+from fractions import Fraction
+
+import numpy as np
+import pytest
+from PIL import Image
+
+from isf_shader_renderer.pixels import (
+    BLOCK_ROWS,
+    drop_alpha,
+    flip_vertical,
+    image_format,
+    linear_to_srgb,
+    output_image,
+    premultiply,
+    srgb_to_linear,
+    to_16bit,
+    to_8bit,
+    unpremultiply,
+)
+
+
+@pytest.fixture
+def frame():
+    """A random RGBA frame taller than one kernel block."""
+    return np.random.default_rng(7).integers(0, 256, (2 * BLOCK_ROWS + 5, 9, 4), dtype=np.uint8)
+
+
+class TestLayoutKernels:
+    """Test row flipping and alpha removal."""
+
+    @pytest.mark.parametrize("height", [1, 2, 7, BLOCK_ROWS, 2 * BLOCK_ROWS + 5])
+    def test_flip_vertical_in_place(self, frame, height):
+        """Test that rows are reversed in the same array for odd, even and multi-block heights."""
+        pixels = frame[:height].copy()
+        assert flip_vertical(pixels) is pixels
+        assert (pixels == frame[:height][::-1]).all()
+
+    def test_drop_alpha_into_buffer(self, frame):
+        """Test that the RGB channels land in the given buffer."""
+        out = np.empty(frame.shape[:2] + (3,), dtype=np.uint8)
+        assert drop_alpha(frame, out=out) is out
+        assert (out == frame[..., :3]).all()
+
+
+class TestAlphaKernels:
+    """Test premultiplied and straight alpha conversions."""
+
+    def test_premultiply_rounds_exactly(self, frame):
+        """Test premultiplication against exact rounding of c * a / 255."""
+        pixels = frame.copy()
+        premultiply(pixels)
+        expected = np.floor(frame[..., :3].astype(np.float64) * frame[..., 3:] / 255 + 0.5)
+        assert (pixels[..., :3] == expected).all()
+        assert (pixels[..., 3] == frame[..., 3]).all()
+
+    def test_round_trip_is_lossless_for_opaque_pixels(self, frame):
+        """Test that unpremultiply undoes premultiply where alpha is 255."""
+        pixels = frame.copy()
+        pixels[..., 3] = 255
+        original = pixels.copy()
+        unpremultiply(premultiply(pixels))
+        assert (pixels == original).all()
+
+    def test_unpremultiply_clamps_and_handles_zero_alpha(self):
+        """Test that colors over alpha saturate and transparent pixels become black."""
+        pixels = np.array([[[200, 10, 0, 100], [50, 60, 70, 0]]], dtype=np.uint8)
+        unpremultiply(pixels)
+        assert pixels[0, 0].tolist() == [255, 26, 0, 100]
+        assert pixels[0, 1].tolist() == [0, 0, 0, 0]
+
+    def test_rejects_other_layouts(self):
+        """Test that non-RGBA8 arrays are refused."""
+        with pytest.raises(ValueError):
+            premultiply(np.zeros((2, 2, 3), dtype=np.uint8))
+
+
+class TestColorAndQuantization:
+    """Test sRGB transfer and bit-depth conversion."""
+
+    def test_srgb_round_trip(self, frame):
+        """Test that every 8-bit code survives decoding to 16-bit linear and back."""
+        linear = srgb_to_linear(frame)
+        assert linear.dtype == np.uint16
+        assert (linear_to_srgb(linear) == frame).all()
+
+    def test_srgb_reference_points(self):
+        """Test the transfer curve at black, mid grey and white."""
+        pixels = np.array([[[0, 188, 255, 255]]], dtype=np.uint8)
+        linear = srgb_to_linear(pixels)[0, 0]
+        assert linear[0] == 0 and linear[2] == 65535 and linear[3] == 65535
+        assert abs(linear[1] / 65535 - 0.5) < 0.005
+
+    def test_16_to_8_bit_is_exactly_rounded(self):
+        """Test every 16-bit value against exact rational rounding."""
+        values = np.arange(65536, dtype=np.uint16)
+        result = to_8bit(values)
+        expected = [int(Fraction(v * 255, 65535) + Fraction(1, 2)) for v in range(0, 65536, 97)]
+        assert result[::97].tolist() == expected
+
+    def test_bit_depth_round_trips(self, frame):
+        """Test that 8-bit codes widen exactly and narrow back unchanged."""
+        wide = to_16bit(frame)
+        assert (wide == frame.astype(np.uint16) * 257).all()
+        assert (to_8bit(wide) == frame).all()
+
+    def test_float_quantization_clips(self):
+        """Test that float values are clipped to [0, 1] and rounded."""
+        values = np.array([-0.5, 0.0, 0.5, 1.0, 2.0])
+        assert to_8bit(values).tolist() == [0, 0, 128, 255, 255]
+        assert to_16bit(values).tolist() == [0, 0, 32768, 65535, 65535]
+
+
+class TestOutputImage:
+    """Test the conversion used by output sinks."""
+
+    def test_jpeg_frames_lose_alpha(self):
+        """Test that an RGBA frame bound for JPEG is yielded as RGB."""
+        image = Image.new("RGBA", (4, 3), (10, 20, 30, 40))
+        with output_image(image, image_format("frame.jpg")) as savable:
+            assert savable.mode == "RGB"
+            assert savable.getpixel((3, 2)) == (10, 20, 30)
+
+    def test_alpha_formats_are_passed_through(self):
+        """Test that PNG output keeps the frame untouched."""
+        image = Image.new("RGBA", (4, 3))
+        with output_image(image, image_format("frame.png")) as savable:
+            assert savable is image
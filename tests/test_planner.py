@@ -0,0 +1,180 @@
+"""Tests for dry-run render planning."""
+
+import subprocess
+import sys
+
+import pytest
+
+from isf_shader_renderer.config import ShaderConfig, ShaderRendererConfig
+from isf_shader_renderer.planner import (
+    JobPlan,
+    ProfileCache,
+    RenderPlan,
+    ShaderProfile,
+    plan_render,
+    probe_shader,
+    profile_key,
+)
+from isf_shader_renderer.renderer import ShaderRenderer
+from isf_shader_renderer.timebase import TimeRange
+
+SHADER = """/*{"INPUTS": []}*/
+void main() { gl_FragColor = vec4(fract(TIME), 0.5, 0.5, 1.0); }"""
+
+
+def _profile(**overrides):
+    values = dict(
+        compile_seconds=1.0,
+        frame_seconds=0.01,
+        pixel_seconds=1e-7,
+        encode_pixel_seconds=2e-8,
+        file_bytes=100.0,
+        pixel_bytes=0.5,
+        process_bytes=100 << 20,
+    )
+    values.update(overrides)
+    return ShaderProfile(**values)
+
+
+def _job(frames=10_000, profile=None):
+    return JobPlan("a.fs", frames, 1920, 1080, profile or _profile())
+
+
+class TestJobPlan:
+    """Test per-job predictions."""
+
+    def test_serial_time_overlaps_encoding(self):
+        """Test that one process pays for the slower of render and encode per frame."""
+        job = _job(frames=100)
+        render = 0.01 + 1e-7 * 1920 * 1080
+        assert job.wall_seconds(1) == pytest.approx(1.0 + 100 * render)
+        assert job.output_bytes == int(100 * (100 + 0.5 * 1920 * 1080))
+
+    def test_workers_are_limited_by_cores(self):
+        """Test that workers beyond the cores do not help."""
+        job = _job()
+        assert job.wall_seconds(4, cores=4) < job.wall_seconds(1) / 3
+        assert job.wall_seconds(8, cores=4) >= job.wall_seconds(4, cores=4)
+
+    def test_stateful_jobs_do_not_shard(self):
+        """Test that a persistent shader is one shard whatever the worker count."""
+        job = _job(profile=_profile(stateful="it has persistent buffers"))
+        assert job.shards(8) == 1
+        assert job.peak_bytes(8) < _job().peak_bytes(8)
+
+    def test_pass_textures_add_memory(self):
+        """Test that a job's pass textures count in every process that renders it."""
+        job = _job()
+        job.target_bytes = 1 << 20
+        assert job.peak_bytes(1) - _job().peak_bytes(1) == 1 << 20
+        assert job.peak_bytes(4) - _job().peak_bytes(4) == 4 << 20
+
+    def test_shader_memory_counts_in_rendering_processes(self):
+        """Test that a probe's growth is added per worker but not to the coordinating process."""
+        job = _job(profile=_profile(shader_bytes=10 << 20))
+        assert job.peak_bytes(1) - _job().peak_bytes(1) == 10 << 20
+        assert job.peak_bytes(4) - _job().peak_bytes(4) == 40 << 20
+
+    def test_plan_uses_the_render_graph(self, tmp_path):
+        """Test that a planned job carries its aliased pass footprint."""
+        shader = '/*{"PASSES": [{"TARGET": "a", "WIDTH": "$WIDTH/2", "HEIGHT": "$HEIGHT/2"}, {}]}*/\n' \
+            'void main() { gl_FragColor = PASSINDEX == 0 ? vec4(1.0) : IMG_THIS_PIXEL(a); }'
+        config = ShaderConfig(input="a.fs", output=str(tmp_path / "f.png"), times=[0.0], width=64, height=32)
+        plan = plan_render(ShaderRenderer(ShaderRendererConfig()), [(shader, config)])
+        assert plan.jobs[0].target_bytes == 32 * 16 * 4
+
+    def test_admission_ignores_aliasing(self):
+        """Test that peak memory counts every pass texture and aliasing is only a projection."""
+        job = _job()
+        job.target_bytes, job.aliased_target_bytes = 8 << 20, 2 << 20
+        assert job.peak_bytes(4) - _job().peak_bytes(4) == 4 * (8 << 20)
+        assert job.peak_bytes(4) - job.peak_bytes(4, aliased=True) == 4 * (6 << 20)
+
+
+class TestBestJobs:
+    """Test choosing the worker count."""
+
+    def test_uses_the_cores(self):
+        """Test that a long stateless job uses every core."""
+        assert RenderPlan([_job()], cores=8, memory_bytes=None).best_jobs() == 8
+
+    def test_short_jobs_stay_serial(self):
+        """Test that startup and compile costs keep a short job in one process."""
+        assert RenderPlan([_job(frames=20)], cores=8, memory_bytes=None).best_jobs() == 1
+
+    def test_memory_budget(self):
+        """Test that the worker count is capped by memory."""
+        plan = RenderPlan([_job()], cores=16, memory_bytes=1 << 30)
+        best = plan.best_jobs()
+        assert 1 < best < 16
+        assert plan.peak_bytes(best) <= (1 << 30)
+
+
+class TestProbe:
+    """Test probe renders and the profile cache."""
+
+    def _config(self, tmp_path, **kwargs):
+        return ShaderConfig(
+            input="a.fs", output=str(tmp_path / "f_%04d.png"), times=TimeRange(0, fps=30, count=900), **kwargs
+        )
+
+    def test_probe_writes_nothing(self, tmp_path):
+        """Test that a probe measures the shader without writing frames."""
+        profile = probe_shader(ShaderRenderer(ShaderRendererConfig()), SHADER, self._config(tmp_path))
+        assert profile.pixel_bytes > 0 and profile.compile_seconds > 0
+        assert profile.stateful is None
+        assert not list(tmp_path.iterdir())
+
+    def test_memory_is_measured_per_probe(self, tmp_path, monkeypatch):
+        """Test that a probe reports its own growth, not the process's earlier peak."""
+        resident = iter([300 << 20, 340 << 20])
+        monkeypatch.setattr("isf_shader_renderer.planner._resident_bytes", lambda: next(resident))
+        monkeypatch.setattr("isf_shader_renderer.planner._peak_resident_bytes", lambda: 2 << 30)
+        profile = probe_shader(ShaderRenderer(ShaderRendererConfig()), SHADER, self._config(tmp_path))
+        assert (profile.process_bytes, profile.shader_bytes) == (300 << 20, 40 << 20)
+
+    def test_peak_rise_during_probe_counts(self, tmp_path, monkeypatch):
+        """Test that a transient spike above the old high-water mark is attributed to the probe."""
+        resident = iter([300 << 20, 310 << 20])
+        peaks = iter([400 << 20, 500 << 20])
+        monkeypatch.setattr("isf_shader_renderer.planner._resident_bytes", lambda: next(resident))
+        monkeypatch.setattr("isf_shader_renderer.planner._peak_resident_bytes", lambda: next(peaks))
+        profile = probe_shader(ShaderRenderer(ShaderRendererConfig()), SHADER, self._config(tmp_path))
+        assert profile.shader_bytes == 200 << 20
+
+    def test_cache_is_reused(self, tmp_path):
+        """Test that a second plan reads the profile instead of probing."""
+        renderer = ShaderRenderer(ShaderRendererConfig())
+        config = self._config(tmp_path)
+        cache_path = tmp_path / "plan.profile"
+        first = plan_render(renderer, [(SHADER, config)], cache=ProfileCache(cache_path))
+        assert not first.jobs[0].cached
+        second = plan_render(renderer, [(SHADER, config)], cache=ProfileCache(cache_path))
+        assert second.jobs[0].cached and second.jobs[0].profile == first.jobs[0].profile
+        assert second.frames == 900
+
+    def test_key_ignores_size_but_not_inputs(self, tmp_path):
+        """Test that resizing reuses a profile and changing inputs does not."""
+        config = self._config(tmp_path)
+        key = profile_key(SHADER, config)
+        assert profile_key(SHADER, self._config(tmp_path, width=64)) == key
+        assert profile_key(SHADER, self._config(tmp_path, inputs={"x": 1.0})) != key
+
+    def test_failed_probe_is_reported(self, tmp_path):
+        """Test that a shader that does not compile is listed, not fatal."""
+        plan = plan_render(ShaderRenderer(ShaderRendererConfig()), [("void helper() {}", self._config(tmp_path))])
+        assert not plan.jobs and plan.failed[0][0] == "a.fs"
+
+
+def test_cli_plan_renders_nothing(tmp_path):
+    """Test that --plan prints predictions and writes no frames."""
+    shader = tmp_path / "a.fs"
+    shader.write_text(SHADER)
+    result = subprocess.run([
+        sys.executable, '-m', 'isf_shader_renderer.cli', str(shader),
+        '--output', str(tmp_path / "out" / "f_%04d.png"),
+        '--frames', '600', '--plan', '--ai-info',
+    ], capture_output=True, text=True, check=True)
+    assert "600 frames at 1920x1080" in result.stdout
+    assert "Recommended --jobs" in result.stdout
+    assert not (tmp_path / "out").exists()
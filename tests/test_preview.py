@@ -0,0 +1,87 @@
+"""Tests for the /preview WebSocket."""
+
+from io import BytesIO
+
+import pytest
+from fastapi.testclient import TestClient
+from PIL import Image
+
+from isf_shader_renderer.mcp.http_server import ISFShaderHTTPServer
+from isf_shader_renderer.mcp.preview import MIN_PREVIEW_SCALE, AdaptiveResolution
+
+SHADER = """/*{
+    "INPUTS": [{"NAME": "uGain", "TYPE": "float", "DEFAULT": 1.0}]
+}*/
+void main() { gl_FragColor = vec4(0.2, 0.4, 0.6, 1.0) * uGain; }"""
+
+
+@pytest.fixture
+def client():
+    """Test client of the HTTP server."""
+    return TestClient(ISFShaderHTTPServer().app)
+
+
+def receive_frame(websocket):
+    """Return the next JPEG frame as a PIL image, skipping stats messages."""
+    while True:
+        message = websocket.receive()
+        if message.get("bytes") is not None:
+            return Image.open(BytesIO(message["bytes"]))
+
+
+class TestAdaptiveResolution:
+    """Test the resolution controller."""
+
+    def test_scales_down_when_frames_are_slow(self):
+        """Test that frames over budget shrink the resolution to the floor."""
+        scaler = AdaptiveResolution()
+        for _ in range(20):
+            scaler.update(0.1, 1 / 30)
+        assert scaler.scale == MIN_PREVIEW_SCALE
+        assert scaler.size(640, 360) == (160, 90)
+
+    def test_recovers_when_frames_are_fast(self):
+        """Test that sustained headroom grows the resolution back to full size."""
+        scaler = AdaptiveResolution()
+        scaler.update(0.1, 1 / 30)
+        assert scaler.scale < 1.0
+        for _ in range(300):
+            scaler.update(0.001, 1 / 30)
+        assert scaler.scale == 1.0
+
+
+class TestPreviewWebSocket:
+    """Test the preview protocol."""
+
+    def test_streams_jpeg_frames_and_accepts_updates(self, client):
+        """Test that frames arrive at the requested size and input updates are accepted."""
+        with client.websocket_connect("/preview") as websocket:
+            websocket.send_json({"shader_content": SHADER, "width": 64, "height": 32, "fps": 60})
+            frame = receive_frame(websocket)
+            assert frame.format == "JPEG"
+            assert frame.size[0] <= 64 and frame.size[1] <= 32
+
+            websocket.send_json({"inputs": {"uGain": 0.5}, "width": 32, "height": 16})
+            for _ in range(10):
+                frame = receive_frame(websocket)
+                if frame.size[0] <= 32:
+                    break
+            assert frame.size[0] <= 32
+
+    def test_first_message_needs_shader(self, client):
+        """Test that a connection without shader source is refused with an error."""
+        with client.websocket_connect("/preview") as websocket:
+            websocket.send_json({"width": 64})
+            message = websocket.receive_json()
+            assert message["type"] == "error"
+            assert "shader_content" in message["message"]
+
+    def test_compile_errors_are_reported(self, client):
+        """Test that a broken shader yields an error message, not a closed socket."""
+        with client.websocket_connect("/preview") as websocket:
+            websocket.send_json({"shader_content": "/*{}*/ not a shader", "time": 0.0})
+            message = websocket.receive_json()
+            assert message["type"] == "error"
+
+            websocket.send_json({"shader_content": SHADER, "width": 32, "height": 16})
+            assert receive_frame(websocket).format == "JPEG"
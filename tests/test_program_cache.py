@@ -0,0 +1,115 @@
+"""Tests for the compiled program cache."""
+
+import json
+
+from isf_shader_renderer.config import ShaderConfig, ShaderRendererConfig
+from isf_shader_renderer.program_cache import ProgramCache, header_defaults, program_key
+from isf_shader_renderer.renderer import ShaderRenderer
+from isf_shader_renderer.specialize import split_isf_source
+
+SHADER = """/*{
+    "DESCRIPTION": "Program cache test",
+    "INPUTS": [
+        {"NAME": "uGain", "TYPE": "float", "DEFAULT": 1.0, "MIN": 0.0, "MAX": 2.0},
+        {"NAME": "uTint", "TYPE": "color", "DEFAULT": [1.0, 1.0, 1.0, 1.0]}
+    ]
+}*/
+void main() {
+    gl_FragColor = uTint * uGain;
+}"""
+
+
+def edit_header(shader: str, **changes) -> str:
+    """Return the shader with the first input's header fields changed."""
+    metadata, _, body = split_isf_source(shader)
+    metadata["INPUTS"][0].update(changes)
+    return "/*" + json.dumps(metadata) + "*/" + body
+
+
+class TestProgramKey:
+    """Test which edits map to the same compiled program."""
+
+    def test_metadata_edits_share_a_key(self):
+        """Test that DEFAULT, LABEL and MIN/MAX edits keep the key."""
+        key = program_key(SHADER)
+        assert program_key(edit_header(SHADER, DEFAULT=0.25)) == key
+        assert program_key(edit_header(SHADER, LABEL="Gain", MIN=-1.0, MAX=4.0)) == key
+        assert program_key(SHADER.replace("Program cache test", "Renamed")) == key
+
+    def test_structural_edits_change_the_key(self):
+        """Test that body and input type changes need a new program."""
+        key = program_key(SHADER)
+        assert program_key(SHADER.replace("uTint * uGain", "uTint")) != key
+        assert program_key(edit_header(SHADER, TYPE="long")) != key
+        assert program_key(edit_header(SHADER, NAME="uLevel")) != key
+
+    def test_persistent_shaders_are_not_shared(self):
+        """Test that shaders with persistent buffers get no key."""
+        metadata, _, body = split_isf_source(SHADER)
+        metadata["PASSES"] = [{"TARGET": "feedback", "PERSISTENT": True}, {}]
+        assert program_key("/*" + json.dumps(metadata) + "*/" + body) is None
+
+    def test_header_defaults(self):
+        """Test that defaults are listed with arrays as tuples."""
+        assert header_defaults(SHADER) == [("uGain", 1.0), ("uTint", (1.0, 1.0, 1.0, 1.0))]
+        assert header_defaults("void main() {}") == []
+
+
+class TestProgramCache:
+    """Test program reuse and eviction."""
+
+    def test_header_edit_reuses_program(self):
+        """Test that a DEFAULT edit hits the cache and rebinds the default."""
+        cache = ProgramCache()
+        first, cached = cache.acquire(SHADER)
+        assert cached
+        second, _ = cache.acquire(edit_header(SHADER, DEFAULT=0.25))
+
+        assert second is first
+        assert cache.stats() == {"size": 1, "hits": 1, "misses": 1}
+        cache.clear()
+        assert len(cache) == 0
+
+    def test_least_recently_used_is_evicted(self):
+        """Test that the cache stays within its size."""
+        cache = ProgramCache(max_size=2)
+        shaders = [SHADER.replace("uTint * uGain", f"uTint * uGain * {i}.0") for i in range(3)]
+        for shader in shaders:
+            cache.acquire(shader)
+        assert len(cache) == 2
+
+        cache.acquire(shaders[0])
+        assert cache.misses == 4
+
+    def test_renderer_reuses_program_for_header_edits(self, tmp_path):
+        """Test that render_frame compiles once across DEFAULT edits."""
+        renderer = ShaderRenderer(ShaderRendererConfig())
+        config = ShaderConfig(input="test.fs", output="", times=[0.0], width=16, height=16)
+
+        renderer.render_frame(SHADER, 0.0, tmp_path / "a.png", config)
+        renderer.render_frame(edit_header(SHADER, DEFAULT=0.5), 0.0, tmp_path / "b.png", config)
+
+        assert renderer._programs.stats()["misses"] == 1
+        assert (tmp_path / "b.png").exists()
+        renderer.cleanup()
+
+    def test_inputs_without_default_are_reset(self, tmp_path):
+        """Test that a render without an input does not inherit the previous render's value."""
+        shader = """/*{"INPUTS": [
+            {"NAME": "uLevel", "TYPE": "float"},
+            {"NAME": "uFloor", "TYPE": "float", "MIN": 0.25},
+            {"NAME": "inputImage", "TYPE": "image"}
+        ]}*/
+        void main() { gl_FragColor = vec4(uLevel + uFloor); }"""
+        renderer = ShaderRenderer(ShaderRendererConfig())
+        config = ShaderConfig(input="a.fs", output="", times=[0.0], width=16, height=16)
+        with_inputs = ShaderConfig(**{**config.__dict__, "inputs": {"uLevel": 0.75, "uFloor": 0.5}})
+
+        renderer.render_frame(shader, 0.0, tmp_path / "a.png", with_inputs)
+        renderer.render_frame(shader, 0.0, tmp_path / "b.png", config)
+
+        program = next(iter(renderer._programs._programs.values()))
+        assert program._inputs["uLevel"] == 0.0
+        assert program._inputs["uFloor"] == 0.25
+        assert program._inputs["inputImage"].size == (1, 1)
+        renderer.cleanup()
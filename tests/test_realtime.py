@@ -0,0 +1,132 @@
+"""Tests for real-time rendering into the shared-memory frame ring."""
+
+import subprocess
+import sys
+import time
+import uuid
+
+import numpy as np
+import pytest
+
+from isf_shader_renderer.config import ShaderConfig, ShaderRendererConfig
+from isf_shader_renderer.realtime import DeadlineScheduler, FrameRing, run_realtime
+from isf_shader_renderer.renderer import ShaderRenderer
+
+SHADER = """/*{"INPUTS": []}*/
+void main() { gl_FragColor = vec4(0.2, 0.4, 0.6, 1.0); }"""
+
+
+@pytest.fixture
+def ring():
+    """A small ring with a unique segment name."""
+    ring = FrameRing.create(8, 4, slots=3, name=f"isf-test-{uuid.uuid4().hex[:8]}", fps=30.0)
+    yield ring
+    ring.close()
+
+
+class FakeClock:
+    """Monotonic clock advanced by hand (nanoseconds)."""
+
+    def __init__(self):
+        self.now = 1_000_000_000
+
+    def __call__(self):
+        return self.now
+
+
+class TestFrameRing:
+    """Test the shared-memory layout seen by consumers."""
+
+    def test_consumer_sees_published_frames_without_copies(self, ring):
+        """Test that an attached consumer reads the header, slot table and pixels."""
+        consumer = FrameRing.attach(ring.name)
+        assert (consumer.width, consumer.height, consumer.slots, consumer.fps) == (8, 4, 3, 30.0)
+        assert consumer.latest_sequence == 0
+
+        for sequence in (1, 2, 3, 4):
+            ring.begin_write(sequence)[...] = sequence * 10
+            ring.publish(sequence, sequence / 30.0, 123)
+
+        latest = consumer.latest_sequence
+        view = consumer.frame_view(latest)
+        assert latest == 4
+        assert consumer.slot(latest) == (4, pytest.approx(4 / 30.0), 123)
+        assert np.all(view == 40)
+        # Frame 4 reused frame 1's slot
+        assert np.shares_memory(consumer.frame_view(1), view)
+        consumer.close()
+
+    def test_consumer_exiting_first_keeps_the_ring(self, ring):
+        """Test that a consumer process exiting does not remove the producer's segment."""
+        ring.publish(1, 0.0, 1)
+        subprocess.run([
+            sys.executable, "-c",
+            f"from isf_shader_renderer.realtime import FrameRing; FrameRing.attach({ring.name!r}).close()",
+        ], check=True)
+        # The consumer's resource tracker cleans up after the consumer has exited
+        time.sleep(0.5)
+        consumer = FrameRing.attach(ring.name)
+        assert consumer.latest_sequence == 1
+        consumer.close()
+
+    def test_slot_is_invalid_while_written(self, ring):
+        """Test that begin_write clears the slot's sequence number."""
+        ring.begin_write(1)
+        ring.publish(1, 0.0, 1)
+        ring.begin_write(4)
+        assert ring.slot(4)[0] == 0
+
+
+class TestDeadlineScheduler:
+    """Test deadline accounting on a fake clock."""
+
+    def test_frames_behind_schedule_are_dropped(self):
+        """Test that a slow frame drops the slots it overran."""
+        clock = FakeClock()
+        scheduler = DeadlineScheduler(100.0, clock=clock)
+
+        frame, time_code = scheduler.next()
+        assert (frame, time_code) == (0, 0.0)
+        clock.now += 2_000_000
+        wait = scheduler.finish(frame, clock.now)
+        assert wait == 8_000_000
+
+        # The next frame takes 35 ms: frames 2 and 3 are skipped, 4 is due now
+        clock.now += 8_000_000
+        frame, _ = scheduler.next()
+        clock.now += 35_000_000
+        scheduler.finish(frame, clock.now)
+        frame, time_code = scheduler.next()
+
+        stats = scheduler.summary()
+        assert frame == 4 and time_code == pytest.approx(0.04)
+        assert stats.dropped == 2 and stats.late == 1 and stats.frames == 2
+        assert stats.latency_max_ms == pytest.approx(35.0)
+
+
+class TestRealtimeRun:
+    """Test the real-time loop end to end."""
+
+    def test_run_publishes_frames(self, ring):
+        """Test that a short run renders into the ring on schedule."""
+        times = []
+
+        def render(time_code, out):
+            times.append(time_code)
+            out[...] = len(times)
+
+        stats = run_realtime(render, ring, fps=200.0, duration=0.1)
+
+        assert stats.frames == len(times) > 0
+        assert stats.frames + stats.dropped <= 21
+        assert ring.latest_sequence >= stats.frames
+        assert times == sorted(times)
+
+    def test_session_renders_into_ring_buffers(self, ring):
+        """Test that a compiled session fills a ring slot in place."""
+        renderer = ShaderRenderer(ShaderRendererConfig())
+        with renderer.session(SHADER, ShaderConfig(input="", output="", times=[0.0])) as session:
+            buffer = ring.begin_write(1)
+            result = session.render_into(0.5, buffer)
+        assert result is buffer
+        assert np.all(buffer[..., 3] == 255)
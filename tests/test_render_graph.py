@@ -0,0 +1,138 @@
+"""Tests for the render-graph IR of multipass shaders."""
+
+import json
+
+import pytest
+
+from isf_shader_renderer.render_graph import RenderGraph, evaluate_dimension, shader_footprint
+
+
+def _shader(passes, body, inputs=None):
+    header = {"INPUTS": inputs or [], "PASSES": passes}
+    return f"/*{json.dumps(header)}*/\n{body}"
+
+
+def _blur_chain(count, size="$WIDTH/2"):
+    """A downsample followed by alternating blurs, each reading the pass before it."""
+    passes = [{"TARGET": f"p{i}", "WIDTH": size, "HEIGHT": size.replace("WIDTH", "HEIGHT")} for i in range(count)]
+    branches = ["if (PASSINDEX == 0) { gl_FragColor = IMG_THIS_PIXEL(inputImage); }"]
+    for i in range(1, count):
+        branches.append(f"else if (PASSINDEX == {i}) {{ gl_FragColor = IMG_NORM_PIXEL(p{i - 1}, isf_FragNormCoord); }}")
+    branches.append(f"else {{ gl_FragColor = IMG_NORM_PIXEL(p{count - 1}, isf_FragNormCoord); }}")
+    body = "void main() {\n" + "\n".join(branches) + "\n}"
+    return _shader(passes + [{}], body, [{"NAME": "inputImage", "TYPE": "image"}])
+
+
+class TestSizeExpressions:
+    """Test WIDTH/HEIGHT expressions."""
+
+    @pytest.mark.parametrize("expression,expected", [
+        ("$WIDTH/2", 960), ("floor($HEIGHT/3.0)", 360), ("max($WIDTH/4096, 1)", 1), (256, 256), ("$WIDTH*0", 1),
+        ("2**10", 1024), ("pow(2, 9)", 512),
+    ])
+    def test_evaluates(self, expression, expected):
+        """Test arithmetic, functions and the minimum of one pixel."""
+        assert evaluate_dimension(expression, 1920, 1080) == expected
+
+    def test_inputs(self):
+        """Test that $name reads input values, including strings from the command line."""
+        assert evaluate_dimension("$WIDTH/$scale", 1920, 1080, {"scale": "4"}) == 480
+
+    @pytest.mark.parametrize("expression", ["$WIDTH/$missing", "__import__('os')", "$WIDTH.real", "$WIDTH/0", "("])
+    def test_rejects(self, expression):
+        """Test that unknown names, anything but arithmetic, and bad math raise ValueError."""
+        with pytest.raises(ValueError):
+            evaluate_dimension(expression, 1920, 1080)
+
+    @pytest.mark.parametrize("expression", ["9**9**9", "pow(9, pow(9, 9))", "exp2(9**9)", "$WIDTH**$WIDTH**$WIDTH"])
+    def test_huge_powers_fail_fast(self, expression):
+        """Test that powers too large for a size overflow quickly instead of hanging."""
+        with pytest.raises(ValueError, match="Cannot evaluate"):
+            evaluate_dimension(expression, 1920, 1080)
+
+
+class TestGraph:
+    """Test pass dependencies and lifetimes."""
+
+    def test_chain_reads_only_its_branch(self):
+        """Test that each branch of a PASSINDEX chain, and the final else, reads only its own targets."""
+        graph = RenderGraph.from_shader(_blur_chain(4))
+        assert [sorted(p.reads) for p in graph.passes] == [[], ["p0"], ["p1"], ["p2"], ["p3"]]
+        assert graph.edges() == [(0, 1, "p0"), (1, 2, "p1"), (2, 3, "p2"), (3, 4, "p3")]
+        assert [graph.targets[f"p{i}"].lifetime(5) for i in range(4)] == [(0, 1), (1, 2), (2, 3), (3, 4)]
+
+    def test_or_tests_and_unrelated_conditions(self):
+        """Test passes joined by || and code under other conditions, which runs in every pass."""
+        body = """void main() {
+            if (PASSINDEX == 0 || PASSINDEX == 2) { gl_FragColor = IMG_THIS_PIXEL(a); }
+            if (TIME > 1.0) { gl_FragColor += IMG_THIS_PIXEL(b); }
+            if (PASSINDEX > 0) { gl_FragColor += IMG_THIS_PIXEL(c); }
+        }"""
+        graph = RenderGraph.from_shader(_shader([{"TARGET": "a"}, {"TARGET": "b"}, {"TARGET": "c"}, {}], body))
+        assert [sorted(p.reads) for p in graph.passes] == [["a", "b", "c"], ["b", "c"], ["a", "b", "c"], ["b", "c"]]
+
+    def test_reading_before_writing_carries_the_target(self):
+        """Test that a target read before its first write keeps last frame's pixels."""
+        body = "void main() { gl_FragColor = PASSINDEX == 0 ? vec4(0.0) : IMG_THIS_PIXEL(feedback); }"
+        graph = RenderGraph.from_shader(_shader([{"TARGET": "feedback"}, {}], body))
+        assert graph.targets["feedback"].carried
+        assert graph.producer(0, "feedback") is None
+
+    def test_dead_passes(self):
+        """Test that a pass whose target nothing reads is reported."""
+        graph = RenderGraph.from_shader(_shader([{"TARGET": "unused"}, {}], "void main() { gl_FragColor = vec4(1.0); }"))
+        assert graph.dead_passes() == [0]
+
+    def test_legacy_persistent_buffers(self):
+        """Test that ISF v1 PERSISTENT_BUFFERS mark targets persistent."""
+        header = {"PERSISTENT_BUFFERS": ["trail"], "PASSES": [{"TARGET": "trail"}, {}]}
+        graph = RenderGraph.from_shader(f"/*{json.dumps(header)}*/\nvoid main() {{ gl_FragColor = IMG_THIS_PIXEL(trail); }}")
+        assert graph.targets["trail"].persistent
+
+
+class TestAllocation:
+    """Test aliasing of pass textures."""
+
+    def test_blur_chain_at_4k_uses_two_textures(self):
+        """Test that an 8-pass chain ping-pongs between two textures."""
+        allocation = shader_footprint(_blur_chain(8), 3840, 2160)
+        assert len(allocation.textures) == 2
+        assert allocation.target_bytes == 2 * 1920 * 1080 * 4
+        assert allocation.unaliased_bytes == 8 * 1920 * 1080 * 4
+        assert allocation.total_bytes == allocation.target_bytes + 3840 * 2160 * 4
+        assert sorted(map(sorted, allocation.aliases())) == [["p0", "p2", "p4", "p6"], ["p1", "p3", "p5", "p7"]]
+
+    def test_incompatible_targets_are_not_shared(self):
+        """Test that persistent targets and different formats or sizes get textures of their own."""
+        passes = [
+            {"TARGET": "a"},
+            {"TARGET": "b", "FLOAT": True},
+            {"TARGET": "c", "WIDTH": "$WIDTH/2", "HEIGHT": "$HEIGHT/2"},
+            {"TARGET": "keep", "PERSISTENT": True},
+            {"TARGET": "d"},
+            {},
+        ]
+        body = """void main() {
+            if (PASSINDEX == 1) gl_FragColor = IMG_THIS_PIXEL(a);
+            else if (PASSINDEX == 2) gl_FragColor = IMG_THIS_PIXEL(b);
+            else if (PASSINDEX == 3) gl_FragColor = IMG_THIS_PIXEL(c) + IMG_THIS_PIXEL(keep);
+            else if (PASSINDEX == 5) gl_FragColor = IMG_THIS_PIXEL(d) + IMG_THIS_PIXEL(keep);
+        }"""
+        allocation = shader_footprint(_shader(passes, body), 64, 64)
+        assert allocation.aliases() == [["a", "d"]]
+        assert len({allocation.assignment[name] for name in ("a", "b", "c", "keep")}) == 4
+
+    def test_size_expressions_use_header_defaults(self):
+        """Test that a size naming an input uses its DEFAULT unless a value is given."""
+        shader = _shader(
+            [{"TARGET": "small", "WIDTH": "$WIDTH/$scale", "HEIGHT": "$HEIGHT/$scale"}, {}],
+            "void main() { gl_FragColor = IMG_THIS_PIXEL(small); }",
+            [{"NAME": "scale", "TYPE": "float", "DEFAULT": 4.0}],
+        )
+        assert shader_footprint(shader, 400, 200).textures[0].width == 100
+        assert shader_footprint(shader, 400, 200, {"scale": 2}).textures[0].width == 200
+
+    def test_single_pass_shader(self):
+        """Test that a shader without PASSES needs only its output."""
+        allocation = shader_footprint("void main() { gl_FragColor = vec4(1.0); }", 100, 50)
+        assert allocation.target_bytes == 0 and allocation.total_bytes == 100 * 50 * 4
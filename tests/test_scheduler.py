@@ -0,0 +1,98 @@
+"""Tests for placing render workers and rasterizer threads on CPUs."""
+
+import os
+
+import pytest
+
+from isf_shader_renderer.config import ShaderConfig
+from isf_shader_renderer.scheduler import (
+    LP_NUM_THREADS,
+    CpuTopology,
+    WorkerLayout,
+    calibrate,
+    candidate_layouts,
+    plan_layout,
+    rasterizer_threads,
+    worker_pool,
+)
+
+SHADER = """/*{"INPUTS": []}*/
+void main() { gl_FragColor = vec4(fract(TIME), 0.5, 0.5, 1.0); }"""
+
+# 16 cores with two hyperthreads each: core n is CPUs n and n + 16
+SMT_32 = CpuTopology(tuple((n, n + 16) for n in range(16)))
+
+
+def _worker_environment():
+    affinity = sorted(os.sched_getaffinity(0)) if hasattr(os, "sched_getaffinity") else []
+    return os.environ.get(LP_NUM_THREADS), affinity
+
+
+@pytest.fixture(autouse=True)
+def _no_thread_override(monkeypatch):
+    monkeypatch.delenv(LP_NUM_THREADS, raising=False)
+
+
+class TestPlanLayout:
+    """Test balancing workers against rasterizer threads."""
+
+    def test_threads_follow_frame_size(self):
+        """Test that small frames get one thread and large frames many."""
+        assert rasterizer_threads(256, 144) == 1
+        assert rasterizer_threads(1920, 1080) > rasterizer_threads(1280, 720) > 1
+        assert rasterizer_threads(8192, 8192) == 32
+
+    def test_automatic_layout_fills_the_cpus(self):
+        """Test that workers x threads matches the CPU count without oversubscribing."""
+        small = plan_layout(SMT_32, 256, 144)
+        assert (small.workers, small.threads) == (32, 1)
+        large = plan_layout(SMT_32, 1920, 1080)
+        assert large.workers * large.threads <= 32 and large.threads > 1
+
+    def test_jobs_split_the_cpus(self):
+        """Test that a fixed worker count gets the remaining CPUs as threads."""
+        layout = plan_layout(SMT_32, 3840, 2160, jobs=4)
+        assert (layout.workers, layout.threads) == (4, 8)
+        assert plan_layout(SMT_32, 256, 144, jobs=4).threads == 1
+
+    def test_fixed_threads_and_environment(self, monkeypatch):
+        """Test that --threads, or LP_NUM_THREADS already set, decides the worker count."""
+        assert plan_layout(SMT_32, 1920, 1080, threads=8).workers == 4
+        monkeypatch.setenv(LP_NUM_THREADS, "2")
+        assert plan_layout(SMT_32, 1920, 1080).threads == 2
+
+    def test_cpu_sets_keep_cores_whole(self):
+        """Test that workers get disjoint sets of whole physical cores."""
+        layout = plan_layout(SMT_32, 3840, 2160, jobs=4)
+        assert len(layout.cpu_sets) == 4
+        assert sorted(cpu for cpus in layout.cpu_sets for cpu in cpus) == list(range(32))
+        assert all(n + 16 in cpus for cpus in layout.cpu_sets for n in cpus if n < 16)
+
+    def test_candidates(self):
+        """Test that calibration candidates double threads and fill the CPUs."""
+        layouts = candidate_layouts(SMT_32, 1920, 1080, max_workers=8)
+        assert [(l.workers, l.threads) for l in layouts][:3] == [(8, 1), (8, 2), (8, 4)]
+        assert all(l.threads <= rasterizer_threads(1920, 1080) for l in layouts)
+
+
+class TestWorkers:
+    """Test configuring spawned workers."""
+
+    def test_pool_sets_threads_and_affinity(self):
+        """Test that every worker starts with the layout's threads and its own CPUs."""
+        cpus = sorted(os.sched_getaffinity(0)) if hasattr(os, "sched_getaffinity") else []
+        cpu_sets = ((cpus[0],),) if cpus else ()
+        with worker_pool(WorkerLayout(1, 3, cpu_sets)) as pool:
+            threads, affinity = pool.submit(_worker_environment).result()
+        assert threads == "3"
+        if cpus:
+            assert affinity == [cpus[0]]
+
+    def test_calibration_picks_a_measured_layout(self, tmp_path):
+        """Test that calibration times each candidate and returns the fastest."""
+        config = ShaderConfig(
+            input="a.fs", output=str(tmp_path / "f_%04d.png"), times=[0.0, 0.5, 1.0], width=64, height=36, quality=95
+        )
+        best, rates = calibrate(SHADER, config, CpuTopology(((0,),)), seconds=0.05)
+        assert best in rates and rates[best] == max(rates.values()) > 0
+        assert not list(tmp_path.iterdir())
@@ -0,0 +1,121 @@
+"""Tests for frame-sharded rendering across worker processes."""
+
+import hashlib
+import json
+
+import pytest
+
+from isf_shader_renderer.config import ShaderConfig
+from isf_shader_renderer.sharding import (
+    MIN_SHARD_FRAMES,
+    ShardJournal,
+    iter_sharded,
+    plan_shards,
+    render_sharded,
+    stateful_reason,
+)
+from isf_shader_renderer.timebase import TimeRange
+
+SHADER = """/*{"INPUTS": []}*/
+void main() { gl_FragColor = vec4(fract(TIME), 0.5, 0.5, 1.0); }"""
+
+PERSISTENT = """/*{"INPUTS": [], "PASSES": [{"TARGET": "trail", "PERSISTENT": true}, {}]}*/
+void main() { gl_FragColor = IMG_THIS_PIXEL(trail) * 0.9; }"""
+
+
+def _config(tmp_path, times, name="f_%06d.png"):
+    return ShaderConfig(input="a.fs", output=str(tmp_path / name), times=times, width=8, height=8, quality=95)
+
+
+class TestStatefulDetection:
+    """Test which shaders must be rendered in order."""
+
+    def test_stateless(self):
+        """Test a shader whose frames depend only on TIME."""
+        assert stateful_reason(SHADER) is None
+
+    def test_persistent_buffers(self):
+        """Test persistent passes and the ISF v1 key."""
+        assert "persistent" in stateful_reason(PERSISTENT)
+        assert "persistent" in stateful_reason('/*{"PERSISTENT_BUFFERS": ["a"]}*/\nvoid main() {}')
+
+    def test_frame_counters(self):
+        """Test FRAMEINDEX and TIMEDELTA in code but not in comments."""
+        assert "FRAMEINDEX" in stateful_reason("void main() { float f = float(FRAMEINDEX); }")
+        assert "TIMEDELTA" in stateful_reason("void main() { float d = TIMEDELTA; }")
+        assert stateful_reason("// uses FRAMEINDEX\nvoid main() {}") is None
+
+
+class TestPlanShards:
+    """Test shard planning."""
+
+    @pytest.mark.parametrize("frames,shards", [(1000, 7), (1000, 1), (17, 4), (0, 4), (100_003, 32)])
+    def test_contiguous_cover(self, frames, shards):
+        """Test that shards cover every frame once, in order."""
+        plan = plan_shards(frames, shards)
+        assert [p.index for p in plan] == list(range(len(plan)))
+        assert sum(len(p) for p in plan) == frames
+        assert all(a.end == b.begin for a, b in zip(plan, plan[1:]))
+        if len(plan) > 1:
+            assert min(len(p) for p in plan) >= MIN_SHARD_FRAMES
+            assert max(len(p) for p in plan) - min(len(p) for p in plan) <= 1
+
+
+class TestRenderSharded:
+    """Test sharded rendering to files."""
+
+    def test_files_are_named_by_frame_number(self, tmp_path):
+        """Test that a slice of a timebase writes its own frame numbers."""
+        times = TimeRange(0, fps="30000/1001", count=1000)[100:164]
+        result = render_sharded(SHADER, _config(tmp_path, times))
+        assert (result.frames, result.rendered_shards, result.failed) == (64, result.shards, [])
+        assert sorted(p.name for p in tmp_path.glob("*.png")) == [f"f_{n:06d}.png" for n in range(100, 164)]
+
+    def test_resume_skips_finished_shards(self, tmp_path):
+        """Test that a rerun renders only shards whose files are missing."""
+        config = _config(tmp_path, TimeRange(0, fps=30, count=64))
+        first = render_sharded(SHADER, config, jobs=2)
+        assert first.shards > 1
+        (tmp_path / "f_000040.png").unlink()
+        second = render_sharded(SHADER, config, jobs=2)
+        assert (second.resumed_shards, second.rendered_shards) == (first.shards - 1, 1)
+        assert (tmp_path / "f_000040.png").exists()
+        assert render_sharded(SHADER, config, resume=False).resumed_shards == 0
+
+    def test_journal_is_keyed_on_the_render(self, tmp_path):
+        """Test that a different render does not reuse a journal."""
+        config = _config(tmp_path, TimeRange(0, fps=30, count=32))
+        render_sharded(SHADER, config)
+        other = ShaderConfig(**{**config.__dict__, "inputs": {"speed": 2.0}})
+        assert ShardJournal.for_render(SHADER, config).path != ShardJournal.for_render(SHADER, other).path
+        journal = json.loads(ShardJournal.for_render(SHADER, config).path.read_text())
+        assert journal["plan"] == [[0, 16], [16, 32]] and journal["done"] == [0, 1]
+
+    def test_stateful_shaders_are_serialized_or_refused(self, tmp_path):
+        """Test that a persistent shader renders as one shard, or raises on request."""
+        config = _config(tmp_path, TimeRange(0, fps=30, count=64))
+        result = render_sharded(PERSISTENT, config, jobs=4)
+        assert result.shards == 1 and "persistent" in result.serialized
+        with pytest.raises(ValueError, match="Cannot shard"):
+            render_sharded(PERSISTENT, config, jobs=4, refuse_stateful=True)
+
+
+class TestIterSharded:
+    """Test in-order streaming from worker processes."""
+
+    def test_workers_stream_in_serial_order(self, tmp_path, monkeypatch):
+        """Test that frames from two workers match a serial render frame for frame."""
+        monkeypatch.setattr("isf_shader_renderer.sharding.STREAM_SHARD_FRAMES", MIN_SHARD_FRAMES)
+        config = _config(tmp_path, TimeRange(0, fps=10, count=80))
+
+        def digests(jobs):
+            return [
+                (number, time_code, hashlib.sha256(pixels.data).hexdigest())
+                for number, time_code, pixels in iter_sharded(SHADER, config, jobs=jobs, spool_dir=tmp_path)
+            ]
+
+        serial = digests(1)
+        assert [n for n, _, _ in serial] == list(range(80))
+        assert len({d for _, _, d in serial}) > 1
+        assert digests(2) == serial
+        assert not list(tmp_path.glob("isf-shards-*"))
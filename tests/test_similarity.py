@@ -0,0 +1,113 @@
+"""Tests for visual similarity search."""
+
+import base64
+from io import BytesIO
+
+import numpy as np
+import pytest
+from PIL import Image
+
+from isf_shader_renderer.fingerprint import format_hash
+from isf_shader_renderer.golden import GoldenEntry, GoldenStore
+from isf_shader_renderer.similarity import ShaderLibraryIndex, fingerprint_base64_image, fingerprint_frame
+
+
+def _pattern(seed: int, size=(72, 128)) -> np.ndarray:
+    """Build a smooth random RGBA pattern."""
+    rng = np.random.default_rng(seed)
+    coarse = rng.random((9, 16)).astype(np.float32)
+    luma = np.kron(coarse, np.ones((size[0] // 9, size[1] // 16), dtype=np.float32))
+    levels = (luma * 255).astype(np.uint8)
+    return np.stack([levels, levels, levels, np.full_like(levels, 255)], axis=2)
+
+
+@pytest.fixture
+def library(tmp_path):
+    """Library of three shaders, each fingerprinted at two time codes."""
+    store = GoldenStore(tmp_path)
+    for shader_index in range(3):
+        for time_index, time_code in enumerate((0.0, 1.0)):
+            phash, dhash = fingerprint_frame(_pattern(shader_index * 10 + time_index))
+            key = f"s{shader_index}_{time_index}"
+            store.put(GoldenEntry(
+                key=key, shader=f"shader{shader_index}.fs", time_code=time_code, width=128, height=72,
+                source_sha256="0" * 64, phash=format_hash(phash), dhash=format_hash(dhash),
+                image=f"images/{key}.png",
+            ))
+    store.save()
+    return ShaderLibraryIndex.load(tmp_path)
+
+
+class TestShaderLibraryIndex:
+    """Test library search."""
+
+    def test_index_layout(self, library):
+        """Test canonical times and size are taken from the store."""
+        assert len(library) == 3
+        assert library.time_codes == [0.0, 1.0]
+        assert library.frame_size == (128, 72)
+
+    def test_frame_query_finds_its_shader(self, library):
+        """Test that a frame of a library shader ranks that shader first."""
+        matches = library.search([fingerprint_frame(_pattern(11))], max_distance=64)
+
+        assert matches[0]["shader"] == "shader1.fs"
+        assert matches[0]["phash_distance"] == 0
+        assert matches[0]["reference_image"].endswith("images/s1_1.png")
+
+    def test_multi_frame_query(self, library):
+        """Test that shader queries average over the canonical times."""
+        hashes = [fingerprint_frame(_pattern(20)), fingerprint_frame(_pattern(21))]
+        matches = library.search(hashes, limit=2, max_distance=64)
+
+        assert [m["shader"] for m in matches][0] == "shader2.fs"
+        assert len(matches) == 2
+
+    def test_max_distance_and_exclude(self, library):
+        """Test that far matches and the excluded shader are dropped."""
+        matches = library.search([fingerprint_frame(_pattern(0))], max_distance=0, exclude="shader0.fs")
+        assert matches == []
+
+    def test_base64_image_query(self):
+        """Test that base64 images are fingerprinted like frames."""
+        frame = _pattern(5)
+        buffer = BytesIO()
+        Image.fromarray(frame).save(buffer, format="PNG")
+        encoded = "data:image/png;base64," + base64.b64encode(buffer.getvalue()).decode()
+
+        assert fingerprint_base64_image(encoded) == fingerprint_frame(frame)
+
+    def test_missing_index(self, tmp_path):
+        """Test that a missing library index is reported."""
+        with pytest.raises(FileNotFoundError):
+            ShaderLibraryIndex.load(tmp_path / "missing")
+
+
+class TestLibraryPathPolicy:
+    """Test which libraries MCP clients may search."""
+
+    def test_default_and_allowed_roots(self, tmp_path, monkeypatch):
+        """Test that only the default library and those under allowed roots are accepted."""
+        from isf_shader_renderer.mcp.handlers import ISFShaderHandlers
+
+        handlers = ISFShaderHandlers()
+        default, other = tmp_path / "default", tmp_path / "shared" / "other"
+        monkeypatch.setenv("ISF_SHADER_LIBRARY", str(default))
+        monkeypatch.delenv("ISF_SHADER_LIBRARY_ROOTS", raising=False)
+
+        assert handlers._resolve_library(None) == str(default)
+        assert handlers._resolve_library(str(default)) == str(default.resolve())
+        for path in (str(other), str(tmp_path / "default" / ".." / "shared" / "other")):
+            with pytest.raises(ValueError, match="not allowed"):
+                handlers._resolve_library(path)
+
+        monkeypatch.setenv("ISF_SHADER_LIBRARY_ROOTS", str(tmp_path / "shared"))
+        assert handlers._resolve_library(str(other)) == str(other.resolve())
+
+    def test_unconfigured(self, monkeypatch):
+        """Test that a request without a configured library is rejected."""
+        from isf_shader_renderer.mcp.handlers import ISFShaderHandlers
+
+        monkeypatch.delenv("ISF_SHADER_LIBRARY", raising=False)
+        with pytest.raises(ValueError, match="No shader library"):
+            ISFShaderHandlers()._resolve_library(None)
@@ -0,0 +1,146 @@
+"""Tests for input specialization."""
+
+import json
+
+import pytest
+
+from isf_shader_renderer.config import ShaderConfig, ShaderRendererConfig
+from isf_shader_renderer.renderer import ShaderRenderer
+from isf_shader_renderer.specialize import (
+    glsl_constant, specialization_key, specialize_shader, split_isf_source
+)
+
+SHADER = """/*{
+    "DESCRIPTION": "Specialization test",
+    "INPUTS": [
+        {"NAME": "uMode", "TYPE": "long", "VALUES": [0, 1], "DEFAULT": 0},
+        {"NAME": "uGain", "TYPE": "float", "DEFAULT": 1.0},
+        {"NAME": "uOn", "TYPE": "bool", "DEFAULT": true},
+        {"NAME": "uTint", "TYPE": "color", "DEFAULT": [1.0, 1.0, 1.0, 1.0]},
+        {"NAME": "uPos", "TYPE": "point2D", "DEFAULT": [0.5, 0.5]},
+        {"NAME": "inputImage", "TYPE": "image"}
+    ]
+}*/
+void main() {
+    if (uMode == 1) {
+        gl_FragColor = uTint * uGain;
+    } else {
+        gl_FragColor = vec4(uPos, 0.0, 1.0);
+    }
+}"""
+
+
+class TestGlslConstant:
+    """Test conversion of input values to GLSL literals."""
+
+    def test_scalar_types(self):
+        """Test float, long and bool literals, including CLI strings."""
+        assert glsl_constant("float", 2) == ("float", "2.0")
+        assert glsl_constant("float", "0.25") == ("float", "0.25")
+        assert glsl_constant("long", "1") == ("int", "1")
+        assert glsl_constant("bool", "yes") == ("bool", "true")
+        assert glsl_constant("event", False) == ("bool", "false")
+
+    def test_vector_types(self):
+        """Test point2D and color literals from tuples and strings."""
+        assert glsl_constant("point2D", "0.5 0.25") == ("vec2", "vec2(0.5, 0.25)")
+        assert glsl_constant("color", (1, 0, 0)) == ("vec4", "vec4(1.0, 0.0, 0.0, 1.0)")
+
+    def test_invalid_values(self):
+        """Test that unconvertible values are rejected."""
+        with pytest.raises(ValueError):
+            glsl_constant("long", 1.5)
+        with pytest.raises(ValueError):
+            glsl_constant("point2D", (1.0, 2.0, 3.0))
+
+
+class TestSpecializeShader:
+    """Test the source rewrite."""
+
+    def test_fixed_inputs_become_constants(self):
+        """Test that baked inputs leave the header and become consts."""
+        source, remaining = specialize_shader(SHADER, {"uMode": "1", "uGain": 0.5, "uTint": "1 0 0 1"})
+        metadata, _, body = split_isf_source(source)
+
+        assert remaining == {}
+        assert [i["NAME"] for i in metadata["INPUTS"]] == ["uOn", "uPos", "inputImage"]
+        assert "const int uMode = 1;" in body
+        assert "const float uGain = 0.5;" in body
+        assert "const vec4 uTint = vec4(1.0, 0.0, 0.0, 1.0);" in body
+        assert body.index("const int uMode") < body.index("void main()")
+
+    def test_unsupported_inputs_remain_uniforms(self):
+        """Test that images and bad values are left to be set as uniforms."""
+        source, remaining = specialize_shader(SHADER, {"inputImage": "x.png", "uGain": "loud"})
+        assert source == SHADER
+        assert remaining == {"inputImage": "x.png", "uGain": "loud"}
+
+    def test_inputs_used_by_passes_are_kept(self):
+        """Test that inputs referenced in PASSES size expressions stay uniforms."""
+        metadata, _, body = split_isf_source(SHADER)
+        metadata["PASSES"] = [{"TARGET": "buf", "WIDTH": "$WIDTH/$uGain"}]
+        shader = "/*" + json.dumps(metadata) + "*/" + body
+
+        source, remaining = specialize_shader(shader, {"uGain": 2.0, "uOn": True})
+
+        assert remaining == {"uGain": 2.0}
+        assert "const bool uOn = true;" in source
+
+    def test_version_directive_stays_first(self):
+        """Test that constants are inserted after a #version line."""
+        shader = SHADER.replace("void main() {", "#version 150\nvoid main() {", 1)
+        source, _ = specialize_shader(shader, {"uOn": False})
+        body = split_isf_source(source)[2]
+        assert body.index("#version 150") < body.index("const bool uOn")
+
+    def test_key_ignores_order(self):
+        """Test that the cache key does not depend on dict order."""
+        assert specialization_key({"a": 1, "b": 2}) == specialization_key({"b": 2, "a": 1})
+
+
+class TestSpecializedRendering:
+    """Test the renderer's specialized program cache."""
+
+    def test_program_is_cached_per_input_tuple(self, tmp_path):
+        """Test that frames with the same inputs reuse one compiled program."""
+        renderer = ShaderRenderer(ShaderRendererConfig())
+        config = ShaderConfig(
+            input="test.fs", output="", times=[0.0, 1.0], width=32, height=32,
+            inputs={"uMode": "1", "uGain": "0.5"}, specialize=True,
+        )
+
+        renderer.render_frame(SHADER, 0.0, tmp_path / "a.png", config)
+        renderer.render_frame(SHADER, 1.0, tmp_path / "b.png", config)
+        assert len(renderer._specialized) == 1
+
+        other = ShaderConfig(**{**config.__dict__, "inputs": {"uMode": "0"}})
+        renderer.render_frame(SHADER, 0.0, tmp_path / "c.png", other)
+        assert len(renderer._specialized) == 2
+        assert (tmp_path / "c.png").exists()
+
+        renderer.cleanup()
+        assert len(renderer._specialized) == 0
+
+    def test_cached_program_renders_with_the_callers_config(self):
+        """Test that a second job sharing the program keeps its own size."""
+        renderer = ShaderRenderer(ShaderRendererConfig())
+        config = ShaderConfig(
+            input="test.fs", output="", times=[0.0], width=32, height=32,
+            inputs={"uMode": "1", "uGain": "0.5"}, specialize=True,
+        )
+        larger = ShaderConfig(**{**config.__dict__, "width": 48, "height": 16})
+        assert renderer.render_array(SHADER, 0.0, config).shape == (32, 32, 4)
+        assert renderer.render_array(SHADER, 0.0, larger).shape == (16, 48, 4)
+        assert len(renderer._specialized) == 1
+        renderer.cleanup()
+
+    def test_sessions_are_specialized(self):
+        """Test that a session, as used by --realtime, bakes fixed inputs in."""
+        renderer = ShaderRenderer(ShaderRendererConfig())
+        config = ShaderConfig(
+            input="test.fs", output="", times=[0.0], width=32, height=32,
+            inputs={"uMode": "1", "uGain": "0.5"}, specialize=True,
+        )
+        with renderer.session(SHADER, config) as session:
+            assert session.shader_content != SHADER
+            assert "uGain" not in (session.shader_config.inputs or {})
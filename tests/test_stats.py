@@ -0,0 +1,98 @@
+"""Tests for frame statistics."""
+
+import numpy as np
+import pytest
+
+from isf_shader_renderer.stats import compute_frame_stats, describe_frame_stats
+
+
+class TestComputeFrameStats:
+    """Test per-frame pixel statistics."""
+
+    def test_black_frame(self):
+        """Test that an opaque black frame is flagged as black and flat."""
+        pixels = np.zeros((90, 160, 4), dtype=np.uint8)
+        pixels[..., 3] = 255
+
+        stats = compute_frame_stats(pixels)
+
+        assert stats["is_black"] is True
+        assert stats["is_flat"] is True
+        assert stats["black_fraction"] == 1.0
+        assert stats["channels"]["a"]["min"] == 1.0
+        assert stats["entropy"] == 0.0
+        assert stats["edge_density"] == 0.0
+
+    def test_flat_color_frame(self):
+        """Test channel statistics for a uniform color."""
+        pixels = np.zeros((32, 32, 4), dtype=np.uint8)
+        pixels[...] = (51, 102, 153, 255)
+
+        stats = compute_frame_stats(pixels)
+
+        assert stats["is_flat"] is True
+        assert stats["is_black"] is False
+        assert stats["channels"]["r"]["mean"] == pytest.approx(0.2, abs=1e-3)
+        assert stats["channels"]["g"]["max"] == pytest.approx(0.4, abs=1e-3)
+        assert stats["channels"]["b"]["min"] == pytest.approx(0.6, abs=1e-3)
+
+    def test_gradient_frame(self):
+        """Test histogram, entropy and edges for a structured frame."""
+        ramp = np.tile(np.arange(256, dtype=np.uint8), (64, 1))
+        pixels = np.stack([ramp, ramp, ramp, np.full_like(ramp, 255)], axis=2)
+        pixels[:, ::8, :3] = 0  # Hard vertical stripes
+
+        stats = compute_frame_stats(pixels, max_samples=None)
+
+        assert stats["is_flat"] is False
+        assert len(stats["luminance_histogram"]) == 16
+        assert sum(stats["luminance_histogram"]) == pytest.approx(1.0, abs=1e-3)
+        assert stats["entropy"] > 6.0
+        assert stats["edge_density"] > 0.1
+
+    def test_nan_fraction_for_float_buffers(self):
+        """Test that NaN pixels are counted for float readback buffers."""
+        pixels = np.full((10, 10, 4), 0.5, dtype=np.float32)
+        pixels[:2] = np.nan
+
+        stats = compute_frame_stats(pixels)
+
+        assert stats["nan_fraction"] == pytest.approx(0.2)
+        assert stats["channels"]["r"]["max"] == pytest.approx(0.5)
+
+    def test_large_frame_is_sampled(self):
+        """Test that large frames are inspected on a strided grid."""
+        pixels = np.zeros((1080, 1920, 4), dtype=np.uint8)
+
+        stats = compute_frame_stats(pixels)
+
+        assert stats["sample_stride"] > 1
+        assert stats["width"] == 1920
+        assert stats["height"] == 1080
+
+    def test_invalid_histogram_bins(self):
+        """Test that histogram bins must divide 256."""
+        with pytest.raises(ValueError, match="histogram_bins"):
+            compute_frame_stats(np.zeros((4, 4, 4), dtype=np.uint8), histogram_bins=10)
+
+
+class TestDescribeFrameStats:
+    """Test human-readable frame warnings."""
+
+    def test_blank_frame_warning(self):
+        """Test that a black frame produces a 'renders but is blank' warning."""
+        pixels = np.zeros((8, 8, 4), dtype=np.uint8)
+        warnings = describe_frame_stats(compute_frame_stats(pixels))
+        assert any("entirely black" in warning for warning in warnings)
+
+    def test_flat_color_warning(self):
+        """Test that a flat color frame reports its color."""
+        pixels = np.full((8, 8, 3), 0.25, dtype=np.float32)
+        warnings = describe_frame_stats(compute_frame_stats(pixels))
+        assert any("flat color" in warning for warning in warnings)
+
+    def test_no_warning_for_content(self):
+        """Test that a frame with real content has no warnings."""
+        rng = np.random.default_rng(0)
+        pixels = rng.integers(0, 256, (64, 64, 4), dtype=np.uint8)
+        assert describe_frame_stats(compute_frame_stats(pixels)) == []
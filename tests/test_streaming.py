@@ -0,0 +1,123 @@
+"""Tests for streaming JSON serialization of tool results."""
+
+import base64
+import json
+import os
+import tracemalloc
+
+import pytest
+from fastapi.testclient import TestClient
+
+from isf_shader_renderer.mcp.http_server import ISFShaderHTTPServer
+from isf_shader_renderer.mcp.streaming import (
+    BASE64_CHUNK_BYTES,
+    Base64File,
+    JsonText,
+    iter_json,
+    json_text,
+)
+
+SHADER = """/*{"INPUTS": []}*/
+void main() { gl_FragColor = vec4(0.2, 0.4, 0.6, 1.0); }"""
+
+DOCUMENT = {
+    "success": True,
+    "message": "café \"quoted\"\n",
+    "values": [1, 2.5, None, False, [], {}],
+    "nested": {"a": {"b": [{"c": "d"}]}, 3: "int key"},
+    "empty": "",
+}
+
+
+def _write(path, size):
+    path.write_bytes(os.urandom(size))
+    return path
+
+
+class TestIterJson:
+    """Test that the streamed document matches json.dumps."""
+
+    @pytest.mark.parametrize("indent", [None, 2])
+    def test_matches_json_dumps(self, indent):
+        """Test plain values, escaping and indentation."""
+        streamed = json_text(DOCUMENT, indent=indent)
+        assert json.loads(streamed) == json.loads(json.dumps(DOCUMENT))
+        if indent is not None:
+            assert streamed == json.dumps(DOCUMENT, indent=indent)
+
+    @pytest.mark.parametrize("size", [0, 1, 2, 3, BASE64_CHUNK_BYTES - 1, BASE64_CHUNK_BYTES, 3 * BASE64_CHUNK_BYTES + 2])
+    def test_base64_file_streams_exact_encoding(self, tmp_path, size):
+        """Test chunk boundaries and padding against a one-shot encoding."""
+        path = _write(tmp_path / "frame.png", size)
+        expected = base64.b64encode(path.read_bytes()).decode()
+        frame = Base64File(path)
+        assert frame.text() == expected
+        assert len(frame) == len(expected)
+        assert json.loads(json_text({"frames": [frame]})) == {"frames": [expected]}
+
+    def test_json_text_embeds_a_document_as_a_string(self, tmp_path):
+        """Test the MCP text-content form, frames included."""
+        path = _write(tmp_path / "frame.png", 1000)
+        response = {"content": [{"type": "text", "text": JsonText({**DOCUMENT, "frame": Base64File(path)}, indent=2)}]}
+        text = json.loads(json_text(response))["content"][0]["text"]
+        inner = json.loads(text)
+        assert inner["frame"] == base64.b64encode(path.read_bytes()).decode()
+        assert inner["message"] == DOCUMENT["message"]
+
+
+class TestPeakMemory:
+    """Test that streaming a multi-frame response stays within a few chunks."""
+
+    def test_ten_large_frames(self, tmp_path):
+        """Test peak memory against building the base64 strings and the JSON text."""
+        paths = [_write(tmp_path / f"frame_{i}.png", 1_500_000) for i in range(10)]
+        metadata = {"rendered_files": [{"path": str(p)} for p in paths]}
+
+        tracemalloc.start()
+        try:
+            frames = []
+            for p in paths:
+                with open(p, "rb") as f:
+                    frames.append(base64.b64encode(f.read()).decode())
+            eager = json.dumps({"rendered_frames": frames, "metadata": metadata}, indent=2).encode()
+            _, eager_peak = tracemalloc.get_traced_memory()
+            del frames, eager
+            tracemalloc.reset_peak()
+
+            written = 0
+            for chunk in iter_json({"rendered_frames": [Base64File(p) for p in paths], "metadata": metadata}):
+                written += len(chunk)
+            _, streamed_peak = tracemalloc.get_traced_memory()
+        finally:
+            tracemalloc.stop()
+        assert written > 10 * 2_000_000
+        assert streamed_peak < 1_000_000
+        assert streamed_peak * 10 < eager_peak
+
+
+class TestHTTPStreaming:
+    """Test the streaming responses of the HTTP server."""
+
+    def test_render_endpoint_streams_frames(self):
+        """Test that /render returns the frames as base64 strings."""
+        client = TestClient(ISFShaderHTTPServer().app)
+        response = client.post("/render", json={"shader_content": SHADER, "time_codes": [0.0, 0.5], "width": 32, "height": 16})
+        assert response.status_code == 200
+        body = response.json()
+        assert body["success"] is True
+        assert len(body["rendered_frames"]) == 2
+        for frame, info in zip(body["rendered_frames"], body["metadata"]["rendered_files"]):
+            with open(info["path"], "rb") as f:
+                assert base64.b64decode(frame) == f.read()
+
+    def test_json_rpc_text_content(self):
+        """Test that tools/call text content is valid embedded JSON."""
+        client = TestClient(ISFShaderHTTPServer().app)
+        response = client.post("/", json={
+            "jsonrpc": "2.0", "id": 1, "method": "tools/call",
+            "params": {"name": "get_shader_info", "arguments": {"shader_content": SHADER}},
+        })
+        assert response.status_code == 200
+        body = response.json()
+        assert body["id"] == 1
+        assert "success" in json.loads(body["result"]["content"][0]["text"])
@@ -0,0 +1,106 @@
+"""Tests for temporal analysis and frame fingerprints."""
+
+import math
+
+import numpy as np
+import pytest
+
+from isf_shader_renderer.fingerprint import difference_hash, downsample, format_hash, hamming_distance
+from isf_shader_renderer.temporal import analyze_frames, frame_features, probe_times, select_distinct_frames
+
+
+def _wave_frame(t: float, period: float = 2.0, size=(64, 36)) -> np.ndarray:
+    """Build an RGBA frame whose stripes drift with the given period."""
+    width, height = size
+    x = np.linspace(0.0, 2.0 * math.pi, width, dtype=np.float32)
+    row = 0.5 + 0.5 * np.sin(x * 3.0 + 2.0 * math.pi * t / period)
+    levels = (np.tile(row, (height, 1)) * 255).astype(np.uint8)
+    return np.stack([levels, levels, levels, np.full_like(levels, 255)], axis=2)
+
+
+class TestFingerprint:
+    """Test perceptual frame hashes."""
+
+    def test_downsample_averages_blocks(self):
+        """Test that downsampling computes block means."""
+        luma = np.arange(16, dtype=np.float32).reshape(4, 4)
+        small = downsample(luma, (2, 2))
+        assert small.tolist() == [[2.5, 4.5], [10.5, 12.5]]
+
+    def test_identical_frames_hash_equal(self):
+        """Test that identical frames have identical hashes."""
+        frame = _wave_frame(0.3)
+        assert difference_hash(frame) == difference_hash(frame.copy())
+
+    def test_different_frames_hash_apart(self):
+        """Test that visibly different frames are far apart in Hamming distance."""
+        a = difference_hash(_wave_frame(0.0))
+        b = difference_hash(_wave_frame(1.0))
+        assert hamming_distance(a, b) > 16
+        assert len(format_hash(a)) == 16
+
+
+class TestAnalyzeFrames:
+    """Test loop, motion and static segment detection."""
+
+    def test_probe_times(self):
+        """Test evenly spaced inclusive probe times."""
+        assert probe_times(0.0, 1.0, 5) == [0.0, 0.25, 0.5, 0.75, 1.0]
+        with pytest.raises(ValueError):
+            probe_times(1.0, 1.0, 5)
+
+    def test_detects_loop_period(self):
+        """Test that a periodic animation reports its period."""
+        times = probe_times(0.0, 10.0, 101)
+        analysis = analyze_frames((_wave_frame(t, period=2.5) for t in times), times)
+
+        assert analysis.is_static is False
+        assert analysis.loop_period == pytest.approx(2.5, abs=0.1)
+        assert all(t <= 2.5 + 0.1 for t in analysis.suggested_time_codes)
+        assert len(analysis.frame_hashes) == len(times)
+        assert len(analysis.motion_energy) == len(times) - 1
+
+    def test_static_sequence(self):
+        """Test that a motionless sequence is reported as static."""
+        times = probe_times(0.0, 4.0, 16)
+        analysis = analyze_frames((_wave_frame(0.0) for _ in times), times)
+
+        assert analysis.is_static is True
+        assert analysis.loop_period is None
+        assert analysis.suggested_time_codes == [0.0]
+        assert "static" in analysis.summary()
+
+    def test_static_segment_and_peak_motion(self):
+        """Test static segment detection and peak motion time."""
+        times = probe_times(0.0, 9.0, 10)
+        # Still until t=4, then an accelerating drift
+        phases = [0, 0, 0, 0, 0, 0.1, 0.3, 0.6, 1.0, 1.5]
+        analysis = analyze_frames((_wave_frame(p, period=8.0) for p in phases), times)
+
+        assert analysis.static_segments == [(0.0, 4.0)]
+        assert analysis.max_motion_time == pytest.approx(8.5)
+        assert analysis.to_dict()["static_segments"] == [[0.0, 4.0]]
+
+    def test_mismatched_times(self):
+        """Test that frame and time counts must match."""
+        with pytest.raises(ValueError, match="does not match"):
+            analyze_frames([_wave_frame(0.0)] * 3, [0.0, 1.0])
+
+
+class TestSelectDistinctFrames:
+    """Test keyframe selection by farthest-point sampling."""
+
+    def test_picks_distinct_frames(self):
+        """Test that duplicates are skipped in favour of distinct looks."""
+        phases = [0.0, 0.0, 0.0, 0.5, 0.5, 1.0, 1.0, 1.5]
+        features = np.stack([frame_features(_wave_frame(p, period=2.0)) for p in phases])
+
+        chosen = select_distinct_frames(features, 4)
+
+        assert len(chosen) == 4
+        assert sorted({phases[i] for i in chosen}) == [0.0, 0.5, 1.0, 1.5]
+
+    def test_static_sequence_yields_one_frame(self):
+        """Test that fewer frames are returned when there are no distinct looks."""
+        features = np.stack([frame_features(_wave_frame(0.0)) for _ in range(10)])
+        assert len(select_distinct_frames(features, 5)) == 1
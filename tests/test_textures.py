@@ -0,0 +1,154 @@
+"""Tests for the decoded texture cache."""
+
+import base64
+from concurrent.futures import ThreadPoolExecutor
+from io import BytesIO
+from unittest.mock import Mock
+
+import numpy as np
+import pytest
+from PIL import Image
+
+from isf_shader_renderer.config import ShaderConfig, ShaderRendererConfig
+from isf_shader_renderer.renderer import ShaderRenderer, _error_message
+from isf_shader_renderer.specialize import specialization_key
+from isf_shader_renderer import textures
+from isf_shader_renderer.textures import TextureCache, is_image_value
+
+SHADER = """/*{
+    "INPUTS": [{"NAME": "inputImage", "TYPE": "image"}]
+}*/
+void main() {
+    gl_FragColor = IMG_NORM_PIXEL(inputImage, isf_FragNormCoord);
+}"""
+
+
+def encode_png(pixels: np.ndarray) -> bytes:
+    """Encode an RGBA array as PNG bytes."""
+    buffer = BytesIO()
+    Image.fromarray(pixels, "RGBA").save(buffer, format="PNG")
+    return buffer.getvalue()
+
+
+@pytest.fixture
+def png_bytes():
+    """A small gradient texture."""
+    pixels = np.zeros((8, 12, 4), dtype=np.uint8)
+    pixels[..., 0] = np.arange(12, dtype=np.uint8)[None, :] * 20
+    pixels[..., 3] = 255
+    return encode_png(pixels)
+
+
+class TestTextureCache:
+    """Test decoding and sharing of image inputs."""
+
+    def test_same_content_is_decoded_once(self, tmp_path, png_bytes):
+        """Test that a path, raw bytes and a data URL share one decode."""
+        path = tmp_path / "texture.png"
+        path.write_bytes(png_bytes)
+        cache = TextureCache(tmp_path / "cache")
+
+        first = cache.load(path)
+        second = cache.load(png_bytes)
+        third = cache.load("data:image/png;base64," + base64.b64encode(png_bytes).decode())
+
+        assert first.shape == (8, 12, 4) and first.dtype == np.uint8
+        assert not first.flags.writeable
+        assert second is first and third is first
+        assert cache.stats()["decodes"] == 1
+
+    def test_other_processes_map_the_stored_texture(self, tmp_path, png_bytes):
+        """Test that a second cache on the same directory skips decoding."""
+        TextureCache(tmp_path).load(png_bytes)
+        other = TextureCache(tmp_path)
+        texture = other.load(png_bytes)
+
+        assert other.stats()["decodes"] == 0
+        assert isinstance(texture, np.memmap)
+        assert len(list(tmp_path.glob("*.npy"))) == 1
+
+    def test_threads_share_one_decode(self, tmp_path, png_bytes):
+        """Test that concurrent loads of one image decode it once."""
+        cache = TextureCache(tmp_path)
+        with ThreadPoolExecutor(max_workers=8) as pool:
+            loaded = list(pool.map(lambda _: cache.load(png_bytes), range(32)))
+        assert cache.stats()["decodes"] == 1
+        assert all(texture is loaded[0] for texture in loaded)
+
+    def test_caches_are_bounded(self, tmp_path, png_bytes, monkeypatch):
+        """Test that remembered path digests and stored files stay within their limits."""
+        monkeypatch.setattr(textures, "PATH_DIGEST_CACHE_SIZE", 2)
+        # Smaller than any texture, so only the one just stored is kept
+        cache = TextureCache(tmp_path / "cache", max_disk_bytes=1)
+        for i in range(4):
+            pixels = np.full((8, 12, 4), i * 40, dtype=np.uint8)
+            path = tmp_path / f"t{i}.png"
+            path.write_bytes(encode_png(pixels))
+            cache.load(path)
+
+        assert len(cache._path_digests) == 2
+        stored = list((tmp_path / "cache").glob("*.npy"))
+        assert len(stored) == 1
+        assert np.load(stored[0])[0, 0, 0] == 120
+
+    def test_image_values(self):
+        """Test which input values are treated as images."""
+        assert is_image_value("textures/noise.PNG")
+        assert is_image_value(b"\x89PNG")
+        assert is_image_value("data:image/jpeg;base64,AAAA")
+        assert not is_image_value("0.5,0.5")
+        assert not is_image_value(1.0)
+
+    def test_image_bytes_are_hashed_in_keys(self, png_bytes):
+        """Test that specialization keys do not embed the encoded image."""
+        key = specialization_key({"inputImage": png_bytes})
+        assert key[0][1].startswith("sha256:")
+
+
+class TestImageInputRendering:
+    """Test image inputs passed through the renderer."""
+
+    def test_image_input_is_set_as_pil_image(self, tmp_path, png_bytes, monkeypatch):
+        """Test that image inputs reach set_input as decoded PIL images."""
+        monkeypatch.setenv("ISF_TEXTURE_CACHE", str(tmp_path / "cache"))
+        monkeypatch.setattr("isf_shader_renderer.textures._shared_cache", None)
+        path = tmp_path / "texture.png"
+        path.write_bytes(png_bytes)
+
+        renderer = ShaderRenderer(ShaderRendererConfig())
+        config = ShaderConfig(input="test.fs", output="", times=[0.0], width=16, height=16,
+                              inputs={"inputImage": str(path), "uGain": 0.5})
+        isf_renderer = Mock()
+        renderer._set_shader_inputs(isf_renderer, config, 0.0, 16, 16)
+
+        values = {call.args[0]: call.args[1] for call in isf_renderer.set_input.call_args_list}
+        assert isinstance(values["inputImage"], Image.Image)
+        assert values["inputImage"].size == (12, 8)
+        assert values["uGain"] == 0.5
+
+    def test_missing_or_broken_image_fails_the_render(self, tmp_path, monkeypatch):
+        """Test that an unloadable texture raises instead of rendering without it."""
+        monkeypatch.setenv("ISF_TEXTURE_CACHE", str(tmp_path / "cache"))
+        monkeypatch.setattr("isf_shader_renderer.textures._shared_cache", None)
+        renderer = ShaderRenderer(ShaderRendererConfig())
+        for value in (str(tmp_path / "missing.png"), b"not an image"):
+            config = ShaderConfig(input="test.fs", output="", times=[0.0], width=16, height=16,
+                                  inputs={"inputImage": value})
+            with pytest.raises(RuntimeError) as error:
+                renderer.render_array(SHADER, 0.0, config)
+            assert "inputImage" in _error_message(error.value)
+
+    def test_paths_refused_unless_allowed(self, tmp_path, png_bytes, monkeypatch):
+        """Test that a renderer serving remote clients only takes image data."""
+        monkeypatch.setenv("ISF_TEXTURE_CACHE", str(tmp_path / "cache"))
+        monkeypatch.setattr("isf_shader_renderer.textures._shared_cache", None)
+        path = tmp_path / "texture.png"
+        path.write_bytes(png_bytes)
+        data_url = "data:image/png;base64," + base64.b64encode(png_bytes).decode()
+
+        renderer = ShaderRenderer(ShaderRendererConfig(allow_image_paths=False))
+        isf_renderer = Mock()
+        with pytest.raises(ValueError, match="data: URL"):
+            renderer._set_shader_inputs(isf_renderer, ShaderConfig("test.fs", "", [0.0], inputs={"inputImage": str(path)}), 0.0, 16, 16)
+        renderer._set_shader_inputs(isf_renderer, ShaderConfig("test.fs", "", [0.0], inputs={"inputImage": data_url}), 0.0, 16, 16)
+        assert isf_renderer.set_input.call_args.args[1].size == (12, 8)
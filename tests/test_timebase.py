@@ -0,0 +1,109 @@
+"""Tests for lazily evaluated time code sequences."""
+
+from fractions import Fraction
+
+import pytest
+
+from isf_shader_renderer.timebase import (
+    TimeRange,
+    frame_number,
+    parse_rate,
+    parse_rational,
+    parse_times,
+    times_key,
+)
+
+
+class TestTimeRange:
+    """Test TimeRange as a sequence."""
+
+    def test_end_is_exclusive(self):
+        """Test the frame count derived from an end time."""
+        assert list(TimeRange(0.0, end=1.0, fps=4)) == [0.0, 0.25, 0.5, 0.75]
+        assert len(TimeRange(0.0, end=1.0, fps=30)) == 30
+        assert len(TimeRange(0.0, end=0.1, fps=30)) == 3
+
+    def test_no_drift_on_late_frames(self):
+        """Test that frame k is start + k / fps, not an accumulated sum."""
+        times = TimeRange(0.0, fps=10, count=1_000_001)
+        assert times[1_000_000] == 100_000.0
+        accumulated = 0.0
+        for _ in range(1_000_000):
+            accumulated += 0.1
+        assert accumulated != 100_000.0
+
+    def test_indexing_and_slicing(self):
+        """Test negative indices and lazy slices."""
+        times = TimeRange(2.0, fps=2, count=10)
+        assert times[-1] == 6.5
+        window = times[4:7]
+        assert isinstance(window, TimeRange)
+        assert list(window) == [4.0, 4.5, 5.0]
+        assert window[0] == times[4]
+        assert times[::4] == [2.0, 4.0, 6.0]
+        with pytest.raises(IndexError):
+            times[10]
+
+    def test_equality_and_keys(self):
+        """Test comparison with lists and hashable keys that do not expand the range."""
+        assert TimeRange(0.0, fps=2, count=3) == [0.0, 0.5, 1.0]
+        assert TimeRange(0.0, fps=2, count=3) != [0.0, 0.5]
+        assert times_key(TimeRange(0.0, fps=2, count=10**9)) == ("range", 0.0, 2.0, 0, 10**9)
+        assert times_key([0.0, 1.0]) == (0.0, 1.0)
+
+    def test_parse_times(self):
+        """Test list and range manifest values."""
+        assert parse_times([0, 1]) == [0, 1]
+        assert parse_times({"start": 1, "fps": 2, "count": 3}) == [1.0, 1.5, 2.0]
+        with pytest.raises(ValueError):
+            TimeRange(0.0, fps=30)
+
+
+class TestRationalTimebase:
+    """Test exact rational rates, times and frame numbers."""
+
+    def test_parse_rate(self):
+        """Test integer, decimal and fractional rates."""
+        assert parse_rate("30000/1001") == Fraction(30000, 1001)
+        assert parse_rate(29.97) == Fraction(2997, 100)
+        assert parse_rate("25") == 25
+        assert parse_rational(0.1) == Fraction(1, 10)
+        for invalid in ("0", "-30", "abc", "1/0", float("nan")):
+            with pytest.raises(ValueError):
+                parse_rate(invalid)
+
+    def test_ntsc_times_are_exact(self):
+        """Test that each time is the exact rational rounded once, at any frame."""
+        times = TimeRange(0, fps="30000/1001", count=10**9)
+        for frame in (0, 1, 29, 30, 107_892, 999_999_999):
+            assert times[frame] == float(Fraction(frame * 1001, 30000))
+            assert times.exact_time_of(frame) == Fraction(frame * 1001, 30000)
+
+    def test_end_boundary_is_exact(self):
+        """Test that an end on a frame boundary is excluded without a tolerance."""
+        assert len(TimeRange(0, end="1001/1000", fps="30000/1001")) == 30
+        assert len(TimeRange(0.1, end=0.4, fps=10)) == 3
+        assert list(TimeRange(0.1, end=0.4, fps=10)) == [0.1, 0.2, 0.3]
+
+    def test_slices_keep_frame_numbers_and_times(self):
+        """Test that a shard of a range has the frames and times of the whole."""
+        whole = TimeRange(0, fps="24000/1001", count=1000)
+        shard = whole[400:600]
+        assert shard.first == 400 and shard.frame_numbers == range(400, 600)
+        assert list(shard) == list(whole)[400:600]
+        assert frame_number(shard, 0) == 400
+        assert frame_number([0.0, 1.0], 1) == 1
+
+    def test_first_with_end(self):
+        """Test that first skips frames of a range bounded by end."""
+        times = TimeRange(0, end=1, fps=10, first=7)
+        assert times.frame_numbers == range(7, 10)
+        assert times[0] == 0.7
+
+    def test_to_dict_round_trips_exactly(self):
+        """Test that the manifest form keeps rational rates and first frames."""
+        shard = TimeRange(0, fps="30000/1001", count=100)[50:60]
+        data = shard.to_dict()
+        assert data == {"start": 0, "fps": "30000/1001", "count": 10, "first": 50}
+        assert parse_times(data) == shard
+        assert TimeRange(0.5, fps=29.97, count=2).to_dict() == {"start": 0.5, "fps": 29.97, "count": 2}
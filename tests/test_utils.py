@@ -2,6 +2,7 @@
 
 import pytest
 
+from isf_shader_renderer.timebase import TimeRange
 from isf_shader_renderer.utils import (
     calculate_frame_count,
     extract_shader_metadata,
@@ -25,13 +26,32 @@ class TestParseTimeRange:
     def test_parse_range_with_step(self):
         """Test parsing range with step."""
         result = parse_time_range("0:3:0.5")
-        assert result == [0.0, 0.5, 1.0, 1.5, 2.0, 2.5, 3.0]
+        assert result == [0.0, 0.5, 1.0, 1.5, 2.0, 2.5]
     
     def test_parse_range_with_dash(self):
         """Test parsing range with dash separator."""
         result = parse_time_range("0-3:0.5")
-        assert result == [0.0, 0.5, 1.0, 1.5, 2.0, 2.5, 3.0]
-    
+        assert result == [0.0, 0.5, 1.0, 1.5, 2.0, 2.5]
+    
+    def test_parse_range_does_not_drift(self):
+        """Test that a decimal step stops exactly one step before the exclusive end."""
+        result = parse_time_range("0:10:0.1")
+        assert len(result) == 100
+        assert result[-1] == 9.9
+        assert result.end == 10.0
+        assert result[3] == 0.3
+
+    def test_parse_range_matches_time_range(self):
+        """Test that range strings follow the exclusive end of TimeRange."""
+        assert parse_time_range("1:2:0.25") == TimeRange(1, 2, fps=4)
+        assert parse_time_range("2:1:0.5") == []
+
+    def test_parse_range_with_rational_step(self):
+        """Test an NTSC frame step."""
+        result = parse_time_range("0:1:1001/30000")
+        assert len(result) == 30
+        assert result[29] == 29 * 1001 / 30000
+
     def test_parse_single_value(self):
         """Test parsing single time value."""
         result = parse_time_range("1.5")
@@ -155,10 +175,23 @@ class TestFrameCalculations:
     def test_calculate_frame_count(self):
         """Test frame count calculation."""
         count = calculate_frame_count(0.0, 2.0, 30.0)
-        assert count == 61  # 0.0 to 2.0 at 30fps = 61 frames
+        assert count == 60  # 0.0 up to (not including) 2.0 at 30fps
     
     def test_generate_time_codes(self):
         """Test time code generation."""
         time_codes = generate_time_codes(0.0, 1.0, 4.0)  # 4fps
-        expected = [0.0, 0.25, 0.5, 0.75, 1.0]
-        assert time_codes == expected 
\ No newline at end of file
+        expected = [0.0, 0.25, 0.5, 0.75]
+        assert time_codes == expected
+
+    def test_frame_count_is_exact(self):
+        """Test frame counts whose float product falls just below an integer."""
+        assert calculate_frame_count(0.0, 0.29, 100) == 29
+        assert calculate_frame_count(0, "1001/1000", "30000/1001") == 30
+        assert calculate_frame_count(0, 2, 30) == len(TimeRange(0, 2, fps=30))
+        assert calculate_frame_count(1.0, 0.0, 30) == 0
+
+    def test_generate_ntsc_time_codes(self):
+        """Test rational rates in generated time codes."""
+        time_codes = generate_time_codes(0, 1, "30000/1001")
+        assert len(time_codes) == 30
+        assert time_codes[-1] == 29 * 1001 / 30000 
\ No newline at end of file
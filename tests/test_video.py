@@ -0,0 +1,137 @@
+"""Tests for Y4M video inputs."""
+
+from unittest.mock import Mock
+
+import numpy as np
+import pytest
+from PIL import Image
+
+from isf_shader_renderer.config import ShaderConfig, ShaderRendererConfig
+from isf_shader_renderer.renderer import ShaderRenderer
+from isf_shader_renderer.video import VideoFrameSource, Y4MReader, video_input
+
+SHADER = """/*{
+    "INPUTS": [
+        {"NAME": "mask", "TYPE": "image"},
+        {"NAME": "inputImage", "TYPE": "image"}
+    ]
+}*/
+void main() {
+    gl_FragColor = IMG_NORM_PIXEL(inputImage, isf_FragNormCoord);
+}"""
+
+
+def write_y4m(path, frames, width=16, height=8, extra=""):
+    """Write 4:2:0 frames given as (Y, U, V) constants."""
+    with open(path, "wb") as f:
+        f.write(f"YUV4MPEG2 W{width} H{height} F10:1 Ip A1:1 C420jpeg{extra}\n".encode())
+        chroma = ((width + 1) // 2) * ((height + 1) // 2)
+        for y, u, v in frames:
+            f.write(b"FRAME\n")
+            f.write(bytes([y]) * (width * height) + bytes([u]) * chroma + bytes([v]) * chroma)
+
+
+@pytest.fixture
+def ramp(tmp_path):
+    """Five grey frames getting brighter."""
+    path = tmp_path / "ramp.y4m"
+    write_y4m(path, [(16 + 50 * i, 128, 128) for i in range(5)])
+    return path
+
+
+class TestY4MReader:
+    """Test header parsing and color conversion."""
+
+    def test_header_and_frame_lookup(self, ramp):
+        """Test geometry, frame rate and time-to-frame mapping."""
+        reader = Y4MReader(ramp)
+        assert (reader.width, reader.height, reader.fps, reader.frame_count) == (16, 8, 10.0, 5)
+        assert reader.frame_index(0.0) == 0
+        assert reader.frame_index(0.3) == 3
+        assert reader.frame_index(60.0) == 4
+        reader.close()
+
+    def test_limited_range_grey(self, ramp):
+        """Test that Y=16 is black and grey frames stay grey."""
+        reader = Y4MReader(ramp)
+        black = reader.read_rgba(0)
+        assert black.shape == (8, 16, 4)
+        assert np.all(black[..., :3] == 0) and np.all(black[..., 3] == 255)
+        grey = reader.read_rgba(2)[0, 0]
+        assert grey[0] == grey[1] == grey[2] == round(100 * 255 / 219)
+        reader.close()
+
+    def test_full_range_color(self, tmp_path):
+        """Test BT.601 conversion of a saturated red."""
+        path = tmp_path / "red.y4m"
+        write_y4m(path, [(76, 85, 255)], width=5, height=3, extra=" XCOLORRANGE=FULL")
+        reader = Y4MReader(path)
+        pixel = reader.read_rgba(0)[2, 4].astype(int)
+        assert pixel[0] >= 250 and pixel[1] <= 5 and pixel[2] <= 5
+        reader.close()
+
+    def test_not_a_y4m(self, tmp_path):
+        """Test that other files are rejected."""
+        path = tmp_path / "clip.y4m"
+        path.write_bytes(b"RIFF....")
+        with pytest.raises(ValueError):
+            Y4MReader(path)
+
+
+class TestVideoFrameSource:
+    """Test prefetching into the buffer ring."""
+
+    def test_planned_frames_come_from_the_ring(self, ramp):
+        """Test that planned frames are prefetched in order and buffers are reused."""
+        times = [0.0, 0.1, 0.2, 0.3, 0.4, 0.4]
+        source = VideoFrameSource(ramp, times, ring_size=2)
+        levels = []
+        buffers = set()
+        for t in times:
+            frame = source.frame_at(t)
+            levels.append(int(frame[0, 0, 0]))
+            buffers.add(id(frame))
+        source.close()
+
+        assert levels == sorted(levels) and levels[0] == 0 and levels[-1] == round(200 * 255 / 219)
+        assert len(buffers) <= 2
+
+    def test_skipped_planned_times_keep_the_prefetch_going(self, ramp):
+        """Test that frames after a skipped planned time still come from the ring."""
+        source = VideoFrameSource(ramp, [0.0, 0.1, 0.2, 0.3, 0.4], ring_size=2)
+        ring = {id(buffer) for buffer in source._buffers}
+        frames, levels = [], []
+        for t in (0.0, 0.3, 0.4):
+            frames.append(source.frame_at(t))
+            levels.append(int(frames[-1][0, 0, 0]))
+        source.close()
+
+        assert all(id(frame) in ring for frame in frames)
+        assert levels == [0, round(150 * 255 / 219), round(200 * 255 / 219)]
+
+    def test_unplanned_time_is_decoded_directly(self, ramp):
+        """Test that a time code outside the plan still returns its frame."""
+        source = VideoFrameSource(ramp, [0.0, 0.1])
+        frame = source.frame_at(0.25)
+        source.close()
+        assert frame[0, 0, 0] == round(100 * 255 / 219)
+
+
+class TestVideoRendering:
+    """Test that the renderer uploads one frame per time code."""
+
+    def test_video_feeds_input_image(self, ramp):
+        """Test that inputImage (not the first image input) gets the frames."""
+        assert video_input(SHADER) == "inputImage"
+        renderer = ShaderRenderer(ShaderRendererConfig())
+        config = ShaderConfig(input="test.fs", output="", times=[0.0, 0.2], video=str(ramp))
+        isf_renderer = Mock()
+
+        for t in config.times:
+            renderer._set_video_input(isf_renderer, SHADER, config, t)
+        renderer.cleanup()
+
+        calls = isf_renderer.set_input.call_args_list
+        assert [call.args[0] for call in calls] == ["inputImage", "inputImage"]
+        assert all(isinstance(call.args[1], Image.Image) for call in calls)
+        assert calls[1].args[1].size == (16, 8)
@@ -0,0 +1,155 @@
+"""Tests for atomic frame writes, the write-behind queue and the progress journal."""
+
+import os
+
+import pytest
+from PIL import Image
+
+from isf_shader_renderer.config import ShaderConfig
+from isf_shader_renderer.writer import (
+    FrameWriter,
+    ProgressJournal,
+    frame_key,
+    frame_output,
+    job_key,
+    write_image_atomic,
+)
+
+SHADER = "void main() { gl_FragColor = vec4(1.0); }"
+
+
+def _image(value=128):
+    return Image.new("RGBA", (4, 4), (value, 0, 0, 255))
+
+
+class TestWriteImageAtomic:
+    """Test atomic image writes."""
+
+    def test_writes_and_replaces(self, tmp_path):
+        """Test that a write replaces the old file and leaves no temporary file."""
+        path = tmp_path / "frame.png"
+        write_image_atomic(_image(10), path)
+        stat = write_image_atomic(_image(200), path)
+        assert stat.st_size == path.stat().st_size
+        assert Image.open(path).getpixel((0, 0))[0] == 200
+        assert [p.name for p in tmp_path.iterdir()] == ["frame.png"]
+
+    def test_failed_encode_keeps_old_file(self, tmp_path, monkeypatch):
+        """Test that an encoder error leaves the previous frame and no temporary file."""
+        path = tmp_path / "frame.png"
+        write_image_atomic(_image(10), path)
+        before = path.read_bytes()
+
+        def fail(*args, **kwargs):
+            raise OSError("disk full")
+
+        monkeypatch.setattr(Image.Image, "save", fail)
+        with pytest.raises(OSError, match="disk full"):
+            write_image_atomic(_image(200), path)
+        assert path.read_bytes() == before
+        assert [p.name for p in tmp_path.iterdir()] == ["frame.png"]
+
+    def test_unknown_extension(self, tmp_path):
+        """Test that an unknown extension is rejected before anything is written."""
+        with pytest.raises(ValueError, match="unknown file extension"):
+            write_image_atomic(_image(), tmp_path / "frame.xyz")
+        assert not list(tmp_path.iterdir())
+
+
+class TestFrameWriter:
+    """Test the write-behind queue."""
+
+    def test_writes_batches_and_journals(self, tmp_path):
+        """Test that queued frames are written, journaled, and failures collected."""
+        journal = ProgressJournal(tmp_path / "progress.ndjson")
+        with FrameWriter(journal, batch_frames=3) as writer:
+            for i in range(7):
+                writer.submit(_image(i), tmp_path / f"f_{i}.png", key=f"k{i}")
+            writer.submit(_image(), tmp_path / "bad.xyz", key="bad")
+            writer.flush()
+            assert writer.written == 7
+        journal.close()
+        assert [path for path, _ in writer.failed] == [str(tmp_path / "bad.xyz")]
+        assert len(journal) == 7
+        assert journal.is_done(tmp_path / "f_3.png", "k3")
+
+    def test_syncs_once_per_batch(self, tmp_path, monkeypatch):
+        """Test that nothing is synced by default and that fsync syncs each directory once per batch."""
+        synced = []
+        monkeypatch.setattr("isf_shader_renderer.writer._fsync_path", synced.append)
+        with FrameWriter() as writer:
+            for i in range(8):
+                writer.submit(_image(i), tmp_path / f"a_{i}.png")
+        assert synced == []
+
+        with FrameWriter(fsync=True, batch_frames=4) as writer:
+            for i in range(8):
+                writer.submit(_image(i), tmp_path / f"b_{i}.png")
+        assert synced.count(tmp_path) == 2
+        assert sorted(path.name for path in synced if path != tmp_path) == [f"b_{i}.png" for i in range(8)]
+
+    def test_frame_output_without_journal(self, tmp_path):
+        """Test that the context manager writes every frame before it exits."""
+        with frame_output() as (writer, journal):
+            assert journal is None
+            for i in range(20):
+                writer.submit(_image(i), tmp_path / f"f_{i:02d}.png")
+        assert len(list(tmp_path.glob("f_*.png"))) == 20
+
+
+class TestProgressJournal:
+    """Test resuming from the progress journal."""
+
+    def _run(self, tmp_path, count=4):
+        path = tmp_path / "progress.ndjson"
+        with frame_output(path) as (writer, _):
+            for i in range(count):
+                writer.submit(_image(i), tmp_path / f"f_{i}.png", key=f"k{i}")
+        return path
+
+    def test_resume_skips_intact_frames(self, tmp_path):
+        """Test that only frames whose files still match are done."""
+        path = self._run(tmp_path)
+        (tmp_path / "f_1.png").unlink()
+        write_image_atomic(_image(99), tmp_path / "f_2.png")
+        journal = ProgressJournal(path, resume=True)
+        try:
+            done = [journal.is_done(tmp_path / f"f_{i}.png", f"k{i}") for i in range(4)]
+            assert done == [True, False, False, True]
+            assert not journal.is_done(tmp_path / "f_0.png", "other")
+        finally:
+            journal.close()
+
+    def test_truncated_line_is_ignored(self, tmp_path):
+        """Test that a line cut short by a crash does not spoil the rest."""
+        path = self._run(tmp_path)
+        with open(path, "a", encoding="utf-8") as f:
+            f.write('{"o": "f_9.png", "k"')
+        journal = ProgressJournal(path, resume=True)
+        journal.close()
+        assert len(journal) == 4
+
+    def test_without_resume_starts_empty(self, tmp_path):
+        """Test that a fresh run ignores an earlier journal."""
+        path = self._run(tmp_path)
+        journal = ProgressJournal(path)
+        journal.close()
+        assert len(journal) == 0 and path.read_text() == ""
+
+
+class TestKeys:
+    """Test job and frame keys."""
+
+    def test_job_key_covers_the_render(self):
+        """Test that size, inputs and shader change the key but not the output path."""
+        base = ShaderConfig(input="a.fs", output="a.png", times=[0.0], width=8, height=8)
+        key = job_key(SHADER, base)
+        assert job_key(SHADER, ShaderConfig(**{**base.__dict__, "output": "b.png"})) == key
+        assert job_key(SHADER, ShaderConfig(**{**base.__dict__, "width": 16})) != key
+        assert job_key(SHADER, ShaderConfig(**{**base.__dict__, "inputs": {"x": 1.0}})) != key
+        assert job_key(SHADER.replace("1.0", "0.5"), base) != key
+
+    def test_frame_key_is_exact(self):
+        """Test that nearby time codes get distinct keys."""
+        assert frame_key("j", 0.1) != frame_key("j", 0.1 + 1e-12)
+        assert os.sep not in frame_key("j", 1.0)